@@ -159,6 +159,7 @@ set(include_files_list
     string.h
     strings.h
     sys/dir.h
+    sys/epoll.h
     sys/file.h
     sys/ioctl.h
     sys/ipc.h
@@ -188,6 +189,7 @@ set(include_files_list
     vfork.h
     winsock2.h
     zlib.h
+    zstd.h
 )
 check_includes(include_files_list)
 
@@ -202,6 +204,7 @@ set(functions_list
     clock_gettime
     ctime_r
     dirname
+    epoll_create1
     fallocate
     fchmod
     fsync
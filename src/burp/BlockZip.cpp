@@ -0,0 +1,82 @@
+/*
+ *	PROGRAM:	JRD Backup and Restore Program
+ *	MODULE:		BlockZip.cpp
+ *	DESCRIPTION:	Block compression of backup file by several threads
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../burp/BlockZip.h"
+#include "../burp/burp.h"
+#include "../burp/burp_proto.h"
+
+#ifdef HAVE_ZSTD_H
+
+using namespace Firebird;
+using MsgFormat::SafeArg;
+
+namespace Burp {
+
+BlockZip::BlockZip(BurpGlobals* gbl, ZStd& z, unsigned threadCount, int level,
+		WriteFunction* func)
+	: Firebird::BlockZip(gbl->getPool(), z, true, level),
+	  tdgbl(gbl),
+	  writeFunc(func),
+	  readFunc(NULL)
+{
+	start(threadCount);
+}
+
+BlockZip::BlockZip(BurpGlobals* gbl, ZStd& z, unsigned threadCount, ReadFunction* func)
+	: Firebird::BlockZip(gbl->getPool(), z, false, 0),
+	  tdgbl(gbl),
+	  writeFunc(NULL),
+	  readFunc(func)
+{
+	start(threadCount);
+}
+
+void BlockZip::putData(const UCHAR* data, ULONG length, bool last)
+{
+	writeFunc(tdgbl, data, length, last);
+}
+
+ULONG BlockZip::getData(UCHAR* data, ULONG length)
+{
+	return readFunc(tdgbl, data, length);
+}
+
+void BlockZip::raiseError(bool init, const char* text)
+{
+	if (init)
+	{
+		BURP_error(isCompress() ? 384 : 383, true, SafeArg() << 0);
+		// msg 384 Compression stream init error @1
+		// msg 383 Decompression stream init error @1
+	}
+
+	BURP_error(isCompress() ? 380 : 379, true, SafeArg() << text);
+	// msg 380 Deflate error @1
+	// msg 379 Inflate error @1
+}
+
+} // namespace Burp
+
+#endif // HAVE_ZSTD_H
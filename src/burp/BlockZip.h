@@ -0,0 +1,65 @@
+/*
+ *	PROGRAM:	JRD Backup and Restore Program
+ *	MODULE:		BlockZip.h
+ *	DESCRIPTION:	Block compression of backup file by several threads
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef BURP_BLOCK_ZIP_H
+#define BURP_BLOCK_ZIP_H
+
+#include "../common/classes/BlockZip.h"
+
+class BurpGlobals;
+
+namespace Burp {
+
+#ifdef HAVE_ZSTD_H
+
+// Backup file compressed in blocks by several threads, see Firebird::BlockZip.
+// Compressed data is passed to and from the lower level - encryption and volumes.
+
+class BlockZip : public Firebird::BlockZip
+{
+public:
+	typedef void WriteFunction(BurpGlobals*, const UCHAR*, FB_SIZE_T, bool);
+	typedef ULONG ReadFunction(BurpGlobals*, UCHAR*, FB_SIZE_T);
+
+	BlockZip(BurpGlobals* tdgbl, Firebird::ZStd& zstd, unsigned threadCount, int level,
+		WriteFunction* writeFunc);
+	BlockZip(BurpGlobals* tdgbl, Firebird::ZStd& zstd, unsigned threadCount,
+		ReadFunction* readFunc);
+
+protected:
+	void putData(const UCHAR* data, ULONG length, bool last) override;
+	ULONG getData(UCHAR* data, ULONG length) override;
+	void raiseError(bool init, const char* text) override;
+
+private:
+	BurpGlobals* const tdgbl;
+	WriteFunction* const writeFunc;
+	ReadFunction* const readFunc;
+};
+
+#endif // HAVE_ZSTD_H
+
+} // namespace Burp
+
+#endif // BURP_BLOCK_ZIP_H
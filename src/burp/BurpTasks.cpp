@@ -0,0 +1,1213 @@
+/*
+ *	PROGRAM:	JRD Backup and Restore Program
+ *	MODULE:		BurpTasks.cpp
+ *	DESCRIPTION:	Parallel backup and restore of relations data
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../burp/BurpTasks.h"
+#include "../burp/burp.h"
+#include "../burp/backu_proto.h"
+#include "../burp/burp_proto.h"
+#include "../burp/mvol_proto.h"
+#include "../burp/resto_proto.h"
+#include "../common/utils_proto.h"
+#include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/DbImplementation.h"
+#include "firebird/impl/inf_pub.h"
+
+using namespace Firebird;
+using MsgFormat::SafeArg;
+
+
+namespace
+{
+
+// Worker has own globals with the same switches as the main thread,
+// but its own handles and output
+void initWorkerGlobals(BurpGlobals& gbl, BurpGlobals* mainGbl)
+{
+	memcpy(&gbl.gbl_database_file_name, &mainGbl->gbl_database_file_name,
+		&gbl.veryEnd - reinterpret_cast<char*>(&gbl.gbl_database_file_name));
+
+	gbl.db_handle = NULL;
+	gbl.tr_handle = NULL;
+	gbl.global_trans = NULL;
+	memset(&gbl.handles_get_character_sets_req_handle1, 0,
+		reinterpret_cast<char*>(&gbl.hdr_forced_writes) -
+		reinterpret_cast<char*>(&gbl.handles_get_character_sets_req_handle1));
+
+	gbl.gbl_task = NULL;
+	gbl.gbl_restore_task = NULL;
+	gbl.burp_throw = true;
+	gbl.verboseInterval = mainGbl->verboseInterval;
+}
+
+void attachWorker(BurpGlobals* gbl, BurpGlobals* mainGbl)
+{
+	FbLocalStatus status;
+	DispatcherPtr provider;
+
+	if (gbl->gbl_sw_keyholder)
+	{
+		provider->setDbCryptCallback(&status, MVOL_get_crypt(mainGbl));
+		if (status->getState() & IStatus::STATE_ERRORS)
+			BURP_error_redirect(&status, 408);
+	}
+
+	const UCharBuffer& dpb = mainGbl->gbl_dpb_data;
+
+	gbl->db_handle = provider->attachDatabase(&status, gbl->gbl_database_file_name,
+		dpb.getCount(), dpb.begin());
+
+	if (status->getState() & IStatus::STATE_ERRORS)
+	{
+		gbl->db_handle = NULL;
+		BURP_error_redirect(&status, 408);
+		// msg 408 cannot start parallel worker
+	}
+}
+
+// Release handles of the worker after an error
+void cleanupWorker(BurpGlobals& gbl)
+{
+	if (gbl.db_handle)
+	{
+		FbLocalStatus status;
+
+		if (gbl.tr_handle)
+			gbl.tr_handle->rollback(&status);
+
+		gbl.db_handle->detach(&status);
+	}
+}
+
+} // anonymous namespace
+
+
+namespace Burp {
+
+
+BackupRelationTask::BackupRelationTask(BurpGlobals* tdgbl, unsigned count)
+	: mainGbl(tdgbl),
+	  workerCount(count),
+	  workers(tdgbl->getPool()),
+	  relationData(NULL),
+	  items(tdgbl->getPool()),
+	  nextItem(0),
+	  activeItems(0),
+	  records(0),
+	  filled(tdgbl->getPool()),
+	  snapshotNumber(0),
+	  startedWorkers(0),
+	  stop(false),
+	  failed(false)
+{
+}
+
+BackupRelationTask::~BackupRelationTask()
+{
+	// Workers are still running if the main thread failed
+
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+		stop = true;
+		workerCond.notifyAll();
+	}
+
+	for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+		(*worker)->wait();
+
+	for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+		delete *worker;
+}
+
+// Start workers and wait for them to attach the database.
+// Returns false if workers can't share the snapshot of the main transaction,
+// the caller should backup data serially then.
+bool BackupRelationTask::start()
+{
+	FbLocalStatus status;
+
+	// Workers see the same snapshot as the main transaction
+	const UCHAR item = fb_info_tra_snapshot_number;
+	UCHAR info[16];
+	mainGbl->tr_handle->getInfo(&status, sizeof(item), &item, sizeof(info), info);
+
+	if (status->getState() & IStatus::STATE_ERRORS)
+		BURP_error_redirect(&status, 408);
+		// msg 408 cannot start parallel worker
+
+	if (info[0] == item)
+	{
+		const SSHORT length = (SSHORT) gds__vax_integer(info + 1, 2);
+		snapshotNumber = isc_portable_integer(info + 3, length);
+	}
+
+	if (!snapshotNumber)
+	{
+		BURP_print(false, 419);
+		// msg 419 snapshot number of the main transaction is not available, parallel workers are not used
+		return false;
+	}
+
+	for (unsigned n = 0; n < workerCount; n++)
+	{
+		Worker* const worker = FB_NEW_POOL(mainGbl->getPool()) Worker(this, n);
+		workers.add(worker);
+		worker->start();
+	}
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	while (startedWorkers < workerCount)
+		mainCond.wait(mutex);
+
+	if (failed)
+	{
+		guard.release();
+		checkErrors();
+	}
+
+	return true;
+}
+
+// Stop workers, they commit their transactions and detach.
+void BackupRelationTask::finish()
+{
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+		stop = true;
+		workerCond.notifyAll();
+	}
+
+	for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+		(*worker)->wait();
+
+	checkErrors();
+}
+
+FB_UINT64 BackupRelationTask::backup(RelationData& data, ULONG pointerPages)
+{
+	// Split the relation into ranges, a few per worker to share the work evenly
+	// when the records are spread over the pages unevenly
+
+	const ULONG pages = MAX(pointerPages, 1);
+	const ULONG count = MIN(pages, workerCount * 4);
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	items.clear();
+
+	for (ULONG n = 0; n < count; n++)
+	{
+		Item& item = items.add();
+		item.firstPage = (SLONG) ((FB_UINT64) pages * n / count);
+		item.lastPage = (SLONG) ((FB_UINT64) pages * (n + 1) / count);
+	}
+
+	relationData = &data;
+	nextItem = 0;
+	activeItems = 0;
+	records = 0;
+
+	workerCond.notifyAll();
+
+	// Write the filled buffers until all the ranges are done
+
+	Worker* expected = NULL;
+
+	while (true)
+	{
+		if (failed)
+			break;
+
+		Buffer* buffer = NULL;
+
+		for (FB_SIZE_T n = 0; n < filled.getCount(); n++)
+		{
+			// A record passed in pieces is written before anything else
+			if (!expected || filled[n]->owner == expected)
+			{
+				buffer = filled[n];
+				filled.remove(n);
+				break;
+			}
+		}
+
+		if (!buffer)
+		{
+			if (nextItem >= items.getCount() && !activeItems && filled.isEmpty())
+				break;
+
+			mainCond.wait(mutex);
+			continue;
+		}
+
+		expected = buffer->continued ? buffer->owner : NULL;
+
+		{	// scope
+			MutexUnlockGuard unlock(mutex, FB_FUNCTION);
+			MVOL_write_block(mainGbl, buffer->data, buffer->length);
+		}
+
+		buffer->owner->freeBuffers.add(buffer);
+		workerCond.notifyAll();
+	}
+
+	relationData = NULL;
+	items.clear();
+	nextItem = 0;
+
+	if (failed)
+	{
+		guard.release();
+		checkErrors();
+	}
+
+	return records;
+}
+
+// Pass the filled buffer of the worker to the main thread. Only the complete
+// records are passed, the beginning of the last one is moved into the next buffer.
+void BackupRelationTask::putBuffer(BurpGlobals* tdgbl)
+{
+	Worker* const worker = workers[tdgbl->gbl_task_worker];
+	Buffer* const buffer = worker->current;
+
+	buffer->length = tdgbl->gbl_io_ptr - buffer->data;
+
+	const bool incomplete = (worker->recordEnd == 0);
+	const ULONG tail = buffer->length - worker->recordEnd;
+
+	Buffer* const next = getBuffer(worker);
+
+	if (!incomplete && tail)
+		memcpy(next->data, buffer->data + worker->recordEnd, tail);
+
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+
+		if (!incomplete)
+			buffer->length = worker->recordEnd;
+
+		buffer->continued = incomplete;
+		filled.add(buffer);
+		mainCond.notifyOne();
+	}
+
+	worker->current = next;
+	worker->recordEnd = 0;
+
+	const ULONG used = incomplete ? 0 : tail;
+	tdgbl->gbl_io_ptr = next->data + used;
+	tdgbl->gbl_io_cnt = BUFFER_SIZE - used;
+}
+
+void BackupRelationTask::endRecord(BurpGlobals* tdgbl)
+{
+	Worker* const worker = workers[tdgbl->gbl_task_worker];
+
+	worker->recordEnd = tdgbl->gbl_io_ptr - worker->current->data;
+}
+
+BackupRelationTask::Buffer* BackupRelationTask::getBuffer(Worker* worker)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	while (worker->freeBuffers.isEmpty())
+	{
+		if (failed || stop)
+			BURP_exit_local(FINI_ERROR, BurpGlobals::getSpecific());
+
+		workerCond.wait(mutex);
+	}
+
+	return worker->freeBuffers.pop();
+}
+
+// Report an error of a worker in the main thread
+void BackupRelationTask::checkErrors()
+{
+	if (!failed)
+		return;
+
+	if (errorStatus->getState() & IStatus::STATE_ERRORS)
+	{
+		BURP_print_status(true, &errorStatus);
+		BURP_abort();
+	}
+
+	// The worker has printed its error already
+	BURP_exit_local(FINI_ERROR, mainGbl);
+}
+
+
+BackupRelationTask::Worker::Worker(BackupRelationTask* t, unsigned n)
+	: current(NULL),
+	  recordEnd(0),
+	  freeBuffers(t->mainGbl->getPool()),
+	  buffers(t->mainGbl->getPool()),
+	  task(t),
+	  number(n),
+	  handle(0)
+{
+	buffers.grow(BUFFERS_PER_WORKER);
+
+	for (Buffer* buffer = buffers.begin(); buffer != buffers.end(); ++buffer)
+	{
+		buffer->owner = this;
+		buffer->data = FB_NEW_POOL(t->mainGbl->getPool()) UCHAR[BUFFER_SIZE];
+		buffer->length = 0;
+		buffer->continued = false;
+		freeBuffers.add(buffer);
+	}
+}
+
+BackupRelationTask::Worker::~Worker()
+{
+	for (Buffer* buffer = buffers.begin(); buffer != buffers.end(); ++buffer)
+		delete[] buffer->data;
+}
+
+void BackupRelationTask::Worker::start()
+{
+	Thread::start(workerThread, this, THREAD_medium, &handle);
+}
+
+void BackupRelationTask::Worker::wait()
+{
+	if (handle)
+	{
+		Thread::waitForCompletion(handle);
+		handle = 0;
+	}
+}
+
+THREAD_ENTRY_DECLARE BackupRelationTask::Worker::workerThread(THREAD_ENTRY_PARAM arg)
+{
+	static_cast<Worker*>(arg)->run();
+	return 0;
+}
+
+void BackupRelationTask::Worker::run()
+{
+	BurpGlobals* const mainGbl = task->mainGbl;
+
+	BurpGlobals gbl(mainGbl->uSvc);
+	initWorkerGlobals(gbl, mainGbl);
+	gbl.gbl_task = task;
+	gbl.gbl_task_worker = number;
+
+	BurpGlobals::putSpecific(&gbl);
+
+	bool attached = false;
+
+	try
+	{
+		attach(&gbl);
+		attached = true;
+
+		{	// scope
+			MutexLockGuard guard(task->mutex, FB_FUNCTION);
+			task->startedWorkers++;
+			task->mainCond.notifyOne();
+		}
+
+		while (true)
+		{
+			Item item;
+
+			{	// scope
+				MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+				while (!task->stop && !task->failed &&
+					(!task->relationData || task->nextItem >= task->items.getCount()))
+				{
+					task->workerCond.wait(task->mutex);
+				}
+
+				if (task->stop || task->failed)
+					break;
+
+				item = task->items[task->nextItem++];
+				task->activeItems++;
+			}
+
+			const FB_UINT64 count = process(&gbl, item);
+
+			MutexLockGuard guard(task->mutex, FB_FUNCTION);
+			task->records += count;
+			task->activeItems--;
+			task->mainCond.notifyOne();
+		}
+
+		detach(&gbl);
+	}
+	catch (const LongJump&)
+	{
+		MutexLockGuard guard(task->mutex, FB_FUNCTION);
+		task->failed = true;
+	}
+	catch (const Exception& ex)
+	{
+		MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+		if (!task->failed)
+			ex.stuffException(&task->errorStatus);
+
+		task->failed = true;
+	}
+
+	{	// scope
+		MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+		if (!attached)
+			task->startedWorkers++;
+
+		task->mainCond.notifyOne();
+		task->workerCond.notifyAll();
+	}
+
+	cleanupWorker(gbl);
+
+	BurpGlobals::restoreSpecific();
+}
+
+void BackupRelationTask::Worker::attach(BurpGlobals* gbl)
+{
+	attachWorker(gbl, task->mainGbl);
+
+	FbLocalStatus status;
+	ClumpletWriter tpb(ClumpletReader::Tpb, MAX_DPB_SIZE, isc_tpb_version3);
+	tpb.insertTag(isc_tpb_concurrency);
+	tpb.insertTag(isc_tpb_read);
+
+	if (gbl->gbl_sw_ignore_limbo)
+		tpb.insertTag(isc_tpb_ignore_limbo);
+
+	fb_assert(task->snapshotNumber);
+	tpb.insertBigInt(isc_tpb_at_snapshot_number, task->snapshotNumber);
+
+	gbl->tr_handle = gbl->db_handle->startTransaction(&status,
+		tpb.getBufferLength(), tpb.getBuffer());
+
+	if (status->getState() & IStatus::STATE_ERRORS)
+	{
+		gbl->tr_handle = NULL;
+		BURP_error_redirect(&status, 408);
+	}
+}
+
+void BackupRelationTask::Worker::detach(BurpGlobals* gbl)
+{
+	FbLocalStatus status;
+
+	gbl->tr_handle->commit(&status);
+	if (status->getState() & IStatus::STATE_ERRORS)
+		BURP_error_redirect(&status, 409);
+		// msg 409 error finishing parallel worker
+	gbl->tr_handle = NULL;
+
+	gbl->db_handle->detach(&status);
+	if (status->getState() & IStatus::STATE_ERRORS)
+		BURP_error_redirect(&status, 409);
+	gbl->db_handle = NULL;
+}
+
+FB_UINT64 BackupRelationTask::Worker::process(BurpGlobals* gbl, const Item& item)
+{
+	current = task->getBuffer(this);
+	recordEnd = 0;
+	gbl->gbl_io_ptr = current->data;
+	gbl->gbl_io_cnt = BUFFER_SIZE;
+
+	RangeMessage range;
+	range.firstPage = item.firstPage;
+	range.lastPage = item.lastPage;
+
+	const FB_UINT64 count = BACKUP_put_records(*task->relationData, &range);
+
+	// Pass the rest of data
+	current->length = gbl->gbl_io_ptr - current->data;
+	current->continued = false;
+
+	MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+	if (current->length)
+	{
+		task->filled.add(current);
+		task->mainCond.notifyOne();
+	}
+	else
+		freeBuffers.add(current);
+
+	current = NULL;
+
+	return count;
+}
+
+
+RestoreRelationTask::RestoreRelationTask(BurpGlobals* tdgbl, unsigned count)
+	: mainGbl(tdgbl),
+	  workerCount(count),
+	  workers(tdgbl->getPool()),
+	  loader(NULL),
+	  output(NULL),
+	  indexRelations(NULL),
+	  nextIndexRelation(0),
+	  activeIndexRelations(0),
+	  startedWorkers(0),
+	  started(false),
+	  stop(false),
+	  failed(false),
+	  offline(false)
+{
+}
+
+RestoreRelationTask::~RestoreRelationTask()
+{
+	// Workers are still running if the main thread failed
+
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+		stop = true;
+		workerCond.notifyAll();
+	}
+
+	for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+		(*worker)->wait();
+
+	for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+		delete *worker;
+
+	mainGbl->gbl_restore_task = NULL;
+}
+
+// Start workers and wait for them to attach the database. It's done when
+// the database is needed first time, i.e. when it's created already.
+void RestoreRelationTask::start()
+{
+	started = true;
+
+	for (unsigned n = 0; n < workerCount; n++)
+	{
+		Worker* const worker = FB_NEW_POOL(mainGbl->getPool()) Worker(this, n);
+		workers.add(worker);
+		worker->start();
+	}
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	while (startedWorkers < workerCount)
+		mainCond.wait(mutex);
+
+	if (failed)
+	{
+		guard.release();
+		checkErrors();
+	}
+}
+
+// Stop workers, they detach the database.
+void RestoreRelationTask::finish()
+{
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+		stop = true;
+		workerCond.notifyAll();
+	}
+
+	for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+		(*worker)->wait();
+
+	checkErrors();
+}
+
+void RestoreRelationTask::startRelation(burp_rel* relation, const string& sql, IMessageMetadata* meta)
+{
+	if (!started)
+		start();
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	// Wait for a free worker
+
+	Worker* worker = NULL;
+
+	while (!failed)
+	{
+		for (Worker** ptr = workers.begin(); ptr != workers.end(); ++ptr)
+		{
+			if (!(*ptr)->relation)
+			{
+				worker = *ptr;
+				break;
+			}
+		}
+
+		if (worker)
+			break;
+
+		mainCond.wait(mutex);
+	}
+
+	if (failed)
+	{
+		guard.release();
+		checkErrors();
+	}
+
+	// Free worker has released all its buffers
+
+	fb_assert(worker->freeBuffers.getCount() == BUFFERS_PER_WORKER);
+
+	worker->sql = sql;
+	worker->meta = meta;
+	worker->relation = relation;
+
+	loader = worker;
+	output = worker->freeBuffers.pop();
+	output->length = 0;
+	output->last = false;
+
+	workerCond.notifyAll();
+}
+
+void RestoreRelationTask::putBlob(ULONG offset, UCHAR type)
+{
+	const UCHAR tag = TAG_BLOB;
+	write(&tag, sizeof(tag));
+	write(&offset, sizeof(offset));
+	write(&type, sizeof(type));
+}
+
+void RestoreRelationTask::putSegment(const UCHAR* data, USHORT length)
+{
+	const UCHAR tag = TAG_SEGMENT;
+	write(&tag, sizeof(tag));
+	write(&length, sizeof(length));
+	write(data, length);
+}
+
+void RestoreRelationTask::putRow(const UCHAR* message, ULONG length)
+{
+	const UCHAR tag = TAG_ROW;
+	write(&tag, sizeof(tag));
+	write(message, length);
+}
+
+void RestoreRelationTask::endRelation()
+{
+	passBuffer(true);
+}
+
+void RestoreRelationTask::waitLoaded()
+{
+	if (!started)
+		return;
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	while (!failed)
+	{
+		bool busy = false;
+
+		for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+		{
+			if ((*worker)->relation)
+				busy = true;
+		}
+
+		if (!busy)
+			break;
+
+		mainCond.wait(mutex);
+	}
+
+	if (failed)
+	{
+		guard.release();
+		checkErrors();
+	}
+}
+
+// Activate deferred indexes, relation by relation
+void RestoreRelationTask::activateIndexes(const ObjectsArray<string>& relations)
+{
+	if (relations.isEmpty())
+		return;
+
+	if (!started)
+		start();
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	indexRelations = &relations;
+	nextIndexRelation = 0;
+	activeIndexRelations = 0;
+	workerCond.notifyAll();
+
+	while (!failed && (nextIndexRelation < relations.getCount() || activeIndexRelations))
+		mainCond.wait(mutex);
+
+	indexRelations = NULL;
+
+	if (offline)
+		mainGbl->flag_on_line = false;
+
+	if (failed)
+	{
+		guard.release();
+		checkErrors();
+	}
+}
+
+// Copy data into the buffers of the worker storing the relation
+void RestoreRelationTask::write(const void* data, ULONG length)
+{
+	const UCHAR* ptr = static_cast<const UCHAR*>(data);
+
+	while (length)
+	{
+		if (output->length == BUFFER_SIZE)
+			passBuffer(false);
+
+		const ULONG count = MIN(length, BUFFER_SIZE - output->length);
+		memcpy(output->data + output->length, ptr, count);
+
+		output->length += count;
+		ptr += count;
+		length -= count;
+	}
+}
+
+// Pass the filled buffer to the worker and take the next free one
+void RestoreRelationTask::passBuffer(bool last)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	output->last = last;
+	loader->filled.add(output);
+	output = NULL;
+	workerCond.notifyAll();
+
+	if (last)
+	{
+		loader = NULL;
+		return;
+	}
+
+	while (!failed && loader->freeBuffers.isEmpty())
+		mainCond.wait(mutex);
+
+	if (failed)
+	{
+		guard.release();
+		checkErrors();
+	}
+
+	output = loader->freeBuffers.pop();
+	output->length = 0;
+	output->last = false;
+}
+
+// Report an error of a worker in the main thread
+void RestoreRelationTask::checkErrors()
+{
+	if (!failed)
+		return;
+
+	if (errorStatus->getState() & IStatus::STATE_ERRORS)
+	{
+		BURP_print_status(true, &errorStatus);
+		BURP_abort();
+	}
+
+	// The worker has printed its error already
+	BURP_exit_local(FINI_ERROR, mainGbl);
+}
+
+
+RestoreRelationTask::Worker::Worker(RestoreRelationTask* t, unsigned n)
+	: relation(NULL),
+	  sql(t->mainGbl->getPool()),
+	  freeBuffers(t->mainGbl->getPool()),
+	  filled(t->mainGbl->getPool()),
+	  buffers(t->mainGbl->getPool()),
+	  task(t),
+	  number(n),
+	  handle(0),
+	  current(NULL),
+	  position(0)
+{
+	buffers.grow(BUFFERS_PER_WORKER);
+
+	for (Buffer* buffer = buffers.begin(); buffer != buffers.end(); ++buffer)
+	{
+		buffer->data = FB_NEW_POOL(t->mainGbl->getPool()) UCHAR[BUFFER_SIZE];
+		buffer->length = 0;
+		buffer->last = false;
+		freeBuffers.add(buffer);
+	}
+}
+
+RestoreRelationTask::Worker::~Worker()
+{
+	for (Buffer* buffer = buffers.begin(); buffer != buffers.end(); ++buffer)
+		delete[] buffer->data;
+}
+
+void RestoreRelationTask::Worker::start()
+{
+	Thread::start(workerThread, this, THREAD_medium, &handle);
+}
+
+void RestoreRelationTask::Worker::wait()
+{
+	if (handle)
+	{
+		Thread::waitForCompletion(handle);
+		handle = 0;
+	}
+}
+
+THREAD_ENTRY_DECLARE RestoreRelationTask::Worker::workerThread(THREAD_ENTRY_PARAM arg)
+{
+	static_cast<Worker*>(arg)->run();
+	return 0;
+}
+
+void RestoreRelationTask::Worker::run()
+{
+	BurpGlobals* const mainGbl = task->mainGbl;
+
+	BurpGlobals gbl(mainGbl->uSvc);
+	initWorkerGlobals(gbl, mainGbl);
+
+	BurpGlobals::putSpecific(&gbl);
+
+	bool attached = false;
+
+	try
+	{
+		attachWorker(&gbl, mainGbl);
+		attached = true;
+
+		{	// scope
+			MutexLockGuard guard(task->mutex, FB_FUNCTION);
+			task->startedWorkers++;
+			task->mainCond.notifyAll();
+		}
+
+		while (true)
+		{
+			const string* indexRelation = NULL;
+
+			{	// scope
+				MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+				while (!task->stop && !task->failed && !relation &&
+					(!task->indexRelations || task->nextIndexRelation >= task->indexRelations->getCount()))
+				{
+					task->workerCond.wait(task->mutex);
+				}
+
+				if (task->stop || task->failed)
+					break;
+
+				if (!relation)
+				{
+					indexRelation = &(*task->indexRelations)[task->nextIndexRelation++];
+					task->activeIndexRelations++;
+				}
+			}
+
+			if (relation)
+			{
+				load(&gbl);
+
+				MutexLockGuard guard(task->mutex, FB_FUNCTION);
+				relation = NULL;
+				meta = NULL;
+				task->mainCond.notifyAll();
+			}
+			else
+			{
+				BURP_verbose(412, SafeArg() << number + 1 << indexRelation->c_str());
+				// msg 412 worker @1: activating indexes of table @2
+				RESTORE_activate_indexes(&gbl, indexRelation->c_str());
+
+				MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+				if (!gbl.flag_on_line)
+					task->offline = true;
+
+				task->activeIndexRelations--;
+				task->mainCond.notifyAll();
+			}
+		}
+
+		FbLocalStatus status;
+		gbl.db_handle->detach(&status);
+		if (status->getState() & IStatus::STATE_ERRORS)
+			BURP_error_redirect(&status, 409);
+			// msg 409 error finishing parallel worker
+		gbl.db_handle = NULL;
+	}
+	catch (const LongJump&)
+	{
+		MutexLockGuard guard(task->mutex, FB_FUNCTION);
+		task->failed = true;
+	}
+	catch (const Exception& ex)
+	{
+		MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+		if (!task->failed)
+			ex.stuffException(&task->errorStatus);
+
+		task->failed = true;
+	}
+
+	{	// scope
+		MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+		if (!attached)
+			task->startedWorkers++;
+
+		task->mainCond.notifyAll();
+		task->workerCond.notifyAll();
+	}
+
+	cleanupWorker(gbl);
+
+	BurpGlobals::restoreSpecific();
+}
+
+// Store records of the relation passed by the main thread
+void RestoreRelationTask::Worker::load(BurpGlobals* gbl)
+{
+	FbLocalStatus status;
+
+	ClumpletWriter tpb(ClumpletReader::Tpb, MAX_DPB_SIZE, isc_tpb_version3);
+	tpb.insertTag(isc_tpb_concurrency);
+	tpb.insertTag(isc_tpb_write);
+	tpb.insertTag(isc_tpb_no_auto_undo);
+
+	gbl->tr_handle = gbl->db_handle->startTransaction(&status,
+		tpb.getBufferLength(), tpb.getBuffer());
+
+	if (status->getState() & IStatus::STATE_ERRORS)
+	{
+		gbl->tr_handle = NULL;
+		BURP_error_redirect(&status, 408);
+	}
+
+	RefPtr<IBatch> batch(REF_NO_INCR, RESTORE_create_batch(gbl, sql, meta));
+
+	if (gbl->status_vector->getState() & IStatus::STATE_ERRORS)
+	{
+		BURP_error_redirect(&gbl->status_vector, 413, SafeArg() << relation->rel_name);
+		// msg 413 could not start batch when restoring table @1
+	}
+
+	const ULONG length = meta->getMessageLength(&gbl->throwStatus);
+	Array<UCHAR> messageBuffer;
+	UCHAR* const message = messageBuffer.getBuffer(length);
+	UCharBuffer segmentBuffer;
+
+	// Blob ids to be put into the next message
+	struct BlobItem
+	{
+		ULONG offset;
+		ISC_QUAD id;
+	};
+
+	HalfStaticArray<BlobItem, 8> blobs;
+	UCHAR blobType = 0;
+	bool firstSegment = false;
+
+	FB_UINT64 records = 0;
+	unsigned pending = 0;
+	const SINT64 startTime = fb_utils::query_performance_counter();
+
+	UCHAR tag;
+
+	while (getTag(tag))
+	{
+		switch (tag)
+		{
+		case TAG_BLOB:
+		{
+			BlobItem& blob = blobs.add();
+			read(&blob.offset, sizeof(blob.offset));
+			read(&blobType, sizeof(blobType));
+			blob.id.gds_quad_high = 0;
+			blob.id.gds_quad_low = 0;
+			firstSegment = true;
+			break;
+		}
+
+		case TAG_SEGMENT:
+		{
+			USHORT segmentLength;
+			read(&segmentLength, sizeof(segmentLength));
+
+			UCHAR* const segment = segmentBuffer.getBuffer(segmentLength);
+			read(segment, segmentLength);
+
+			FbLocalStatus status_vector;
+
+			if (firstSegment)
+			{
+				const UCHAR bpb[] = {isc_bpb_version1, isc_bpb_type, 1, blobType};
+				batch->addBlob(&status_vector, segmentLength, segment, &blobs.back().id,
+					sizeof(bpb), bpb);
+			}
+			else
+				batch->appendBlobData(&status_vector, segmentLength, segment);
+
+			if (status_vector->getState() & IStatus::STATE_ERRORS)
+				BURP_error_redirect(&status_vector, 370);
+				// msg 370 could not append BLOB data to batch
+
+			firstSegment = false;
+			break;
+		}
+
+		case TAG_ROW:
+			read(message, length);
+
+			for (const BlobItem* blob = blobs.begin(); blob != blobs.end(); ++blob)
+				memcpy(message + blob->offset, &blob->id, sizeof(ISC_QUAD));
+
+			blobs.clear();
+
+			batch->add(&gbl->throwStatus, 1, message);
+
+			if ((++records % gbl->verboseInterval) == 0)
+			{
+				BURP_verbose(410, SafeArg() << number + 1 << records << relation->rel_name);
+				// msg 410 worker @1: @2 records restored into table @3
+			}
+
+			if (++pending == GBAK_BATCH_STEP)
+			{
+				records -= RESTORE_execute_batch(gbl, relation, batch);
+				pending = 0;
+			}
+			break;
+
+		default:
+			fb_assert(false);
+		}
+	}
+
+	if (pending)
+		records -= RESTORE_execute_batch(gbl, relation, batch);
+
+	batch = NULL;
+
+	gbl->tr_handle->commit(&status);
+	if (status->getState() & IStatus::STATE_ERRORS)
+		BURP_error_redirect(&status, 69, SafeArg() << relation->rel_name);
+		// msg 69 commit failed on table @1
+	gbl->tr_handle = NULL;
+
+	const SINT64 elapsed = fb_utils::query_performance_counter() - startTime;
+	const FB_UINT64 rate = (elapsed > 0) ?
+		(FB_UINT64) ((double) records * fb_utils::query_performance_frequency() / elapsed) : records;
+
+	BURP_verbose(411, SafeArg() << number + 1 << relation->rel_name << records << rate);
+	// msg 411 worker @1: table @2 done, @3 records restored, @4 records per second
+}
+
+// Get the tag of the next item, false at the end of the relation data
+bool RestoreRelationTask::Worker::getTag(UCHAR& tag)
+{
+	while (!current || position == current->length)
+	{
+		if (current && current->last)
+		{
+			releaseBuffer();
+			return false;
+		}
+
+		nextBuffer();
+	}
+
+	tag = current->data[position++];
+	return true;
+}
+
+// Read data of the item, it may continue in the next buffer
+void RestoreRelationTask::Worker::read(void* to, ULONG length)
+{
+	UCHAR* ptr = static_cast<UCHAR*>(to);
+
+	while (length)
+	{
+		if (position == current->length)
+		{
+			fb_assert(!current->last);
+			nextBuffer();
+		}
+
+		const ULONG count = MIN(length, current->length - position);
+		memcpy(ptr, current->data + position, count);
+
+		position += count;
+		ptr += count;
+		length -= count;
+	}
+}
+
+void RestoreRelationTask::Worker::nextBuffer()
+{
+	if (current)
+		releaseBuffer();
+
+	MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+	while (filled.isEmpty())
+	{
+		if (task->failed || task->stop)
+			BURP_exit_local(FINI_ERROR, BurpGlobals::getSpecific());
+
+		task->workerCond.wait(task->mutex);
+	}
+
+	current = filled[0];
+	filled.remove((FB_SIZE_T) 0);
+	position = 0;
+}
+
+void RestoreRelationTask::Worker::releaseBuffer()
+{
+	MutexLockGuard guard(task->mutex, FB_FUNCTION);
+
+	freeBuffers.add(current);
+	current = NULL;
+	task->mainCond.notifyAll();
+}
+
+} // namespace Burp
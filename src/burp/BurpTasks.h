@@ -0,0 +1,275 @@
+/*
+ *	PROGRAM:	JRD Backup and Restore Program
+ *	MODULE:		BurpTasks.h
+ *	DESCRIPTION:	Parallel backup and restore of relations data
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef BURP_BURP_TASKS_H
+#define BURP_BURP_TASKS_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/condition.h"
+#include "../common/classes/locks.h"
+#include "../common/classes/objects_array.h"
+#include "../common/classes/RefCounted.h"
+#include "../common/ThreadStart.h"
+#include "../common/status.h"
+#include "firebird/Interface.h"
+
+class BurpGlobals;
+struct burp_rel;
+
+namespace Burp {
+
+// Request reading data of a relation, see put_data() in backup.epp.
+// Built once by the main thread, compiled by every worker.
+
+struct RelationData
+{
+	explicit RelationData(MemoryPool& p)
+		: relation(NULL), blr(p), length(0), eofOffset(0), recordLength(0), paramCount(0)
+	{ }
+
+	burp_rel* relation;
+	Firebird::UCharBuffer blr;		// request with the range of pointer pages in message 1
+	RCRD_LENGTH length;				// length of message 0
+	RCRD_OFFSET eofOffset;
+	RCRD_OFFSET recordLength;
+	USHORT paramCount;
+};
+
+// Message 1 of the request
+struct RangeMessage
+{
+	SLONG firstPage;			// pointer page sequence numbers, the last one is excluded
+	SLONG lastPage;
+};
+
+// Data of a relation is read by several workers at once, every worker has its
+// own attachment and transaction started at the snapshot of the main one.
+// The relation is split into ranges of pointer pages.
+//
+// Workers write the backup records into own buffers, the main thread takes
+// filled buffers in turn and writes them into the backup file. Buffers are
+// passed at the record boundaries, so records are never mixed. Only a record
+// larger than a buffer is passed in pieces - then the main thread waits for
+// the rest of it.
+
+class BackupRelationTask
+{
+public:
+	BackupRelationTask(BurpGlobals* tdgbl, unsigned workerCount);
+	~BackupRelationTask();
+
+	bool start();
+	void finish();
+
+	// Write data of the relation (main thread)
+	FB_UINT64 backup(RelationData& data, ULONG pointerPages);
+
+	// Called by workers via BurpGlobals::put()
+	void putBuffer(BurpGlobals* tdgbl);
+	void endRecord(BurpGlobals* tdgbl);
+
+private:
+	static const ULONG BUFFER_SIZE = 128 * 1024;
+	static const unsigned BUFFERS_PER_WORKER = 4;
+
+	class Worker;
+
+	struct Buffer
+	{
+		Worker* owner;
+		UCHAR* data;
+		ULONG length;
+		bool continued;			// the last record is incomplete
+	};
+
+	struct Item
+	{
+		SLONG firstPage;
+		SLONG lastPage;
+	};
+
+	class Worker
+	{
+	public:
+		Worker(BackupRelationTask* t, unsigned n);
+		~Worker();
+
+		void start();
+		void wait();
+
+		Buffer* current;
+		ULONG recordEnd;		// end of the last complete record in the current buffer
+		Firebird::HalfStaticArray<Buffer*, BUFFERS_PER_WORKER> freeBuffers;
+		Firebird::HalfStaticArray<Buffer, BUFFERS_PER_WORKER> buffers;
+
+	private:
+		static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg);
+		void run();
+		void attach(BurpGlobals* gbl);
+		void detach(BurpGlobals* gbl);
+		FB_UINT64 process(BurpGlobals* gbl, const Item& item);
+
+		BackupRelationTask* const task;
+		const unsigned number;
+		Thread::Handle handle;
+	};
+
+	friend class Worker;
+
+	Buffer* getBuffer(Worker* worker);
+	void checkErrors();
+
+	BurpGlobals* const mainGbl;
+	const unsigned workerCount;
+	Firebird::HalfStaticArray<Worker*, 8> workers;
+
+	Firebird::Mutex mutex;
+	Firebird::Condition workerCond;		// workers wait for items and free buffers
+	Firebird::Condition mainCond;		// main thread waits for filled buffers
+
+	RelationData* relationData;
+	Firebird::HalfStaticArray<Item, 64> items;
+	FB_SIZE_T nextItem;
+	unsigned activeItems;
+	FB_UINT64 records;
+	Firebird::HalfStaticArray<Buffer*, 64> filled;
+
+	ISC_UINT64 snapshotNumber;
+	unsigned startedWorkers;
+	bool stop;
+	bool failed;
+	Firebird::FbLocalStatus errorStatus;
+};
+
+// Data of different relations is stored at once by several workers, every
+// worker has its own attachment and stores records of a relation in its own
+// transaction. The backup file is still read by the main thread only. It parses
+// the records and passes them to the worker storing the relation as a stream
+// of tagged items (blobs, their segments and messages) in the worker's buffers.
+//
+// When all data is stored, workers activate deferred indexes of different
+// relations at once.
+
+class RestoreRelationTask
+{
+public:
+	RestoreRelationTask(BurpGlobals* tdgbl, unsigned workerCount);
+	~RestoreRelationTask();
+
+	void finish();
+
+	// Pass data of the relation to a free worker (main thread)
+	void startRelation(burp_rel* relation, const Firebird::string& sql, Firebird::IMessageMetadata* meta);
+	void putBlob(ULONG offset, UCHAR type);
+	void putSegment(const UCHAR* data, USHORT length);
+	void putRow(const UCHAR* message, ULONG length);
+	void endRelation();
+
+	// Wait until workers store all the data passed
+	void waitLoaded();
+
+	void activateIndexes(const Firebird::ObjectsArray<Firebird::string>& relations);
+
+private:
+	static const ULONG BUFFER_SIZE = 256 * 1024;
+	static const unsigned BUFFERS_PER_WORKER = 4;
+
+	enum ItemTag
+	{
+		TAG_BLOB = 1,			// offset of blob id in the message, blob type
+		TAG_SEGMENT,			// length and data of the blob segment
+		TAG_ROW					// message
+	};
+
+	struct Buffer
+	{
+		UCHAR* data;
+		ULONG length;
+		bool last;				// the last buffer of the relation
+	};
+
+	class Worker
+	{
+	public:
+		Worker(RestoreRelationTask* t, unsigned n);
+		~Worker();
+
+		void start();
+		void wait();
+
+		burp_rel* relation;		// relation being stored, NULL if the worker is free
+		Firebird::string sql;
+		Firebird::RefPtr<Firebird::IMessageMetadata> meta;
+		Firebird::HalfStaticArray<Buffer*, BUFFERS_PER_WORKER> freeBuffers;
+		Firebird::HalfStaticArray<Buffer*, BUFFERS_PER_WORKER> filled;	// in the order of filling
+		Firebird::HalfStaticArray<Buffer, BUFFERS_PER_WORKER> buffers;
+
+	private:
+		static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg);
+		void run();
+		void load(BurpGlobals* gbl);
+		bool getTag(UCHAR& tag);
+		void read(void* to, ULONG length);
+		void nextBuffer();
+		void releaseBuffer();
+
+		RestoreRelationTask* const task;
+		const unsigned number;
+		Thread::Handle handle;
+		Buffer* current;
+		ULONG position;
+	};
+
+	friend class Worker;
+
+	void start();
+	void write(const void* data, ULONG length);
+	void passBuffer(bool last);
+	void checkErrors();
+
+	BurpGlobals* const mainGbl;
+	const unsigned workerCount;
+	Firebird::HalfStaticArray<Worker*, 8> workers;
+
+	Firebird::Mutex mutex;
+	Firebird::Condition workerCond;		// workers wait for relations, indexes and filled buffers
+	Firebird::Condition mainCond;		// main thread waits for free workers and buffers
+
+	Worker* loader;						// worker storing the relation passed by the main thread
+	Buffer* output;						// buffer being filled by the main thread
+	const Firebird::ObjectsArray<Firebird::string>* indexRelations;
+	FB_SIZE_T nextIndexRelation;
+	unsigned activeIndexRelations;
+	unsigned startedWorkers;
+	bool started;
+	bool stop;
+	bool failed;
+	bool offline;						// an index was not activated, don't bring the database online
+	Firebird::FbLocalStatus errorStatus;
+};
+
+} // namespace Burp
+
+#endif // BURP_BURP_TASKS_H
@@ -26,5 +26,12 @@
 
 int	BACKUP_backup (const TEXT*, const TEXT*);
 
+namespace Burp {
+	struct RelationData;
+	struct RangeMessage;
+}
+
+FB_UINT64	BACKUP_put_records(Burp::RelationData&, const Burp::RangeMessage*);
+
 #endif	//  BURP_BACKU_PROTO_H
 
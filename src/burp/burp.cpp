@@ -119,6 +119,9 @@ static Switches::in_sw_tab_t* findSwitchOrThrow(Firebird::UtilSvc*, Switches& sw
 static void processFetchPass(const SCHAR*& password, int& itr, const int argc, Firebird::UtilSvc::ArgvType& argv);
 
 
+// Serializes output of the workers of parallel restore and the main thread
+static Firebird::GlobalPtr<Firebird::Mutex> outputMutex;
+
 // fil.fil_length is FB_UINT64
 const ULONG KBYTE	= 1024;
 const ULONG MBYTE	= KBYTE * KBYTE;
@@ -822,8 +825,30 @@ int gbak(Firebird::UtilSvc* uSvc)
 		case IN_SW_BURP_ZIP:
 			if (tdgbl->gbl_sw_zip)
 				BURP_error(334, true, SafeArg() << in_sw_tab->in_sw_name);
+			if (tdgbl->gbl_sw_zstd)
+				BURP_error(332, true, SafeArg() << "ZIP" << "ZSTD");
 			tdgbl->gbl_sw_zip = true;
 			break;
+		case IN_SW_BURP_ZSTD:
+			if (tdgbl->gbl_sw_zstd)
+				BURP_error(333, true, SafeArg() << in_sw_tab->in_sw_name << tdgbl->gbl_sw_zstd);
+			if (tdgbl->gbl_sw_zip)
+				BURP_error(332, true, SafeArg() << "ZIP" << "ZSTD");
+			if (++itr >= argc)
+			{
+				BURP_error(416, true);
+				// msg 416 zstd compression level parameter missing
+			}
+			{	// scope
+				const SLONG level = get_number(argv[itr]);
+				if (level <= 0 || level > MAX_USHORT)
+				{
+					BURP_error(417, true, argv[itr]);
+					// msg 417 expected zstd compression level, encountered "@1"
+				}
+				tdgbl->gbl_sw_zstd = (USHORT) level;
+			}
+			break;
 		case IN_SW_BURP_FA:
 			if (tdgbl->gbl_sw_blk_factor)
 				BURP_error(333, true, SafeArg() << in_sw_tab->in_sw_name << tdgbl->gbl_sw_blk_factor);
@@ -839,6 +864,21 @@ int gbak(Firebird::UtilSvc* uSvc)
 				// msg 183 expected blocking factor, encountered "%s"
 			}
 			break;
+		case IN_SW_BURP_PARALLEL:
+			if (tdgbl->gbl_sw_par_workers)
+				BURP_error(333, true, SafeArg() << in_sw_tab->in_sw_name << tdgbl->gbl_sw_par_workers);
+			if (++itr >= argc)
+			{
+				BURP_error(406, true);
+				// msg 406 parallel workers parameter missing
+			}
+			tdgbl->gbl_sw_par_workers = get_number(argv[itr]);
+			if (!tdgbl->gbl_sw_par_workers)
+			{
+				BURP_error(407, true, argv[itr]);
+				// msg 407 expected parallel workers, encountered "%s"
+			}
+			break;
 		case IN_SW_BURP_FIX_FSS_DATA:
 			if (tdgbl->gbl_sw_fix_fss_data)
 				BURP_error(333, true, SafeArg() << in_sw_tab->in_sw_name << tdgbl->gbl_sw_fix_fss_data);
@@ -1306,6 +1346,9 @@ int gbak(Firebird::UtilSvc* uSvc)
 			const char* msg = switches.findNameByTag(errNum);
 			BURP_error(330, true, SafeArg() << msg);
 		}
+
+		// Transportable backup keeps records in portable binary format
+		tdgbl->gbl_binary_records = tdgbl->gbl_sw_transportable;
 	}
 	else
 	{
@@ -1337,6 +1380,8 @@ int gbak(Firebird::UtilSvc* uSvc)
 			errNum = IN_SW_BURP_OL;
 		else if (tdgbl->gbl_sw_zip)
 			errNum = IN_SW_BURP_ZIP;
+		else if (tdgbl->gbl_sw_zstd)
+			errNum = IN_SW_BURP_ZSTD;
 
 		if (errNum != IN_SW_BURP_0)
 		{
@@ -1432,6 +1477,9 @@ int gbak(Firebird::UtilSvc* uSvc)
 		exit_code = FINI_ERROR;
 	}
 
+	// Stop compression threads if an error interrupted the backup file I/O
+	MVOL_fini_zip(tdgbl);
+
 	// Close the gbak file handles if they still open
 	for (burp_fil* file = tdgbl->gbl_sw_backup_files; file; file = file->fil_next)
 	{
@@ -1989,6 +2037,9 @@ static gbak_action open_files(const TEXT* file1,
 			}
 			BURP_verbose(166, file1); // msg 166: readied database %s for backup
 
+			// parallel workers attach the database the same way
+			tdgbl->gbl_dpb_data.assign(dpb.getBuffer(), dpb.getBufferLength());
+
 			if (tdgbl->gbl_sw_keyholder)
 			{
 				unsigned char info[] = {fb_info_crypt_key, fb_info_crypt_plugin};
@@ -2431,6 +2482,8 @@ static void burp_output(bool err, const SCHAR* format, ...)
 
 	if (tdgbl->sw_redirect != NOOUTPUT && format[0] != '\0')
 	{
+		Firebird::MutexLockGuard guard(outputMutex, FB_FUNCTION);
+
 		va_start(arglist, format);
 		if (tdgbl->sw_redirect == REDIRECT && tdgbl->output_file != NULL)
 		{
@@ -203,9 +203,14 @@ Version 10: FB3.0.
 
 Version 11: FB4.0.
 			SQL SECURITY feature, tables RDB$PUBLICATIONS/RDB$PUBLICATION_TABLES.
+
+Version 12: FB5.0.
+			Records of transportable backups are stored in binary format instead
+			of XDR, see att_backup_binary and CAN_binary.
+			Backup file may be compressed by zstd in blocks, see att_backup_zstd.
 */
 
-const int ATT_BACKUP_FORMAT		= 11;
+const int ATT_BACKUP_FORMAT		= 12;
 
 // max array dimension
 
@@ -215,6 +220,10 @@ const int SERIES				= 1;
 
 const USHORT MAX_UPDATE_DBKEY_RECURSION_DEPTH = 16;
 
+// records passed to a batch at once when restoring data
+
+const int GBAK_BATCH_STEP		= 1000;
+
 
 enum att_type {
 	att_end = 0,		// end of major record
@@ -233,6 +242,8 @@ enum att_type {
 	att_backup_zip,			// zipped backup file
 	att_backup_hash,		// hash of crypt key
 	att_backup_crypt,		// name of crypt plugin
+	att_backup_binary,		// records in portable binary format instead of XDR
+	att_backup_zstd,		// backup file compressed by zstd in blocks, level
 
 	// Database attributes
 
@@ -917,6 +928,12 @@ const FB_UINT64 MIN_SPLIT_SIZE	= FB_CONST64(2048);		// bytes
 
 struct BurpCrypt;
 
+namespace Burp {
+	class BackupRelationTask;
+	class RestoreRelationTask;
+	class BlockZip;
+}
+
 
 class GblPool
 {
@@ -948,6 +965,7 @@ public:
 		: ThreadData(ThreadData::tddGBL),
 		  GblPool(us->isService()),
 		  defaultCollations(getPool()),
+		  gbl_dpb_data(getPool()),
 		  uSvc(us),
 		  verboseInterval(10000),
 		  flag_on_line(true),
@@ -980,6 +998,7 @@ public:
 	bool		gbl_sw_compress;
 	bool		gbl_sw_version;
 	bool		gbl_sw_transportable;
+	bool		gbl_binary_records;
 	bool		gbl_sw_incremental;
 	bool		gbl_sw_deactivate_indexes;
 	bool		gbl_sw_kill;
@@ -996,6 +1015,7 @@ public:
 	bool		gbl_sw_mode_val;
 	bool		gbl_sw_overwrite;
 	bool		gbl_sw_zip;
+	USHORT		gbl_sw_zstd;		// compression level, zero if zstd is not used
 	const SCHAR*	gbl_sw_keyholder;
 	const SCHAR*	gbl_sw_crypt;
 	const SCHAR*	gbl_sw_keyname;
@@ -1016,6 +1036,10 @@ public:
 	redirect_vals	sw_redirect;
 	bool		burp_throw;
 	Nullable<ReplicaMode>	gbl_sw_replica;
+	ULONG		gbl_sw_par_workers;
+	Burp::BackupRelationTask*	gbl_task;	// set in workers of parallel backup only
+	unsigned	gbl_task_worker;
+	Burp::RestoreRelationTask*	gbl_restore_task;	// set in the main thread of parallel restore
 
 	UCHAR*		blk_io_ptr;
 	int			blk_io_cnt;
@@ -1047,6 +1071,7 @@ public:
 	UCHAR*		gbl_crypt_buffer;
 	ULONG		gbl_crypt_left;
 	UCHAR*      gbl_decompress;
+	Burp::BlockZip*	gbl_block_zip;
 
 	burp_rel*	relations;
 	burp_pkg*	packages;
@@ -1174,6 +1199,7 @@ public:
 
 	Firebird::Array<Firebird::Pair<Firebird::NonPooled<Firebird::MetaString, Firebird::MetaString> > >
 		defaultCollations;
+	Firebird::UCharBuffer gbl_dpb_data;	// to attach parallel workers
 	Firebird::UtilSvc* uSvc;
 	ULONG verboseInterval;	// How many records should be backed up or restored before we show this message
 	bool flag_on_line;		// indicates whether we will bring the database on-line
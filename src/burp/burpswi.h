@@ -98,6 +98,8 @@ const int IN_SW_BURP_CRYPT				= 51;	// name of crypt plugin
 
 const int IN_SW_BURP_INCLUDE_DATA		= 52;	// backup data from tables
 const int IN_SW_BURP_REPLICA			= 53;	// replica mode
+const int IN_SW_BURP_PARALLEL			= 54;	// parallel workers
+const int IN_SW_BURP_ZSTD				= 55;	// backup file compressed by zstd
 
 /**************************************************************************/
 
@@ -164,6 +166,8 @@ static const Switches::in_sw_tab_t reference_burp_in_sw_table[] =
 				// msg 186: @1OLD_DESCRIPTIONS save old style metadata descriptions
 	{IN_SW_BURP_P,	isc_spb_res_page_size,		"PAGE_SIZE",		0, 0, 0, false, false,	101,	1, NULL, boRestore},
 				// msg 101: @1PAGE_SIZE override default page size
+	{IN_SW_BURP_PARALLEL,	isc_spb_bkp_parallel_workers,	"PARALLEL", 0, 0, 0, false, false,	405,	3, NULL, boGeneral},
+				// msg 405: @1PAR(ALLEL) parallel workers
 	{IN_SW_BURP_PASS, 0,						"PASSWORD", 		0, 0, 0, false, false,	190,	3, NULL, boGeneral},
 				// msg 190: @1PA(SSWORD) Firebird password
 	{IN_SW_BURP_RECREATE, 0,					"RECREATE_DATABASE", 0, 0, 0, false, false,	284,	1, NULL, boMain},
@@ -217,6 +221,8 @@ static const Switches::in_sw_tab_t reference_burp_in_sw_table[] =
 				// msg 104: @1Z print version number
 	{IN_SW_BURP_ZIP,  isc_spb_bkp_zip,			"ZIP",				0, 0, 0, false, true,	374,	3, NULL, boBackup},
 				// msg 104: @1ZIP backup file is in zip compressed format
+	{IN_SW_BURP_ZSTD, isc_spb_bkp_zstd_level,	"ZSTD",				0, 0, 0, false, false,	415,	4, NULL, boBackup},
+				// msg 415: @1ZSTD <level> backup file is compressed by zstd with given level
 /**************************************************************************/
 // The next two 'virtual' switches are hidden from user and are needed
 // for services API
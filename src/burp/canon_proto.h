@@ -24,7 +24,18 @@
 #ifndef BURP_CANON_PROTO_H
 #define BURP_CANON_PROTO_H
 
+// Binary records have the layout of gbak messages on little-endian platforms
+// which align doubles at 8 bytes. There they are written and read as is.
+
+#if !defined(WORDS_BIGENDIAN) && (FB_DOUBLE_ALIGN == 8)
+const bool CAN_BINARY_NATIVE = true;
+#else
+const bool CAN_BINARY_NATIVE = false;
+#endif
+
 ULONG	CAN_encode_decode (burp_rel* relation, lstring* buffer, UCHAR* data, bool direction, bool useMissingOffset = false);
+ULONG	CAN_binary (const burp_rel* relation, UCHAR* binary, ULONG binaryLength, UCHAR* data, bool direction,
+	bool useMissingOffset = false);
 ULONG	CAN_slice (lstring* buffer, lstring* slice, bool direction, UCHAR* sdl);
 
 #endif	// BURP_CANON_PROTO_H
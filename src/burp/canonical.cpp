@@ -40,6 +40,7 @@
 #include "../burp/canon_proto.h"
 #include "../common/sdl_proto.h"
 #include "../common/xdr_proto.h"
+#include "../common/Int128.h"
 #include "../common/gdsassert.h"
 #include "../common/StatusHolder.h"
 #include "../common/status.h"
@@ -59,6 +60,7 @@ struct BurpXdr : public xdr_t
 
 	lstring* x_public;
 };
+static void copy_value(UCHAR*, const UCHAR*, USHORT, ULONG);
 static bool_t expand_buffer(BurpXdr*);
 static int xdr_init(BurpXdr*, lstring*, enum xdr_op);
 static bool_t xdr_slice(BurpXdr*, lstring*, /*USHORT,*/ const UCHAR*);
@@ -260,6 +262,97 @@ ULONG CAN_encode_decode(burp_rel* relation, lstring* buffer, UCHAR* data, bool d
 }
 
 
+ULONG CAN_binary(const burp_rel* relation, UCHAR* binary, ULONG binaryLength, UCHAR* data,
+	bool direction, bool useMissingOffset)
+{
+/**************************************
+ *
+ *	C A N _ b i n a r y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Convert record between the message layout of this
+ *	platform and the binary backup format: little-endian
+ *	values of fields aligned as in message and followed by
+ *	null flags, doubles are aligned at 8 bytes.  Used only
+ *	where the layouts differ, see CAN_BINARY_NATIVE.
+ *	Returns the length of binary record or zero if it does
+ *	not fit into binaryLength bytes.
+ *
+ **************************************/
+	const burp_fld* field;
+	ULONG binary_offset = 0;
+	RCRD_OFFSET offset = 0;
+
+	for (field = relation->rel_fields; field; field = field->fld_next)
+	{
+		if (field->fld_flags & FLD_computed)
+			continue;
+
+		const bool array_fld = ((field->fld_flags & FLD_array) != 0);
+		FLD_LENGTH length = array_fld ? 8 : field->fld_length;
+		if (field->fld_type == blr_varying && !array_fld)
+			length += sizeof(USHORT);
+		if (field->fld_offset >= offset)
+			offset = field->fld_offset + length;
+
+		USHORT dtype;
+		if (field->fld_type == blr_blob || array_fld)
+			dtype = dtype_blob;
+		else
+			dtype = gds_cvt_blr_dtype[field->fld_type];
+
+		const USHORT alignment = (dtype == dtype_double || dtype == dtype_d_float) ?
+			sizeof(double) : type_alignments[dtype];
+		if (alignment)
+			binary_offset = FB_ALIGN(binary_offset, alignment);
+
+		UCHAR* const p = data + field->fld_offset;
+
+		if (binary_offset + length > binaryLength)
+			return 0;
+
+		if (direction)
+			copy_value(binary + binary_offset, p, dtype, length);
+		else
+			copy_value(p, binary + binary_offset, dtype, length);
+
+		binary_offset += length;
+	}
+
+	// Next, null flags
+
+	for (field = relation->rel_fields; field; field = field->fld_next)
+	{
+		if (field->fld_flags & FLD_computed)
+			continue;
+
+		UCHAR* p = data + field->fld_missing_offset;
+		if (!useMissingOffset)
+		{
+			offset = FB_ALIGN(offset, sizeof(SSHORT));
+			p = data + offset;
+			offset += sizeof(SSHORT);
+		}
+
+		binary_offset = FB_ALIGN(binary_offset, sizeof(SSHORT));
+
+		if (binary_offset + sizeof(SSHORT) > binaryLength)
+			return 0;
+
+		if (direction)
+			copy_value(binary + binary_offset, p, dtype_short, sizeof(SSHORT));
+		else
+			copy_value(p, binary + binary_offset, dtype_short, sizeof(SSHORT));
+
+		binary_offset += sizeof(SSHORT);
+	}
+
+	return binary_offset;
+}
+
+
 ULONG CAN_slice(lstring* buffer, lstring* slice, bool direction, UCHAR* sdl)
 {
 /**************************************
@@ -282,6 +375,112 @@ ULONG CAN_slice(lstring* buffer, lstring* slice, bool direction, UCHAR* sdl)
 }
 
 
+#ifdef WORDS_BIGENDIAN
+static void swap_bytes(UCHAR* to, const UCHAR* from, unsigned length)
+{
+	for (const UCHAR* p = from + length; p > from;)
+		*to++ = *--p;
+}
+#endif
+
+
+static void copy_value(UCHAR* to, const UCHAR* from, USHORT dtype, ULONG length)
+{
+/**************************************
+ *
+ *	c o p y _ v a l u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Copy value of a field to or from binary record
+ *	changing byte order of its parts if needed.
+ *
+ **************************************/
+#ifdef WORDS_BIGENDIAN
+	// Parts of the value which byte order is changed, zero terminated
+	static const UCHAR parts_short[] = {2, 0};
+	static const UCHAR parts_long[] = {4, 0};
+	static const UCHAR parts_hyper[] = {8, 0};
+	static const UCHAR parts_dec128[] = {16, 0};
+	// Int128 is an array of machine words, least significant first
+#ifdef TTMATH_PLATFORM64
+	static const UCHAR parts_int128[] = {8, 8, 0};
+#else
+	static const UCHAR parts_int128[] = {4, 4, 4, 4, 0};
+#endif
+	static const UCHAR parts_quad[] = {4, 4, 0};
+	static const UCHAR parts_time_tz[] = {4, 2, 0};
+	static const UCHAR parts_ex_time_tz[] = {4, 2, 2, 0};
+	static const UCHAR parts_timestamp_tz[] = {4, 4, 2, 0};
+	static const UCHAR parts_ex_timestamp_tz[] = {4, 4, 2, 2, 0};
+
+	const UCHAR* parts = NULL;
+
+	switch (dtype)
+	{
+	case dtype_varying:
+	case dtype_short:
+		parts = parts_short;
+		break;
+
+	case dtype_long:
+	case dtype_sql_time:
+	case dtype_sql_date:
+	case dtype_real:
+		parts = parts_long;
+		break;
+
+	case dtype_double:
+	case dtype_int64:
+	case dtype_dec64:
+		parts = parts_hyper;
+		break;
+
+	case dtype_dec128:
+		parts = parts_dec128;
+		break;
+
+	case dtype_int128:
+		parts = parts_int128;
+		break;
+
+	case dtype_quad:
+	case dtype_blob:
+	case dtype_timestamp:
+		parts = parts_quad;
+		break;
+
+	case dtype_sql_time_tz:
+		parts = parts_time_tz;
+		break;
+
+	case dtype_ex_time_tz:
+		parts = parts_ex_time_tz;
+		break;
+
+	case dtype_timestamp_tz:
+		parts = parts_timestamp_tz;
+		break;
+
+	case dtype_ex_timestamp_tz:
+		parts = parts_ex_timestamp_tz;
+		break;
+	}
+
+	if (parts)
+	{
+		for (; *parts; length -= *parts, to += *parts, from += *parts, ++parts)
+			swap_bytes(to, from, *parts);
+	}
+#endif
+
+	// The rest, i.e. characters of strings
+	if (length)
+		memcpy(to, from, length);
+}
+
+
 bool_t BurpXdr::x_getbytes(SCHAR* buff, unsigned bytecount)
 {
 /**************************************
@@ -40,6 +40,7 @@
 # endif
 #endif
 #include "../burp/burp.h"
+#include "../burp/BurpTasks.h"
 #include "../burp/burp_proto.h"
 #include "../burp/mvol_proto.h"
 #include "../burp/split/spit.h"
@@ -66,6 +67,7 @@
 #include "../common/db_alias.h"
 #include "../common/status.h"
 #include "../common/classes/zip.h"
+#include "../burp/BlockZip.h"
 
 using MsgFormat::SafeArg;
 using Firebird::FbLocalStatus;
@@ -115,6 +117,10 @@ const int burp_msg_fac = 12;
 static Firebird::InitInstance<Firebird::ZLib> zlib;
 #endif // HAVE_ZLIB_H
 
+#ifdef HAVE_ZSTD_H
+static Firebird::InitInstance<Firebird::ZStd> zstd;
+#endif // HAVE_ZSTD_H
+
 static void  bad_attribute(int, USHORT);
 static void  file_not_empty();
 static SLONG get_numeric();
@@ -425,6 +431,18 @@ static ULONG crypt_read_block(BurpGlobals* tdgbl, UCHAR* buffer, FB_SIZE_T buffe
 
 static ULONG unzip_read_block(BurpGlobals* tdgbl, UCHAR* buffer, FB_SIZE_T buffer_length)
 {
+#ifdef HAVE_ZSTD_H
+	if (tdgbl->gbl_block_zip)
+	{
+		const ULONG length = tdgbl->gbl_block_zip->read(buffer, buffer_length);
+		if (!length)
+			BURP_error(379, true, SafeArg() << "unexpected end of compressed data");
+			// msg 379 Inflate error @1
+
+		return length;
+	}
+#endif
+
 	if (!tdgbl->gbl_sw_zip)
 	{
 		return crypt_read_block(tdgbl, buffer, buffer_length);
@@ -491,6 +509,16 @@ static ULONG unzip_read_block(BurpGlobals* tdgbl, UCHAR* buffer, FB_SIZE_T buffe
 
 static void zip_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T buffer_length, bool flash)
 {
+#ifdef HAVE_ZSTD_H
+	if (tdgbl->gbl_block_zip)
+	{
+		tdgbl->gbl_block_zip->write(buffer, buffer_length);
+		if (flash)
+			tdgbl->gbl_block_zip->finish();
+		return;
+	}
+#endif
+
 	if (!tdgbl->gbl_sw_zip)
 	{
 		crypt_write_block(tdgbl, buffer, buffer_length, flash);
@@ -570,6 +598,7 @@ FB_UINT64 MVOL_fini_read()
 	}
 #endif
 
+	MVOL_fini_zip(tdgbl);
 	brio_fini(tdgbl);
 
 	return mvol_fini_read(tdgbl);
@@ -615,6 +644,7 @@ FB_UINT64 MVOL_fini_write()
 	}
 #endif
 
+	MVOL_fini_zip(tdgbl);
 	brio_fini(tdgbl);
 
 	return mvol_fini_write(tdgbl, &tdgbl->blk_io_cnt, &tdgbl->blk_io_ptr);
@@ -688,6 +718,49 @@ static void checkCompression()
 }
 
 
+// Stop threads compressing or decompressing the backup file
+void MVOL_fini_zip(BurpGlobals* tdgbl)
+{
+#ifdef HAVE_ZSTD_H
+	delete tdgbl->gbl_block_zip;
+	tdgbl->gbl_block_zip = NULL;
+#endif
+}
+
+
+static void start_block_zip(BurpGlobals* tdgbl, bool write)
+{
+#ifdef HAVE_ZSTD_H
+	if (!zstd())
+	{
+		(Firebird::Arg::Gds(isc_random) << "Compession support library not loaded" <<
+		 Firebird::Arg::StatusVector(zstd().status)).raise();
+	}
+
+	// Blocks are compressed by as many threads as parallel workers
+	const unsigned threads = MAX(tdgbl->gbl_sw_par_workers, 1);
+
+	if (write)
+	{
+		const int maxLevel = zstd().maxCLevel();
+		if (tdgbl->gbl_sw_zstd > maxLevel)
+			BURP_error(418, true, SafeArg() << tdgbl->gbl_sw_zstd << maxLevel);
+			// msg 418 zstd compression level @1 is out of range 1 - @2
+
+		tdgbl->gbl_block_zip = FB_NEW_POOL(tdgbl->getPool())
+			Burp::BlockZip(tdgbl, zstd(), threads, tdgbl->gbl_sw_zstd, crypt_write_block);
+	}
+	else
+	{
+		tdgbl->gbl_block_zip = FB_NEW_POOL(tdgbl->getPool())
+			Burp::BlockZip(tdgbl, zstd(), threads, crypt_read_block);
+	}
+#else
+	(Firebird::Arg::Gds(isc_random) << "No zstd support").raise();
+#endif
+}
+
+
 //____________________________________________________________
 //
 // Read init record from backup file
@@ -701,6 +774,9 @@ void MVOL_init_read(const char* file_name, USHORT* format)
 	tdgbl->gbl_io_cnt = 0;
 	tdgbl->gbl_io_ptr = NULL;
 
+	if (tdgbl->gbl_sw_zstd)
+		start_block_zip(tdgbl, false);
+
 	if (tdgbl->gbl_sw_zip)
 	{
 #ifdef HAVE_ZLIB_H
@@ -769,6 +845,9 @@ void MVOL_init_write(const char* file_name)
 	tdgbl->gbl_io_cnt = ZC_BUFSIZE;
 	tdgbl->gbl_io_ptr = tdgbl->gbl_compress_buffer;
 
+	if (tdgbl->gbl_sw_zstd)
+		start_block_zip(tdgbl, true);
+
 #ifdef HAVE_ZLIB_H
 	if (tdgbl->gbl_sw_zip)
 	{
@@ -1082,6 +1161,13 @@ DESC NT_tape_open(const char* name, ULONG mode, ULONG create)
 //
 void MVOL_write(BurpGlobals* tdgbl)
 {
+	// Workers of parallel backup pass the buffer to the main thread
+	if (tdgbl->gbl_task)
+	{
+		tdgbl->gbl_task->putBuffer(tdgbl);
+		return;
+	}
+
 	fb_assert(tdgbl->gbl_io_ptr >= tdgbl->gbl_compress_buffer);
 	fb_assert(tdgbl->gbl_io_ptr <= tdgbl->gbl_compress_buffer + ZC_BUFSIZE);
 
@@ -1316,12 +1402,7 @@ const UCHAR* MVOL_write_block(BurpGlobals* tdgbl, const UCHAR* ptr, ULONG count)
 	{
 		// If buffer full, write it
 		if (tdgbl->gbl_io_cnt <= 0)
-		{
-			zip_write_block(tdgbl, tdgbl->gbl_compress_buffer, tdgbl->gbl_io_ptr - tdgbl->gbl_compress_buffer, false);
-
-			tdgbl->gbl_io_ptr = tdgbl->gbl_compress_buffer;
-			tdgbl->gbl_io_cnt = ZC_BUFSIZE;
-		}
+			MVOL_write(tdgbl);
 
 		const ULONG n = MIN(count, (ULONG) tdgbl->gbl_io_cnt);
 
@@ -1843,6 +1924,14 @@ static bool read_header(DESC handle, ULONG* buffer_size, USHORT* format, bool in
 			}
 			break;
 
+		case att_backup_binary:
+			temp = get_numeric();
+			if (init_flag)
+			{
+				tdgbl->gbl_binary_records = temp != 0;
+			}
+			break;
+
 		case att_backup_volume:
 			temp = get_numeric();
 			if (temp != tdgbl->mvol_volume_count)
@@ -1913,6 +2002,14 @@ static bool read_header(DESC handle, ULONG* buffer_size, USHORT* format, bool in
 				tdgbl->gbl_sw_zip = true;
 			break;
 
+		case att_backup_zstd:
+			temp = get_numeric();
+			if (init_flag)
+			{
+				tdgbl->gbl_sw_zstd = (USHORT) temp;
+			}
+			break;
+
 		case att_backup_hash:
 			if (!tdgbl->gbl_sw_keyholder)
 				BURP_error(376, true);
@@ -1967,9 +2064,15 @@ static bool write_header(DESC handle, ULONG backup_buffer_size, bool full_buffer
 		if (tdgbl->gbl_sw_transportable)
 			put_numeric(att_backup_transportable, 1);
 
+		if (tdgbl->gbl_binary_records)
+			put_numeric(att_backup_binary, 1);
+
 		if (tdgbl->gbl_sw_zip)
 			put_numeric(att_backup_zip, 1);
 
+		if (tdgbl->gbl_sw_zstd)
+			put_numeric(att_backup_zstd, tdgbl->gbl_sw_zstd);
+
 		put_numeric(att_backup_blksize, backup_buffer_size);
 
 		tdgbl->mvol_io_volume = tdgbl->mvol_io_ptr + 2;
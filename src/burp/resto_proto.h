@@ -26,5 +26,10 @@
 
 int	RESTORE_restore(const TEXT*, const TEXT*);
 
+// Used by workers of parallel restore
+void	RESTORE_activate_indexes(BurpGlobals*, const TEXT*);
+Firebird::IBatch*	RESTORE_create_batch(BurpGlobals*, const Firebird::string&, Firebird::IMessageMetadata*);
+FB_UINT64	RESTORE_execute_batch(BurpGlobals*, burp_rel*, Firebird::IBatch*);
+
 #endif	// BURP_RESTO_PROTO_H
 
@@ -0,0 +1,461 @@
+/*
+ *	PROGRAM:	Common class definition
+ *	MODULE:		BlockZip.cpp
+ *	DESCRIPTION:	Block compression of a stream by several threads
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../common/classes/BlockZip.h"
+
+#ifdef HAVE_ZSTD_H
+
+namespace
+{
+	void putLong(UCHAR* p, ULONG value)
+	{
+		for (int n = 0; n < 4; n++, value >>= 8)
+			p[n] = (UCHAR) value;
+	}
+
+	ULONG getLong(const UCHAR* p)
+	{
+		return p[0] | (p[1] << 8) | (p[2] << 16) | ((ULONG) p[3] << 24);
+	}
+} // namespace
+
+namespace Firebird {
+
+BlockZip::BlockZip(MemoryPool& p, ZStd& z, bool comp, int lvl)
+	: pool(p),
+	  zstd(z),
+	  compress(comp),
+	  level(lvl),
+	  workers(p),
+	  blocks(p),
+	  freeBlocks(p),
+	  queue(p),
+	  current(NULL),
+	  position(0),
+	  eof(false),
+	  stop(false),
+	  inputBuffer(p),
+	  inputPosition(0),
+	  inputLength(0)
+{
+	if (!compress)
+		inputBuffer.getBuffer(INPUT_SIZE);
+}
+
+BlockZip::~BlockZip()
+{
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+		stop = true;
+		workerCond.notifyAll();
+	}
+
+	for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+	{
+		(*worker)->wait();
+		delete *worker;
+	}
+
+	for (Block** block = blocks.begin(); block != blocks.end(); ++block)
+		delete *block;
+}
+
+// Every thread has a block being (de)compressed and one more filled
+// or read by the main thread meanwhile
+void BlockZip::start(unsigned threadCount)
+{
+	for (unsigned n = 0; n < threadCount * BLOCKS_PER_THREAD; n++)
+	{
+		Block* const block = FB_NEW_POOL(pool) Block(pool);
+		blocks.add(block);
+		freeBlocks.add(block);
+	}
+
+	for (unsigned n = 0; n < threadCount; n++)
+		workers.add(FB_NEW_POOL(pool) Worker(this));
+
+	for (Worker** worker = workers.begin(); worker != workers.end(); ++worker)
+		(*worker)->start();
+}
+
+void BlockZip::write(const UCHAR* data, ULONG length)
+{
+	fb_assert(compress);
+
+	while (length)
+	{
+		if (!current)
+		{
+			// Write the first block of the stream if there are no free ones
+			if (freeBlocks.hasData())
+				current = freeBlocks.pop();
+			else
+			{
+				current = takeBlock(true);
+				writeFrame(current);
+			}
+
+			current->input.getBuffer(BLOCK_SIZE);
+			current->length = 0;
+		}
+
+		const ULONG step = MIN(length, BLOCK_SIZE - current->length);
+		memcpy(current->input.begin() + current->length, data, step);
+		current->length += step;
+		data += step;
+		length -= step;
+
+		if (current->length == BLOCK_SIZE)
+		{
+			submit(current);
+			current = NULL;
+
+			// Write blocks compressed meanwhile
+			Block* block;
+			while ((block = takeBlock(false)))
+			{
+				writeFrame(block);
+				freeBlocks.push(block);
+			}
+		}
+	}
+}
+
+void BlockZip::finish()
+{
+	fb_assert(compress);
+
+	if (current && current->length)
+		submit(current);
+
+	current = NULL;
+
+	while (queue.hasData())
+	{
+		Block* const block = takeBlock(true);
+		writeFrame(block);
+		freeBlocks.push(block);
+	}
+
+	UCHAR header[FRAME_HEADER_SIZE];
+	memset(header, 0, sizeof(header));
+	putData(header, sizeof(header), true);
+}
+
+ULONG BlockZip::read(UCHAR* data, ULONG length)
+{
+	fb_assert(!compress);
+
+	while (!current || position >= current->rawLength)
+	{
+		if (current)
+		{
+			freeBlocks.push(current);
+			current = NULL;
+		}
+
+		// Pass the next frames to the workers while they decompress the previous ones
+		while (!eof && freeBlocks.hasData())
+		{
+			Block* const block = freeBlocks.pop();
+
+			if (!readFrame(block))
+			{
+				freeBlocks.push(block);
+				break;
+			}
+
+			submit(block);
+		}
+
+		if (queue.isEmpty())
+		{
+			fb_assert(eof);
+			return 0;
+		}
+
+		current = takeBlock(true);
+		position = 0;
+	}
+
+	length = MIN(length, current->rawLength - position);
+	memcpy(data, current->output.begin() + position, length);
+	position += length;
+
+	return length;
+}
+
+// Pass the block to workers. Blocks are queued and freed by the main thread
+// only, workers just change their state.
+void BlockZip::submit(Block* block)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	block->state = BLOCK_FILLED;
+	queue.add(block);
+	workerCond.notifyOne();
+}
+
+// Take the first block of the stream when it's done
+BlockZip::Block* BlockZip::takeBlock(bool wait)
+{
+	Block* block = NULL;
+
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+
+		if (queue.isEmpty())
+			return NULL;
+
+		block = queue[0];
+
+		if (block->state != BLOCK_DONE && !wait)
+			return NULL;
+
+		while (block->state != BLOCK_DONE)
+			mainCond.wait(mutex);
+
+		queue.remove((FB_SIZE_T) 0);
+		block->state = BLOCK_FREE;
+	}
+
+	if (block->error)
+	{
+		freeBlocks.push(block);
+		raiseError(false, block->error);
+	}
+
+	return block;
+}
+
+void BlockZip::writeFrame(Block* block)
+{
+	UCHAR header[FRAME_HEADER_SIZE];
+	putLong(header, block->output.getCount());
+	putLong(header + 4, block->length);
+
+	putData(header, sizeof(header), false);
+	putData(block->output.begin(), block->output.getCount(), false);
+}
+
+// Read the next frame into the block, returns false at the end of stream
+bool BlockZip::readFrame(Block* block)
+{
+	UCHAR header[FRAME_HEADER_SIZE];
+	readInput(header, sizeof(header));
+
+	block->length = getLong(header);
+	block->rawLength = getLong(header + 4);
+
+	if (!block->length)
+	{
+		eof = true;
+		return false;
+	}
+
+	if (!block->rawLength || block->rawLength > BLOCK_SIZE ||
+		block->length > ZSTD_COMPRESSBOUND(BLOCK_SIZE))
+	{
+		raiseError(false, "wrong block length");
+	}
+
+	readInput(block->input.getBuffer(block->length), block->length);
+
+	return true;
+}
+
+// Read exactly the given number of bytes of compressed data. It's read
+// in large portions, encrypted data can't be read by few bytes.
+void BlockZip::readInput(UCHAR* data, ULONG length)
+{
+	while (length)
+	{
+		if (inputPosition == inputLength)
+		{
+			inputPosition = 0;
+			inputLength = getData(inputBuffer.begin(), INPUT_SIZE);
+
+			if (!inputLength)
+				raiseError(false, "unexpected end of compressed data");
+		}
+
+		const ULONG step = MIN(length, inputLength - inputPosition);
+		memcpy(data, inputBuffer.begin() + inputPosition, step);
+		inputPosition += step;
+		data += step;
+		length -= step;
+	}
+}
+
+
+// Worker
+
+BlockZip::Worker::Worker(BlockZip* z)
+	: zip(z), handle(0), cStream(NULL), dStream(NULL)
+{
+	ZStd& zstd = zip->zstd;
+
+	if (zip->compress)
+	{
+		cStream = zstd.createCStream();
+		if (cStream)
+			zstd.CCtx_setParameter(cStream, ZSTD_c_compressionLevel, zip->level);
+	}
+	else
+		dStream = zstd.createDStream();
+
+	if (!cStream && !dStream)
+		zip->raiseError(true, "out of memory");
+}
+
+BlockZip::Worker::~Worker()
+{
+	if (cStream)
+		zip->zstd.freeCStream(cStream);
+
+	if (dStream)
+		zip->zstd.freeDStream(dStream);
+}
+
+void BlockZip::Worker::start()
+{
+	Thread::start(workerThread, this, THREAD_medium, &handle);
+}
+
+void BlockZip::Worker::wait()
+{
+	if (handle)
+	{
+		Thread::waitForCompletion(handle);
+		handle = 0;
+	}
+}
+
+THREAD_ENTRY_DECLARE BlockZip::Worker::workerThread(THREAD_ENTRY_PARAM arg)
+{
+	static_cast<Worker*>(arg)->run();
+	return 0;
+}
+
+void BlockZip::Worker::run()
+{
+	MutexLockGuard guard(zip->mutex, FB_FUNCTION);
+
+	while (!zip->stop)
+	{
+		Block* block = NULL;
+
+		for (Block** ptr = zip->queue.begin(); ptr != zip->queue.end(); ++ptr)
+		{
+			if ((*ptr)->state == BLOCK_FILLED)
+			{
+				block = *ptr;
+				break;
+			}
+		}
+
+		if (!block)
+		{
+			zip->workerCond.wait(zip->mutex);
+			continue;
+		}
+
+		block->state = BLOCK_BUSY;
+
+		{	// scope
+			MutexUnlockGuard unlock(zip->mutex, FB_FUNCTION);
+			process(block);
+		}
+
+		block->state = BLOCK_DONE;
+		zip->mainCond.notifyOne();
+	}
+}
+
+void BlockZip::Worker::process(Block* block)
+{
+	ZStd& zstd = zip->zstd;
+	block->error = NULL;
+
+	ZSTD_inBuffer in;
+	in.src = block->input.begin();
+	in.size = block->length;
+	in.pos = 0;
+
+	ZSTD_outBuffer out;
+	out.pos = 0;
+
+	size_t ret;
+
+	if (cStream)
+	{
+		// Compressed data exceeding the block is unlikely, grow the buffer then
+		out.size = block->length + block->length / 8 + 1024;
+		out.dst = block->output.getBuffer(out.size);
+
+		while ((ret = zstd.compressStream2(cStream, &out, &in, ZSTD_e_end)) != 0)
+		{
+			if (zstd.isError(ret))
+			{
+				block->error = zstd.getErrorName(ret);
+				return;
+			}
+
+			out.size += ret;
+			out.dst = block->output.getBuffer(out.size, true);
+		}
+
+		block->output.shrink(out.pos);
+	}
+	else
+	{
+		out.size = block->rawLength;
+		out.dst = block->output.getBuffer(out.size);
+
+		zstd.initDStream(dStream);
+
+		while (in.pos < in.size)
+		{
+			const size_t was = out.pos;
+			ret = zstd.decompressStream(dStream, &out, &in);
+
+			if (zstd.isError(ret))
+			{
+				block->error = zstd.getErrorName(ret);
+				return;
+			}
+
+			if (ret == 0 || (out.pos == was && out.pos == out.size))
+				break;
+		}
+
+		if (out.pos != block->rawLength || in.pos != in.size)
+			block->error = "wrong block length";
+	}
+}
+
+} // namespace Firebird
+
+#endif // HAVE_ZSTD_H
@@ -0,0 +1,169 @@
+/*
+ *	PROGRAM:	Common class definition
+ *	MODULE:		BlockZip.h
+ *	DESCRIPTION:	Block compression of a stream by several threads
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef COMMON_CLASSES_BLOCK_ZIP_H
+#define COMMON_CLASSES_BLOCK_ZIP_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/condition.h"
+#include "../common/classes/locks.h"
+#include "../common/classes/zip.h"
+#include "../common/ThreadStart.h"
+
+#ifdef HAVE_ZSTD_H
+
+namespace Firebird {
+
+// Stream is split into blocks compressed by zstd independently of each
+// other, so several threads compress or decompress them at once.
+// Every block is written as a frame:
+//
+//	compressed length	4 bytes, little-endian
+//	original length		4 bytes, little-endian
+//	compressed data
+//
+// Frame with zero lengths ends the stream. The main thread fills blocks and
+// writes frames in their order, workers only (de)compress them. Frames are
+// read ahead while workers decompress the previous ones.
+//
+// Derived class passes the compressed stream to and from its storage and
+// raises errors the way of its utility.
+
+class BlockZip
+{
+public:
+	static const ULONG BLOCK_SIZE = 1024 * 1024;
+
+	virtual ~BlockZip();
+
+	// Compression (main thread)
+	void write(const UCHAR* data, ULONG length);
+	void finish();
+
+	// Decompression (main thread), returns number of bytes read, zero at the end of stream
+	ULONG read(UCHAR* data, ULONG length);
+
+protected:
+	BlockZip(MemoryPool& pool, ZStd& zstd, bool compress, int level);
+
+	// Called by the constructor of the derived class
+	void start(unsigned threadCount);
+
+	bool isCompress() const
+	{
+		return compress;
+	}
+
+	// Write compressed data, last is set for the end of stream
+	virtual void putData(const UCHAR* data, ULONG length, bool last) = 0;
+	// Read compressed data, returns number of bytes read
+	virtual ULONG getData(UCHAR* data, ULONG length) = 0;
+	// Doesn't return, init is set when (de)compression stream can't be created
+	virtual void raiseError(bool init, const char* text) = 0;
+
+private:
+	static const ULONG FRAME_HEADER_SIZE = 8;
+	static const ULONG INPUT_SIZE = 64 * 1024;
+	static const unsigned BLOCKS_PER_THREAD = 2;
+
+	enum BlockState
+	{
+		BLOCK_FREE,
+		BLOCK_FILLED,			// waits for a worker
+		BLOCK_BUSY,				// being (de)compressed
+		BLOCK_DONE
+	};
+
+	struct Block
+	{
+		explicit Block(MemoryPool& p)
+			: input(p), output(p), length(0), rawLength(0), state(BLOCK_FREE), error(NULL)
+		{ }
+
+		UCharBuffer input;
+		UCharBuffer output;
+		ULONG length;			// of data in input
+		ULONG rawLength;		// of decompressed data
+		BlockState state;
+		const char* error;
+	};
+
+	class Worker
+	{
+	public:
+		explicit Worker(BlockZip* z);
+		~Worker();
+
+		void start();
+		void wait();
+
+	private:
+		static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg);
+		void run();
+		void process(Block* block);
+
+		BlockZip* const zip;
+		Thread::Handle handle;
+		ZSTD_CStream* cStream;
+		ZSTD_DStream* dStream;
+	};
+
+	friend class Worker;
+
+	void submit(Block* block);
+	Block* takeBlock(bool wait);
+	void writeFrame(Block* block);
+	bool readFrame(Block* block);
+	void readInput(UCHAR* data, ULONG length);
+
+	MemoryPool& pool;
+	ZStd& zstd;
+	const bool compress;
+	const int level;
+
+	HalfStaticArray<Worker*, 8> workers;
+	HalfStaticArray<Block*, 16> blocks;
+	HalfStaticArray<Block*, 16> freeBlocks;
+	HalfStaticArray<Block*, 16> queue;		// blocks in the order of the stream
+
+	Mutex mutex;
+	Condition workerCond;		// workers wait for filled blocks
+	Condition mainCond;			// main thread waits for done blocks
+
+	Block* current;				// block being filled or read by the main thread
+	ULONG position;				// in the current block
+	bool eof;					// the end frame is read
+	bool stop;
+
+	UCharBuffer inputBuffer;	// compressed data not parsed yet
+	ULONG inputPosition;
+	ULONG inputLength;
+};
+
+} // namespace Firebird
+
+#endif // HAVE_ZSTD_H
+
+#endif // COMMON_CLASSES_BLOCK_ZIP_H
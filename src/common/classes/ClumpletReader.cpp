@@ -343,6 +343,8 @@ ClumpletReader::ClumpletType ClumpletReader::getClumpletType(UCHAR tag) const
 			case isc_spb_bkp_crypt:
 				return StringSpb;
 			case isc_spb_bkp_factor:
+			case isc_spb_bkp_parallel_workers:
+			case isc_spb_bkp_zstd_level:
 			case isc_spb_bkp_length:
 			case isc_spb_res_length:
 			case isc_spb_res_buffers:
@@ -453,6 +455,8 @@ ClumpletReader::ClumpletType ClumpletReader::getClumpletType(UCHAR tag) const
 			case isc_spb_nbk_guid:
 				return StringSpb;
 			case isc_spb_nbk_level:
+			case isc_spb_nbk_parallel_workers:
+			case isc_spb_nbk_zstd_level:
 			case isc_spb_options:
 				return IntSpb;
 			}
@@ -512,6 +516,12 @@ ClumpletReader::ClumpletType ClumpletReader::getClumpletType(UCHAR tag) const
 		case isc_spb_multi_tra_id_64:
 		case isc_spb_single_tra_id_64:
 		case isc_spb_tra_id_64:
+		case isc_spb_wire_requests:
+		case isc_spb_wire_queue_time:
+		case isc_spb_wire_service_time:
+		case isc_spb_wire_pending:
+		case isc_spb_wire_active:
+		case isc_spb_wire_peak_workers:
 			return BigIntSpb;
 		case isc_info_svc_server_version:
 		case isc_info_svc_implementation:
@@ -530,6 +540,7 @@ ClumpletReader::ClumpletType ClumpletReader::getClumpletType(UCHAR tag) const
 		case isc_info_end:
 		case isc_info_svc_svr_db_info:
 		case isc_info_svc_limbo_trans:
+		case isc_info_svc_wire_stats:
 		case isc_info_flag_end:
 		case isc_info_truncated:
 		case isc_info_svc_timeout:
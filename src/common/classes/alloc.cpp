@@ -141,6 +141,12 @@ size_t delayedExtentsPos = 0;
 // Could slowdown pool significantly !
 //#define VALIDATE_POOL
 
+// Thread caches keep freed blocks outside of the pool lists,
+// so they are not compatible with pool checking and debugging.
+#if !defined(MEM_DEBUG) && !defined(USE_VALGRIND) && !defined(VALIDATE_POOL)
+#define USE_THREAD_CACHES
+#endif
+
 typedef Firebird::AtomicCounter::counter_type StatInt;
 
 // We cache this amount of extents to avoid memory mapping overhead
@@ -1721,6 +1727,97 @@ private:
 };
 
 
+#ifdef USE_THREAD_CACHES
+
+// Cache of freed small and medium blocks of a pool. A pool has a few caches,
+// each one used by the threads with the same hash of the thread id. Blocks freed
+// by a thread are reused by its next allocations of the same size without taking
+// the pool mutex. When too many blocks of a size are cached, half of them is
+// returned to the pool at once. A cache holds no more than MAX_BYTES, further
+// blocks go to the pool directly. When the pool uses less memory than a cache
+// holds, the whole cache is returned to the pool.
+
+class BlockCache
+{
+public:
+	static const unsigned CACHES_PER_POOL = 16;
+	static const unsigned MAX_BLOCKS = 32;		// per slot
+	static const size_t MAX_BYTES = 64 * 1024;	// per cache
+	static const unsigned TOTAL_SLOTS = LowLimits::TOTAL_ELEMENTS + MediumLimits::TOTAL_ELEMENTS;
+
+	BlockCache()
+		: bytes(0)
+	{
+		memset(blocks, 0, sizeof(blocks));
+		memset(counts, 0, sizeof(counts));
+	}
+
+	// Take all the cached blocks as a single list
+	MemBlock* takeAll()
+	{
+		MemBlock* list = NULL;
+
+		for (unsigned slot = 0; slot < TOTAL_SLOTS; slot++)
+		{
+			MemBlock* block = blocks[slot];
+
+			while (block)
+			{
+				MemBlock* const next = block->next;
+				block->next = list;
+				list = block;
+				block = next;
+			}
+
+			blocks[slot] = NULL;
+			counts[slot] = 0;
+		}
+
+		bytes = 0;
+		return list;
+	}
+
+	// Cache of the current thread. Thread::getId() is not used here
+	// as it may be a system call.
+	static unsigned getIndex()
+	{
+#ifdef WIN_NT
+		const FB_UINT64 id = GetCurrentThreadId();
+#else
+		const FB_UINT64 id = (FB_UINT64) (U_IPTR) pthread_self();
+#endif
+		return (unsigned) ((id * FB_CONST64(0x9E3779B97F4A7C15)) >> 60) % CACHES_PER_POOL;
+	}
+
+	// Slot for blocks of the given full size, ~0 if such blocks are not cached
+	static unsigned getSlot(size_t size, size_t& blockSize)
+	{
+		if (size <= LowLimits::TOP_LIMIT)
+		{
+			const unsigned slot = LowLimits::getSlot(size, SLOT_ALLOC);
+			blockSize = LowLimits::getSize(slot);
+			return slot;
+		}
+
+		if (size <= MediumLimits::TOP_LIMIT)
+		{
+			const unsigned slot = MediumLimits::getSlot(size, SLOT_ALLOC);
+			blockSize = MediumLimits::getSize(slot);
+			return LowLimits::TOTAL_ELEMENTS + slot;
+		}
+
+		return ~0u;
+	}
+
+	Mutex mutex;
+	MemBlock* blocks[TOTAL_SLOTS];
+	unsigned counts[TOTAL_SLOTS];
+	size_t bytes;
+};
+
+#endif // USE_THREAD_CACHES
+
+
 // Implementation of memory pool
 
 class MemPool
@@ -1743,6 +1840,9 @@ private:
 	Vector<MemBlock*, 16> parentRedirected;
 	FreeObjects<DoubleLinkedList, MediumLimits> mediumObjects;
 	MemBigHunk*		bigHunks;
+#ifdef USE_THREAD_CACHES
+	BlockCache*		threadCaches;
+#endif
 
 	Mutex			mutex;
 	int				blocksAllocated;
@@ -1802,10 +1902,18 @@ private:
 	MemBlock* alloc(size_t from, size_t& length, bool flagRedirect);
 	void releaseBlock(MemBlock *block, bool flagDecr) noexcept;
 
+#ifdef USE_THREAD_CACHES
+	MemBlock* getCachedBlock(size_t& length);
+	bool cacheBlock(MemBlock* block) noexcept;
+	void releaseBlocks(MemBlock* list) noexcept;
+#endif
+
 public:
 	void* allocate(size_t size ALLOC_PARAMS);
 	MemBlock* allocate2(size_t from, size_t& size ALLOC_PARAMS);
 
+	void enableThreadCaches();
+
 private:
 	virtual void memoryIsExhausted(void);
 	void* allocRaw(size_t length);
@@ -2028,6 +2136,7 @@ void MemoryPool::init()
 
 	static char mpBuffer[sizeof(MemoryPool) + ALLOC_ALIGNMENT];
 	defaultMemoryManager = new((void*)(IPTR) MEM_ALIGN((size_t)(IPTR) mpBuffer)) MemoryPool(MemPool::init());
+	defaultMemoryManager->enableThreadCaches();
 }
 
 // Should be last routine, called by InstanceControl,
@@ -2093,6 +2202,10 @@ void MemPool::initialize()
 	bigHunks = NULL;
 	pool_destroying = false;
 
+#ifdef USE_THREAD_CACHES
+	threadCaches = NULL;
+#endif
+
 #ifdef MEM_DEBUG
 	next = child = NULL;
 
@@ -2109,6 +2222,15 @@ MemPool::~MemPool(void)
 {
 	pool_destroying = true;
 
+#ifdef USE_THREAD_CACHES
+	// Cached blocks are released together with the extents holding them
+	if (threadCaches)
+	{
+		for (unsigned i = 0; i < BlockCache::CACHES_PER_POOL; i++)
+			threadCaches[i].~BlockCache();
+	}
+#endif
+
 	decrement_usage(used_memory.value());
 	decrement_mapping(mapped_memory.value());
 
@@ -2235,8 +2357,22 @@ void MemoryPool::setStatsGroup(MemoryStats& newStats) noexcept
 	pool->setStatsGroup(newStats);
 }
 
+void MemoryPool::enableThreadCaches()
+{
+	pool->enableThreadCaches();
+}
+
 MemBlock* MemPool::alloc(size_t from, size_t& length, bool flagRedirect)
 {
+#ifdef USE_THREAD_CACHES
+	if (threadCaches && !from)
+	{
+		MemBlock* const block = getCachedBlock(length);
+		if (block)
+			return block;
+	}
+#endif
+
 	MutexEnsureUnlock guard(mutex, "MemPool::alloc");
 	guard.enter();
 
@@ -2419,6 +2555,14 @@ void MemPool::releaseBlock(MemBlock* block, bool decrUsage) noexcept
 	--blocksActive;
 	const size_t length = block->getSize();
 
+#ifdef USE_THREAD_CACHES
+	if (threadCaches && decrUsage && !pool_destroying && !block->redirected() && cacheBlock(block))
+	{
+		decrement_usage(length);
+		return;
+	}
+#endif
+
 	MutexEnsureUnlock guard(mutex, "MemPool::releaseBlock");
 	guard.enter();
 
@@ -2464,6 +2608,121 @@ void MemPool::releaseBlock(MemBlock* block, bool decrUsage) noexcept
 	releaseRaw(pool_destroying, hunk, hunk->length, false);
 }
 
+#ifdef USE_THREAD_CACHES
+
+MemBlock* MemPool::getCachedBlock(size_t& length)
+{
+	size_t blockSize;
+	const unsigned slot = BlockCache::getSlot(length + LinkedList::MEM_OVERHEAD, blockSize);
+
+	if (slot == ~0u)
+		return NULL;
+
+	BlockCache& cache = threadCaches[BlockCache::getIndex()];
+	MutexLockGuard guard(cache.mutex, "MemPool::getCachedBlock");
+
+	MemBlock* const block = cache.blocks[slot];
+
+	if (!block)
+		return NULL;
+
+	cache.blocks[slot] = block->next;
+	--cache.counts[slot];
+	cache.bytes -= blockSize;
+
+	block->pool = this;
+	length = blockSize - LinkedList::MEM_OVERHEAD;
+
+	return block;
+}
+
+bool MemPool::cacheBlock(MemBlock* block) noexcept
+{
+	size_t blockSize;
+	const unsigned slot = BlockCache::getSlot(block->getSize(), blockSize);
+
+	if (slot == ~0u)
+		return false;
+
+	fb_assert(blockSize == block->getSize());
+
+	BlockCache& cache = threadCaches[BlockCache::getIndex()];
+	MemBlock* overflow = NULL;
+
+	{	// scope
+		MutexLockGuard guard(cache.mutex, "MemPool::cacheBlock");
+
+		if (cache.bytes + blockSize > BlockCache::MAX_BYTES)
+			return false;
+
+		block->next = cache.blocks[slot];
+		cache.blocks[slot] = block;
+		cache.bytes += blockSize;
+
+		if (++cache.counts[slot] > BlockCache::MAX_BLOCKS)
+		{
+			// Keep the recently freed half of blocks
+			MemBlock* last = block;
+
+			for (unsigned i = 1; i < BlockCache::MAX_BLOCKS / 2; i++)
+				last = last->next;
+
+			overflow = last->next;
+			last->next = NULL;
+			cache.bytes -= (cache.counts[slot] - BlockCache::MAX_BLOCKS / 2) * blockSize;
+			cache.counts[slot] = BlockCache::MAX_BLOCKS / 2;
+		}
+		else if (cache.bytes > (size_t) used_memory.value())
+		{
+			// The pool has shrunk, don't keep its memory idle
+			overflow = cache.takeAll();
+		}
+	}
+
+	if (overflow)
+		releaseBlocks(overflow);
+
+	return true;
+}
+
+// Return the list of cached blocks to the pool
+void MemPool::releaseBlocks(MemBlock* list) noexcept
+{
+	MutexLockGuard guard(mutex, "MemPool::releaseBlocks");
+
+	while (list)
+	{
+		MemBlock* const block = list;
+		list = list->next;
+
+		block->pool = this;
+
+		if (!smallObjects.deallocateBlock(block))
+		{
+			const bool medium = mediumObjects.deallocateBlock(block);
+			fb_assert(medium);
+		}
+	}
+}
+
+#endif // USE_THREAD_CACHES
+
+void MemPool::enableThreadCaches()
+{
+#ifdef USE_THREAD_CACHES
+	if (threadCaches)
+		return;
+
+	void* const memory = allocate(sizeof(BlockCache) * BlockCache::CACHES_PER_POOL ALLOC_ARGS);
+	BlockCache* const caches = static_cast<BlockCache*>(memory);
+
+	for (unsigned i = 0; i < BlockCache::CACHES_PER_POOL; i++)
+		new(&caches[i]) BlockCache;
+
+	threadCaches = caches;
+#endif
+}
+
 void MemPool::memoryIsExhausted(void)
 {
 	Firebird::BadAlloc::raise();
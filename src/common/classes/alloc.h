@@ -217,6 +217,10 @@ public:
 	// previously set group and added to new
 	void setStatsGroup(MemoryStats& stats) noexcept;
 
+	// Let threads reuse freed blocks without locking the pool.
+	// Worth for pools shared by many threads.
+	void enableThreadCaches();
+
 	// Initialize and finalize global memory pool
 	static void init();
 	static void cleanup();
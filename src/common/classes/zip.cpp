@@ -74,3 +74,77 @@ void ZLib::freeFunc(void*, void* address)
 }
 
 #endif // HAVE_ZLIB_H
+
+#ifdef HAVE_ZSTD_H
+
+using namespace Firebird;
+
+ZStd::ZStd(Firebird::MemoryPool&)
+{
+#ifdef WIN_NT
+	Firebird::PathName name("libzstd.dll");
+#else
+	Firebird::PathName name("libzstd." SHRLIB_EXT ".1");
+#endif
+	z.reset(ModuleLoader::fixAndLoadModule(status, name));
+	if (z)
+		symbols();
+}
+
+void ZStd::symbols()
+{
+#define FB_ZSYMB(A, B) z->findSymbol(status, STRINGIZE(B), A); if (!A) { z.reset(NULL); return; }
+	FB_ZSYMB(createCStream, ZSTD_createCStream)
+	FB_ZSYMB(freeCStream, ZSTD_freeCStream)
+	FB_ZSYMB(CCtx_setParameter, ZSTD_CCtx_setParameter)
+	FB_ZSYMB(compressStream2, ZSTD_compressStream2)
+	FB_ZSYMB(createDStream, ZSTD_createDStream)
+	FB_ZSYMB(freeDStream, ZSTD_freeDStream)
+	FB_ZSYMB(initDStream, ZSTD_initDStream)
+	FB_ZSYMB(decompressStream, ZSTD_decompressStream)
+	FB_ZSYMB(isError, ZSTD_isError)
+	FB_ZSYMB(getErrorName, ZSTD_getErrorName)
+	FB_ZSYMB(minCLevel, ZSTD_minCLevel)
+	FB_ZSYMB(maxCLevel, ZSTD_maxCLevel)
+#undef FB_ZSYMB
+
+	z->findSymbol(status, "ZSTD_createCStream_advanced", createCStream_advanced);
+	z->findSymbol(status, "ZSTD_createDStream_advanced", createDStream_advanced);
+}
+
+ZSTD_CStream* ZStd::createCStreamPool(MemoryPool& pool)
+{
+	if (!createCStream_advanced)
+		return createCStream();
+
+	const ZSTD_customMem mem = {allocFunc, freeFunc, &pool};
+	return createCStream_advanced(mem);
+}
+
+ZSTD_DStream* ZStd::createDStreamPool(MemoryPool& pool)
+{
+	if (!createDStream_advanced)
+		return createDStream();
+
+	const ZSTD_customMem mem = {allocFunc, freeFunc, &pool};
+	return createDStream_advanced(mem);
+}
+
+void* ZStd::allocFunc(void* pool, size_t size)
+{
+	try
+	{
+		return static_cast<MemoryPool*>(pool)->allocate(size ALLOC_ARGS);
+	}
+	catch (const Exception&)
+	{
+		return nullptr;
+	}
+}
+
+void ZStd::freeFunc(void*, void* address)
+{
+	MemoryPool::globalFree(address);
+}
+
+#endif // HAVE_ZSTD_H
@@ -62,4 +62,55 @@ namespace Firebird {
 }
 #endif // HAVE_ZLIB_H
 
+#ifdef HAVE_ZSTD_H
+#define ZSTD_STATIC_LINKING_ONLY	// ZSTD_customMem
+#include <zstd.h>
+
+#include "../common/classes/auto.h"
+#include "../common/os/mod_loader.h"
+
+namespace Firebird {
+	class ZStd
+	{
+	public:
+		explicit ZStd(Firebird::MemoryPool&);
+
+		ZSTD_CStream* (*createCStream)();
+		size_t (*freeCStream)(ZSTD_CStream* zcs);
+		size_t (*CCtx_setParameter)(ZSTD_CCtx* cctx, ZSTD_cParameter param, int value);
+		size_t (*compressStream2)(ZSTD_CCtx* cctx, ZSTD_outBuffer* output, ZSTD_inBuffer* input,
+			ZSTD_EndDirective endOp);
+		ZSTD_DStream* (*createDStream)();
+		size_t (*freeDStream)(ZSTD_DStream* zds);
+		size_t (*initDStream)(ZSTD_DStream* zds);
+		size_t (*decompressStream)(ZSTD_DStream* zds, ZSTD_outBuffer* output, ZSTD_inBuffer* input);
+		unsigned (*isError)(size_t code);
+		const char* (*getErrorName)(size_t code);
+		int (*minCLevel)();
+		int (*maxCLevel)();
+
+		// Optional, missing in old library versions
+		ZSTD_CStream* (*createCStream_advanced)(ZSTD_customMem customMem);
+		ZSTD_DStream* (*createDStream_advanced)(ZSTD_customMem customMem);
+
+		operator bool() { return z.hasData(); }
+		bool operator!() { return !z.hasData(); }
+
+		// Streams allocating their memory from the given pool when possible
+		ZSTD_CStream* createCStreamPool(MemoryPool& pool);
+		ZSTD_DStream* createDStreamPool(MemoryPool& pool);
+
+		static void* allocFunc(void* pool, size_t size);
+		static void freeFunc(void*, void* address);
+
+		ISC_STATUS_ARRAY status;
+
+	private:
+		AutoPtr<ModuleLoader::Module> z;
+
+		void symbols();
+	};
+}
+#endif // HAVE_ZSTD_H
+
 #endif // COMMON_ZIP_H
@@ -410,6 +410,19 @@ void Config::checkValues()
 	checkIntForHiBound(KEY_TIP_CACHE_BLOCK_SIZE, MAX_ULONG, true);
 
 	checkIntForLoBound(KEY_INLINE_SORT_THRESHOLD, 0, true);
+
+	checkIntForLoBound(KEY_MAX_WORKER_THREADS, 0, true);
+
+	checkIntForLoBound(KEY_CLIENT_FETCH_BUFFER, 65536, true);
+
+	checkIntForLoBound(KEY_MAX_INLINE_BLOB_SIZE, 0, true);
+	checkIntForHiBound(KEY_MAX_INLINE_BLOB_SIZE, MAX_USHORT, true);
+
+	checkIntForLoBound(KEY_STATEMENT_CACHE_SIZE, 0, true);
+	checkIntForHiBound(KEY_STATEMENT_CACHE_SIZE, MAX_USHORT, true);
+
+	checkIntForLoBound(KEY_CRYPT_THREADS, 1, true);
+	checkIntForHiBound(KEY_CRYPT_THREADS, 64, false);
 }
 
 
@@ -189,6 +189,13 @@ enum ConfigKey
 	KEY_USE_FILESYSTEM_CACHE,
 	KEY_INLINE_SORT_THRESHOLD,
 	KEY_TEMP_PAGESPACE_DIR,
+	KEY_MAX_WORKER_THREADS,
+	KEY_CLIENT_FETCH_BUFFER,
+	KEY_WIRE_COMPRESSION_METHOD,
+	KEY_WIRE_COMPRESSION_LEVEL,
+	KEY_MAX_INLINE_BLOB_SIZE,
+	KEY_STATEMENT_CACHE_SIZE,
+	KEY_CRYPT_THREADS,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -304,7 +311,14 @@ constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_STRING,	"DataTypeCompatibility",	false,	nullptr},
 	{TYPE_BOOLEAN,	"UseFileSystemCache",		false,	true},
 	{TYPE_INTEGER,	"InlineSortThreshold",		false,	1000},		// bytes
-	{TYPE_STRING,	"TempTableDirectory",		false,	""}
+	{TYPE_STRING,	"TempTableDirectory",		false,	""},
+	{TYPE_INTEGER,	"MaxWorkerThreads",			true,	0},			// 0 - unlimited
+	{TYPE_INTEGER,	"ClientFetchBuffer",		false,	1048576},	// bytes
+	{TYPE_STRING,	"WireCompressionMethod",	false,	"zlib"},
+	{TYPE_INTEGER,	"WireCompressionLevel",		false,	0},			// 0 - default level of the method
+	{TYPE_INTEGER,	"MaxInlineBlobSize",		false,	0},			// bytes, 0 - disabled
+	{TYPE_INTEGER,	"StatementCacheSize",		false,	100},		// statements per attachment, 0 - disabled
+	{TYPE_INTEGER,	"CryptThreads",				false,	1}
 };
 
 
@@ -629,6 +643,20 @@ public:
 	CONFIG_GET_PER_DB_KEY(ULONG, getInlineSortThreshold, KEY_INLINE_SORT_THRESHOLD, getInt);
 
 	CONFIG_GET_PER_DB_STR(getTempPageSpaceDirectory, KEY_TEMP_PAGESPACE_DIR);
+
+	CONFIG_GET_GLOBAL_INT(getMaxWorkerThreads, KEY_MAX_WORKER_THREADS);
+
+	CONFIG_GET_PER_DB_KEY(unsigned int, getClientFetchBuffer, KEY_CLIENT_FETCH_BUFFER, getInt);
+
+	CONFIG_GET_PER_DB_STR(getWireCompressionMethod, KEY_WIRE_COMPRESSION_METHOD);
+
+	CONFIG_GET_PER_DB_INT(getWireCompressionLevel, KEY_WIRE_COMPRESSION_LEVEL);
+
+	CONFIG_GET_PER_DB_KEY(unsigned int, getMaxInlineBlobSize, KEY_MAX_INLINE_BLOB_SIZE, getInt);
+
+	CONFIG_GET_PER_DB_KEY(unsigned int, getStatementCacheSize, KEY_STATEMENT_CACHE_SIZE, getInt);
+
+	CONFIG_GET_PER_DB_KEY(unsigned int, getCryptThreads, KEY_CRYPT_THREADS, getInt);
 };
 
 // Implementation of interface to access master configuration file
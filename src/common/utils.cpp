@@ -1434,6 +1434,7 @@ bool isRunningCheck(const UCHAR* items, unsigned int length)
 		case isc_info_svc_get_env_lock:
 		case isc_info_svc_get_env_msg:
 		case isc_info_svc_get_licensed_users:
+		case isc_info_svc_wire_stats:
 			if (state == S_RUN)
 			{
 				Firebird::Arg::Gds(isc_mixed_info).raise();
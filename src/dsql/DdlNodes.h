@@ -1823,6 +1823,30 @@ public:
 };
 
 
+class SetTableStatisticsNode : public DdlNode
+{
+public:
+	SetTableStatisticsNode(MemoryPool& p, const MetaName& aName)
+		: DdlNode(p),
+		  name(p, aName)
+	{
+	}
+
+public:
+	virtual Firebird::string internalPrint(NodePrinter& printer) const;
+	virtual void checkPermission(thread_db* tdbb, jrd_tra* transaction);
+	virtual void execute(thread_db* tdbb, DsqlCompilerScratch* dsqlScratch, jrd_tra* transaction);
+
+protected:
+	virtual void putErrorPrefix(Firebird::Arg::StatusVector& statusVector)
+	{
+		statusVector << Firebird::Arg::Gds(isc_dsql_alter_table_failed) << name;
+	}
+
+public:
+	MetaName name;
+};
+
 class DropIndexNode : public DdlNode
 {
 public:
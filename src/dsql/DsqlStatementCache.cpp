@@ -0,0 +1,234 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ________________________________
+ */
+
+#include "firebird.h"
+#include "../dsql/DsqlStatementCache.h"
+#include "../dsql/dsql.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/err_proto.h"
+#include "../jrd/lck.h"
+#include "../jrd/lck_proto.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+static void releaseRequest(thread_db* tdbb, dsql_req* request)
+{
+	request->req_request->req_flags &= ~req_cached;
+
+	Jrd::ContextPoolHolder context(tdbb, &request->getPool());
+	dsql_req::destroy(tdbb, request, true);
+}
+
+
+DsqlStatementCache::DsqlStatementCache(MemoryPool& p, dsql_dbb* database)
+	: pool(p),
+	  dbb(database),
+	  lock(NULL),
+	  purgeLock(NULL),
+	  generation(0),
+	  requests(p),
+	  hits(0),
+	  misses(0)
+{
+}
+
+bool DsqlStatementCache::isEnabled() const
+{
+	return dbb->dbb_attachment->att_database->dbb_config->getStatementCacheSize() != 0;
+}
+
+// Build the cache key of a statement. Metadata changes purge the cache,
+// so the schema version does not need to be a part of the key.
+void DsqlStatementCache::makeKey(string& key, const TEXT* text, ULONG length, USHORT dialect,
+	USHORT charSet)
+{
+	key.assign(1, (char) dialect);
+	key.append(1, (char) charSet);
+	key.append(text, length);
+}
+
+// Return the current generation of metadata, statements compiled for it may be cached.
+SINT64 DsqlStatementCache::getGeneration(thread_db* tdbb)
+{
+	if (!lock)
+		lock = FB_NEW_RPT(pool, 0) Lock(tdbb, 0, LCK_dsql_statement_cache);
+
+	// Shared read is compatible with all locks taken for the cache, so it's granted at once
+	if (lock->lck_logical == LCK_none && !LCK_lock(tdbb, lock, LCK_SR, LCK_WAIT))
+		ERR_punt();
+
+	return LCK_read_data(tdbb, lock);
+}
+
+// Take the statement prepared earlier for the given key out of the cache.
+dsql_req* DsqlStatementCache::get(thread_db* tdbb, const string& key)
+{
+	if (requests.hasData() && getGeneration(tdbb) != generation)
+		release(tdbb);
+
+	for (FB_SIZE_T i = requests.getCount(); i--;)
+	{
+		dsql_req* const request = requests[i];
+
+		if (request->req_cache_key == key)
+		{
+			requests.remove(i);
+			request->req_request->req_flags &= ~req_cached;
+			++hits;
+			return request;
+		}
+	}
+
+	++misses;
+	return NULL;
+}
+
+// Keep the statement released by the application for later reuse.
+// Returns false if the statement should be destroyed by the caller.
+bool DsqlStatementCache::put(thread_db* tdbb, dsql_req* request)
+{
+	const unsigned maxCount = dbb->dbb_attachment->att_database->dbb_config->getStatementCacheSize();
+	const DsqlCompiledStatement* const statement = request->getStatement();
+
+	if (!maxCount || request->req_cache_key.isEmpty() || !request->req_request ||
+		(request->req_request->req_flags & req_active) ||
+		request->req_cursor || request->req_batch || request->cursors.hasData() ||
+		statement->getParentRequest() ||
+		(statement->getFlags() & DsqlCompiledStatement::FLAG_ORPHAN))
+	{
+		return false;
+	}
+
+	// Metadata was changed after the statement was compiled
+	const SINT64 current = getGeneration(tdbb);
+
+	if (request->req_cache_generation != current)
+		return false;
+
+	if (generation != current)
+	{
+		release(tdbb);
+		generation = current;
+	}
+
+	for (dsql_req** iter = requests.begin(); iter != requests.end(); ++iter)
+	{
+		if ((*iter)->req_cache_key == request->req_cache_key)
+			return false;
+	}
+
+	if (!purgeLock)
+	{
+		purgeLock = FB_NEW_RPT(pool, 0)
+			Lock(tdbb, 0, LCK_dsql_statement_purge, this, blockingAst);
+	}
+
+	if (purgeLock->lck_logical == LCK_none)
+	{
+		// Metadata is being changed right now, don't keep anything compiled for the old one
+
+		ThreadStatusGuard tempStatus(tdbb);
+
+		if (!LCK_lock(tdbb, purgeLock, LCK_SR, LCK_NO_WAIT))
+			return false;
+	}
+
+	request->reset(tdbb);
+	request->req_request->req_flags |= req_cached;
+
+	while (requests.getCount() >= maxCount)
+	{
+		dsql_req* const oldest = requests[0];
+		requests.remove((FB_SIZE_T) 0);
+		releaseRequest(tdbb, oldest);
+	}
+
+	requests.add(request);
+	return true;
+}
+
+// Release all cached statements of the attachment.
+void DsqlStatementCache::release(thread_db* tdbb)
+{
+	while (requests.hasData())
+		releaseRequest(tdbb, requests.pop());
+
+	if (purgeLock)
+		LCK_release(tdbb, purgeLock);
+}
+
+// Release all cached statements of the attachment and the lock.
+void DsqlStatementCache::purge(thread_db* tdbb)
+{
+	release(tdbb);
+
+	if (lock)
+		LCK_release(tdbb, lock);
+}
+
+// Make statements compiled by all attachments for the current metadata obsolete
+// and release the cached ones, so they don't keep the existence locks.
+void DsqlStatementCache::invalidate(thread_db* tdbb)
+{
+	Jrd::Attachment* const attachment = tdbb->getAttachment();
+
+	if (attachment->att_dsql_instance)
+		attachment->att_dsql_instance->dbb_statement_cache.release(tdbb);
+
+	// Protected write is compatible with the shared locks of the caches,
+	// so only concurrent invalidations are waited for
+
+	Lock generationLock(tdbb, 0, LCK_dsql_statement_cache);
+
+	if (!LCK_lock(tdbb, &generationLock, LCK_PW, LCK_WAIT))
+		ERR_punt();
+
+	LCK_write_data(tdbb, &generationLock, LCK_read_data(tdbb, &generationLock) + 1);
+	LCK_release(tdbb, &generationLock);
+
+	// Statements cached for the old generation are released by the blocking ASTs
+
+	Lock tempLock(tdbb, 0, LCK_dsql_statement_purge);
+
+	if (!LCK_lock(tdbb, &tempLock, LCK_EX, LCK_WAIT))
+		ERR_punt();
+
+	LCK_release(tdbb, &tempLock);
+}
+
+int DsqlStatementCache::blockingAst(void* astObject)
+{
+	DsqlStatementCache* const cache = static_cast<DsqlStatementCache*>(astObject);
+
+	try
+	{
+		Database* const dbb = cache->purgeLock->lck_dbb;
+
+		AsyncContextHolder tdbb(dbb, FB_FUNCTION, cache->purgeLock);
+
+		cache->release(tdbb);
+	}
+	catch (const Exception&)
+	{} // no-op
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ________________________________
+ */
+
+#ifndef DSQL_STATEMENT_CACHE_H
+#define DSQL_STATEMENT_CACHE_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/fb_string.h"
+
+namespace Jrd {
+
+class dsql_dbb;
+class dsql_req;
+class thread_db;
+class Lock;
+
+// Statements released by the application but kept compiled, so preparing
+// the same SQL text once more in the attachment costs just a lookup.
+//
+// Metadata changes affecting compiled statements increment the generation
+// kept as the data of a database-wide lock. Every cache holds this lock in
+// shared mode to keep the data alive, while the generation is incremented
+// under the protected write lock. Statements compiled for an older generation
+// are never put into the cache.
+//
+// Cached statements hold existence locks, so before the metadata is changed
+// they are released in all attachments. Not empty cache holds the purge lock
+// in shared mode and the invalidation takes it exclusively. Blocking AST of
+// the purge lock releases the statements under the attachment mutex, thus
+// the owning attachment is not inside an API call at this moment or waits
+// for a lock with no references into the cache kept.
+
+class DsqlStatementCache
+{
+public:
+	DsqlStatementCache(MemoryPool& pool, dsql_dbb* database);
+
+	bool isEnabled() const;
+
+	static void makeKey(Firebird::string& key, const TEXT* text, ULONG length, USHORT dialect,
+		USHORT charSet);
+
+	SINT64 getGeneration(thread_db* tdbb);
+
+	dsql_req* get(thread_db* tdbb, const Firebird::string& key);
+	bool put(thread_db* tdbb, dsql_req* request);
+	void purge(thread_db* tdbb);
+
+	static void invalidate(thread_db* tdbb);
+	static int blockingAst(void* astObject);
+
+	FB_UINT64 getHits() const
+	{
+		return hits;
+	}
+
+	FB_UINT64 getMisses() const
+	{
+		return misses;
+	}
+
+private:
+	void release(thread_db* tdbb);
+
+	MemoryPool& pool;
+	dsql_dbb* const dbb;
+	Lock* lock;								// keeps the generation
+	Lock* purgeLock;						// held while the cache is not empty
+	SINT64 generation;						// of the cached statements
+	Firebird::Array<dsql_req*> requests;	// least recently released go first
+	FB_UINT64 hits;
+	FB_UINT64 misses;
+};
+
+} // namespace Jrd
+
+#endif // DSQL_STATEMENT_CACHE_H
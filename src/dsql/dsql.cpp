@@ -344,8 +344,10 @@ void DSQL_free_statement(thread_db* tdbb, dsql_req* request, USHORT option)
 
 	if (option & DSQL_drop)
 	{
-		// Release everything associated with the request
-		dsql_req::destroy(tdbb, request, true);
+		// Keep the request compiled for the next prepare of the same statement,
+		// otherwise release everything associated with it
+		if (!request->req_dbb->dbb_statement_cache.put(tdbb, request))
+			dsql_req::destroy(tdbb, request, true);
 	}
 	/*
 	else if (option & DSQL_unprepare)
@@ -371,6 +373,29 @@ void DSQL_free_statement(thread_db* tdbb, dsql_req* request, USHORT option)
 }
 
 
+/**
+
+ 	DSQL_purge_statement_cache
+
+    @brief	Release the statements kept compiled by the attachment
+	and, if asked for, make obsolete the ones of all other attachments.
+
+
+    @param tdbb
+    @param broadcast
+
+ **/
+void DSQL_purge_statement_cache(thread_db* tdbb, bool broadcast)
+{
+	SET_TDBB(tdbb);
+
+	if (broadcast)
+		DsqlStatementCache::invalidate(tdbb);
+	else if (tdbb->getAttachment()->att_dsql_instance)
+		tdbb->getAttachment()->att_dsql_instance->dbb_statement_cache.purge(tdbb);
+}
+
+
 /**
 
  	DSQL_prepare
@@ -1087,6 +1112,10 @@ void DsqlSessionManagementRequest::execute(thread_db* tdbb, jrd_tra** traHandle,
 	TraceDSQLExecute trace(req_dbb->dbb_attachment, this);
 	node->execute(tdbb, this, traHandle);
 	trace.finish(false, ITracePlugin::RESULT_SUCCESS);
+
+	// Role, data type bindings and other session settings are taken
+	// into account when statements are compiled
+	req_dbb->dbb_statement_cache.purge(tdbb);
 }
 
 
@@ -1479,8 +1508,65 @@ static void checkD(IStatus* st)
 static dsql_req* prepareRequest(thread_db* tdbb, dsql_dbb* database, jrd_tra* transaction,
 	ULONG textLength, const TEXT* text, USHORT clientDialect, bool isInternalRequest)
 {
-	return prepareStatement(tdbb, database, transaction, textLength, text, clientDialect,
-		isInternalRequest);
+	DsqlStatementCache& cache = database->dbb_statement_cache;
+	Jrd::Attachment* const attachment = database->dbb_attachment;
+
+	// Statements prepared by a transaction which changed metadata may see its
+	// uncommitted changes, don't share them with other transactions
+
+	const bool cacheable = !isInternalRequest && text && cache.isEnabled() &&
+		!(transaction && (transaction->tra_flags & TRA_deferred_meta));
+
+	string cacheKey;
+
+	if (cacheable)
+	{
+		if (textLength == 0)
+			textLength = static_cast<ULONG>(strlen(text));
+
+		DsqlStatementCache::makeKey(cacheKey, text, textLength, clientDialect,
+			attachment->att_charset);
+
+		dsql_req* const request = cache.get(tdbb, cacheKey);
+
+		if (request)
+		{
+			TraceDSQLPrepare trace(attachment, transaction, textLength, text);
+
+			request->req_transaction = transaction ? transaction : attachment->getSysTransaction();
+			request->req_traced = true;
+			trace.setStatement(request);
+			trace.prepare(ITracePlugin::RESULT_SUCCESS);
+
+			return request;
+		}
+	}
+
+	// Metadata changed while the statement is compiled makes it obsolete
+	const SINT64 generation = cacheable ? cache.getGeneration(tdbb) : 0;
+
+	dsql_req* const request = prepareStatement(tdbb, database, transaction, textLength, text,
+		clientDialect, isInternalRequest);
+
+	if (cacheable)
+	{
+		switch (request->getStatement()->getType())
+		{
+			case DsqlCompiledStatement::TYPE_SELECT:
+			case DsqlCompiledStatement::TYPE_SELECT_UPD:
+			case DsqlCompiledStatement::TYPE_SELECT_BLOCK:
+			case DsqlCompiledStatement::TYPE_INSERT:
+			case DsqlCompiledStatement::TYPE_UPDATE:
+			case DsqlCompiledStatement::TYPE_DELETE:
+			case DsqlCompiledStatement::TYPE_EXEC_PROCEDURE:
+			case DsqlCompiledStatement::TYPE_EXEC_BLOCK:
+				request->req_cache_key = cacheKey;
+				request->req_cache_generation = generation;
+				break;
+		}
+	}
+
+	return request;
 }
 
 
@@ -1762,6 +1848,8 @@ dsql_req::dsql_req(MemoryPool& pool)
 	  req_batch(NULL),
 	  req_user_descs(req_pool),
 	  req_traced(false),
+	  req_cache_key(req_pool),
+	  req_cache_generation(0),
 	  req_timeout(0)
 {
 }
@@ -1872,6 +1960,48 @@ TimeoutTimer* dsql_req::setupTimer(thread_db* tdbb)
 	return req_timer;
 }
 
+// Forget the state left by the application which released the request.
+void dsql_req::reset(thread_db* /*tdbb*/)
+{
+	if (req_timer)
+	{
+		req_timer->stop();
+		req_timer = NULL;
+		req_request->req_timer = NULL;
+	}
+
+	req_timeout = 0;
+
+	Jrd::Attachment* att = req_dbb->dbb_attachment;
+	if (req_traced && TraceManager::need_dsql_free(att))
+	{
+		TraceSQLStatementImpl stmt(this, NULL);
+		TraceManager::event_dsql_free(att, &stmt, DSQL_drop);
+	}
+	req_traced = false;
+
+	if (req_cursor_name.hasData())
+	{
+		req_dbb->dbb_cursors.remove(req_cursor_name);
+		req_cursor_name = "";
+	}
+
+	req_transaction = NULL;
+	req_user_descs.clear();
+	req_fetch_baseline = NULL;
+	req_fetch_elapsed = 0;
+	req_fetch_rowcount = 0;
+}
+
+void DsqlDmlRequest::reset(thread_db* tdbb)
+{
+	dsql_req::reset(tdbb);
+
+	delayedFormat = NULL;
+	needDelayedFormat = false;
+	firstRowFetched = false;
+}
+
 // Release a dynamic request.
 void dsql_req::destroy(thread_db* tdbb, dsql_req* request, bool drop)
 {
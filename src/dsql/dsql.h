@@ -48,6 +48,7 @@
 #include "../dsql/BlrDebugWriter.h"
 #include "../dsql/ddl_proto.h"
 #include "../dsql/DsqlCursor.h"
+#include "../dsql/DsqlStatementCache.h"
 
 
 #ifdef DEV_BUILD
@@ -140,6 +141,7 @@ public:
 	Attachment*		dbb_attachment;
 	MetaName dbb_dfl_charset;
 	bool			dbb_no_charset;
+	DsqlStatementCache dbb_statement_cache;	// statements released by the application
 
 	explicit dsql_dbb(MemoryPool& p)
 		: dbb_relations(p),
@@ -150,7 +152,8 @@ public:
 		  dbb_charsets_by_id(p),
 		  dbb_cursors(p),
 		  dbb_pool(p),
-		  dbb_dfl_charset(p)
+		  dbb_dfl_charset(p),
+		  dbb_statement_cache(p, this)
 	{}
 
 	~dsql_dbb();
@@ -610,6 +613,9 @@ public:
 	void mapInOut(Jrd::thread_db* tdbb, bool toExternal, const dsql_msg* message, Firebird::IMessageMetadata* meta,
 		UCHAR* dsql_msg_buf, const UCHAR* in_dsql_msg_buf = NULL);
 
+	// Forget the execution state, so the request may be taken from the statement cache
+	virtual void reset(thread_db* tdbb);
+
 	static void destroy(thread_db* tdbb, dsql_req* request, bool drop);
 
 private:
@@ -634,6 +640,8 @@ public:
 	SINT64 req_fetch_elapsed;		// Number of clock ticks spent while fetching rows for this request since we reported it last time
 	SINT64 req_fetch_rowcount;		// Total number of rows returned by this request
 	bool req_traced;				// request is traced via TraceAPI
+	Firebird::string req_cache_key;	// key in the statement cache, if request may be cached
+	SINT64 req_cache_generation;	// of metadata the request is compiled for
 
 protected:
 	unsigned int req_timeout;					// query timeout in milliseconds, set by the user
@@ -673,6 +681,8 @@ public:
 
 	virtual void setDelayedFormat(thread_db* tdbb, Firebird::IMessageMetadata* metadata);
 
+	virtual void reset(thread_db* tdbb);
+
 private:
 	// True, if request could be restarted
 	bool needRestarts();
@@ -43,6 +43,7 @@ void DSQL_free_statement(Jrd::thread_db*, Jrd::dsql_req*, USHORT);
 Jrd::DsqlCursor* DSQL_open(Jrd::thread_db*, Jrd::jrd_tra**, Jrd::dsql_req*,
 	  	  	 	  	  	   Firebird::IMessageMetadata*, const UCHAR*,
 	  	  	 	  	  	   Firebird::IMessageMetadata*, ULONG);
+void DSQL_purge_statement_cache(Jrd::thread_db*, bool);
 Jrd::dsql_req* DSQL_prepare(Jrd::thread_db*, Jrd::Attachment*, Jrd::jrd_tra*, ULONG, const TEXT*,
 							USHORT, Firebird::Array<UCHAR>*, Firebird::Array<UCHAR>*, bool);
 void DSQL_sql_info(Jrd::thread_db*, Jrd::dsql_req*,
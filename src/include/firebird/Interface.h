@@ -84,6 +84,13 @@ struct PerformanceInfo
 		WRITES
 	};
 
+	// Index of the peak size (in bytes) of the request arena in pin_counters,
+	// must correspond to RuntimeStatistics::ARENA_HIGH_WATER
+	enum MemoryCounters
+	{
+		ARENA_HIGH_WATER = 19
+	};
+
 	ISC_INT64 pin_time;				// Total operation time in milliseconds
 	ISC_INT64* pin_counters;		// Pointer to allow easy addition of new counters
 
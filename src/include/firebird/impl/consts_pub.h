@@ -382,6 +382,7 @@
 #define isc_info_svc_get_users			68	/* Returns the user information from isc_action_svc_display_users */
 #define isc_info_svc_auth_block			69	/* Sets authentication block for service query() call */
 #define isc_info_svc_stdin				78	/* Returns maximum size of data, needed as stdin for service */
+#define isc_info_svc_wire_stats		200	/* Retrieves request queue statistics of the network server, admins only */
 
 
 /******************************************************
@@ -421,6 +422,8 @@
 #define isc_spb_bkp_keyname				 17
 #define isc_spb_bkp_crypt				 18
 #define isc_spb_bkp_include_data         19
+#define isc_spb_bkp_parallel_workers     21
+#define isc_spb_bkp_zstd_level           22
 #define isc_spb_bkp_ignore_checksums     0x01
 #define isc_spb_bkp_ignore_limbo         0x02
 #define isc_spb_bkp_metadata_only        0x04
@@ -538,6 +541,7 @@
 
 #define isc_spb_res_skip_data			isc_spb_bkp_skip_data
 #define isc_spb_res_include_data		isc_spb_bkp_include_data
+#define isc_spb_res_parallel_workers	isc_spb_bkp_parallel_workers
 #define isc_spb_res_buffers				9
 #define isc_spb_res_page_size			10
 #define isc_spb_res_length				11
@@ -590,6 +594,19 @@
 #define isc_spb_num_att			5
 #define isc_spb_num_db			6
 
+/********************************************
+ * Parameters for isc_info_svc_wire_stats   *
+ ********************************************/
+
+/* All values are 8-byte little-endian integers, times are in microseconds */
+
+#define isc_spb_wire_requests		201	/* requests served since server start */
+#define isc_spb_wire_queue_time		202	/* total time requests waited in queue */
+#define isc_spb_wire_service_time	203	/* total time requests were executed */
+#define isc_spb_wire_pending		204	/* requests waiting in queue */
+#define isc_spb_wire_active			205	/* requests being executed */
+#define isc_spb_wire_peak_workers	206	/* peak number of worker threads */
+
 /*****************************************
  * Parameters for isc_info_svc_db_stats  *
  *****************************************/
@@ -620,6 +637,9 @@
 #define isc_spb_nbk_file			6
 #define isc_spb_nbk_direct			7
 #define isc_spb_nbk_guid			8
+/* 9 - 11 are reserved for isc_spb_nbk_clean_history, keep_days and keep_rows */
+#define isc_spb_nbk_parallel_workers	64
+#define isc_spb_nbk_zstd_level		65
 #define isc_spb_nbk_no_triggers		0x01
 #define isc_spb_nbk_inplace			0x02
 #define isc_spb_nbk_sequence		0x04
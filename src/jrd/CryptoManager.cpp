@@ -275,6 +275,7 @@ namespace Jrd {
 		  checkFactory(NULL),
 		  dbb(*tdbb->getDatabase()),
 		  cryptAtt(NULL),
+		  batchEnd(0),
 		  slowIO(0),
 		  crypt(false),
 		  process(false),
@@ -900,6 +901,139 @@ namespace Jrd {
 		}
 	}
 
+	// Crypt thread may use a number of workers, each of them has own attachment.
+	// Workers wait for the crypt thread to start a batch of pages, take pages
+	// of that batch one by one and report when there are no pages left.
+
+	class CryptoManager::CryptWorker
+	{
+	public:
+		explicit CryptWorker(CryptoManager* cm)
+			: cryptoManager(cm),
+			  handle(0),
+			  attached(false),
+			  stop(false)
+		{ }
+
+		void start()
+		{
+			Thread::start(workerThread, (THREAD_ENTRY_PARAM) this, THREAD_medium, &handle);
+		}
+
+		void process()
+		{
+			startSem.release();
+		}
+
+		void finish()
+		{
+			stop = true;
+			startSem.release();
+			Thread::waitForCompletion(handle);
+		}
+
+		bool isAttached() const
+		{
+			return attached;
+		}
+
+		// Raise an error met by worker
+		void check()
+		{
+			if (status->getState() & IStatus::STATE_ERRORS)
+				status_exception::raise(&status);
+		}
+
+		void logError()
+		{
+			iscLogStatus("Crypt thread worker:", &status);
+		}
+
+	private:
+		static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM p)
+		{
+			((CryptWorker*) p)->run();
+			return 0;
+		}
+
+		void run();
+
+		CryptoManager* const cryptoManager;
+		Thread::Handle handle;
+		Semaphore startSem;
+		FbLocalStatus status;
+		bool attached;
+		volatile bool stop;
+	};
+
+	void CryptoManager::CryptWorker::run()
+	{
+		Database& dbb = cryptoManager->dbb;
+
+		try
+		{
+			ClumpletWriter writer(ClumpletReader::dpbList, MAX_DPB_SIZE);
+			writer.insertString(isc_dpb_user_name, DBA_USER_NAME);
+			writer.insertByte(isc_dpb_no_db_triggers, TRUE);
+
+			// Avoid races with release_attachment() in jrd.cpp
+			XThreadEnsureUnlock releaseGuard(dbb.dbb_thread_mutex, FB_FUNCTION);
+			releaseGuard.enter();
+
+			AutoPlugin<JProvider> jInstance(JProvider::getInstance());
+			jInstance->setDbCryptCallback(&status, dbb.dbb_callback);
+			Firebird::check(&status);
+
+			RefPtr<JAttachment> jAtt(REF_NO_INCR, jInstance->attachDatabase(&status,
+				dbb.dbb_database_name.c_str(), writer.getBufferLength(), writer.getBuffer()));
+			Firebird::check(&status);
+
+			MutexLockGuard attGuard(*(jAtt->getStable()->getMutex()), FB_FUNCTION);
+			Attachment* att = jAtt->getHandle();
+			if (!att)
+				Arg::Gds(isc_att_shutdown).raise();
+			att->att_flags |= ATT_from_thread;
+			releaseGuard.leave();
+
+			ThreadContextHolder tdbb(att->att_database, att, &status);
+			tdbb->markAsSweeper();
+
+			DatabaseContextHolder dbHolder(tdbb);
+
+			attached = true;
+			cryptoManager->batchDone.release();
+
+			while (true)
+			{
+				{	// scope
+					EngineCheckout checkout(tdbb, FB_FUNCTION);
+					startSem.enter();
+				}
+
+				if (stop)
+					break;
+
+				try
+				{
+					cryptoManager->cryptPages(tdbb);
+				}
+				catch (const Exception& ex)
+				{
+					ex.stuffException(&status);
+				}
+
+				cryptoManager->batchDone.release();
+			}
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(&status);
+		}
+
+		if (!attached)
+			cryptoManager->batchDone.release();
+	}
+
 	void CryptoManager::cryptThread()
 	{
 		FbLocalStatus status_vector;
@@ -1004,6 +1138,72 @@ namespace Jrd {
 					AutoSetRestore<Attachment*> attSet(&cryptAtt, att);
 					ULONG lastPage = getLastPage(tdbb);
 
+					class WorkersHolder
+					{
+					public:
+						WorkersHolder(thread_db* t, CryptoManager* cm)
+							: workers(cm->getPool()), tdbb(t), cryptoManager(cm)
+						{ }
+
+						~WorkersHolder()
+						{
+							if (workers.isEmpty())
+								return;
+
+							// make workers leave current batch if any
+							cryptoManager->nextPage.setValue(cryptoManager->batchEnd);
+
+							EngineCheckout checkout(tdbb, FB_FUNCTION);
+							for (CryptWorker** w = workers.begin(); w != workers.end(); ++w)
+							{
+								(*w)->finish();
+								delete *w;
+							}
+						}
+
+						HalfStaticArray<CryptWorker*, 8> workers;
+
+					private:
+						thread_db* tdbb;
+						CryptoManager* cryptoManager;
+					};
+					WorkersHolder holder(tdbb, this);
+					HalfStaticArray<CryptWorker*, 8>& workers = holder.workers;
+
+					// start workers and wait for them to attach
+					const unsigned threads = dbb.dbb_config->getCryptThreads();
+					for (unsigned n = 1; n < threads; ++n)
+					{
+						CryptWorker* worker = FB_NEW_POOL(getPool()) CryptWorker(this);
+						workers.add(worker);
+						worker->start();
+					}
+
+					if (workers.hasData())
+					{
+						{	// scope
+							EngineCheckout checkout(tdbb, FB_FUNCTION);
+							for (unsigned n = 0; n < workers.getCount(); ++n)
+								batchDone.enter();
+						}
+
+						// continue without workers failed to attach
+						for (FB_SIZE_T n = 0; n < workers.getCount(); )
+						{
+							CryptWorker* worker = workers[n];
+							if (worker->isAttached())
+							{
+								++n;
+								continue;
+							}
+
+							worker->logError();
+							workers.remove(n);
+							worker->finish();
+							delete worker;
+						}
+					}
+
 					do
 					{
 						// Check is there some job to do
@@ -1015,36 +1215,33 @@ namespace Jrd {
 								break;
 							}
 
-							// scheduling
-							JRD_reschedule(tdbb);
+							// Batch ends when currentPage should be saved into DB header
+							batchEnd = MIN(lastPage, (currentPage | 0x3FF) + 1);
+							nextPage.setValue(currentPage);
 
-							// nbackup state check
-							int bak_state = Ods::hdr_nbak_unknown;
-							{	// scope
-								BackupManager::StateReadGuard stateGuard(tdbb);
-								bak_state = dbb.dbb_backup_manager->getState();
-							}
+							for (CryptWorker** w = workers.begin(); w != workers.end(); ++w)
+								(*w)->process();
 
-							if (bak_state != Ods::hdr_nbak_normal)
+							cryptPages(tdbb);
+
+							if (workers.hasData())
 							{
 								EngineCheckout checkout(tdbb, FB_FUNCTION);
-								Thread::sleep(10);
-								continue;
+								for (unsigned n = 0; n < workers.getCount(); ++n)
+									batchDone.enter();
 							}
 
-							// writing page to disk will change it's crypt status in usual way
-							WIN window(DB_PAGE_SPACE, currentPage);
-							Ods::pag* page = CCH_FETCH(tdbb, &window, LCK_write, pag_undefined);
-							if (page && page->pag_type <= pag_max &&
-								(bool(page->pag_flags & Ods::crypted_page) != crypt) &&
-								Ods::pag_crypt_page[page->pag_type])
+							for (CryptWorker** w = workers.begin(); w != workers.end(); ++w)
+								(*w)->check();
+
+							// batch may be incomplete
+							if (down())
 							{
-								CCH_MARK_MUST_WRITE(tdbb, &window);
+								break;
 							}
-							CCH_RELEASE_TAIL(tdbb, &window);
 
 							// sometimes save currentPage into DB header
-							++currentPage;
+							currentPage = batchEnd;
 							if ((currentPage & 0x3FF) == 0)
 							{
 								writeDbHeader(tdbb, currentPage);
@@ -1103,6 +1300,59 @@ namespace Jrd {
 		}
 	}
 
+	// Take pages of the current batch until there are no more left.
+	// Called by the crypt thread and its workers at the same time.
+	void CryptoManager::cryptPages(thread_db* tdbb)
+	{
+		while (!down())
+		{
+			const ULONG pageNumber = (ULONG) nextPage.exchangeAdd(1);
+			if (pageNumber >= batchEnd)
+				break;
+
+			cryptPage(tdbb, pageNumber);
+		}
+	}
+
+	void CryptoManager::cryptPage(thread_db* tdbb, ULONG pageNumber)
+	{
+		// scheduling
+		JRD_reschedule(tdbb);
+
+		// nbackup state check
+		while (true)
+		{
+			int bak_state = Ods::hdr_nbak_unknown;
+			{	// scope
+				BackupManager::StateReadGuard stateGuard(tdbb);
+				bak_state = dbb.dbb_backup_manager->getState();
+			}
+
+			if (bak_state == Ods::hdr_nbak_normal)
+				break;
+
+			{	// scope
+				EngineCheckout checkout(tdbb, FB_FUNCTION);
+				Thread::sleep(10);
+			}
+
+			// forced terminate
+			if (down())
+				return;
+		}
+
+		// writing page to disk will change it's crypt status in usual way
+		WIN window(DB_PAGE_SPACE, pageNumber);
+		Ods::pag* page = CCH_FETCH(tdbb, &window, LCK_write, pag_undefined);
+		if (page && page->pag_type <= pag_max &&
+			(bool(page->pag_flags & Ods::crypted_page) != crypt) &&
+			Ods::pag_crypt_page[page->pag_type])
+		{
+			CCH_MARK_MUST_WRITE(tdbb, &window);
+		}
+		CCH_RELEASE_TAIL(tdbb, &window);
+	}
+
 	void CryptoManager::writeDbHeader(thread_db* tdbb, ULONG runpage)
 	{
 		CchHdr hdr(tdbb, LCK_write);
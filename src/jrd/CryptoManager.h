@@ -35,6 +35,7 @@
 #include "../common/classes/fb_string.h"
 #include "../common/classes/objects_array.h"
 #include "../common/classes/condition.h"
+#include "../common/classes/semaphore.h"
 #include "../jrd/MetaName.h"
 #include "../common/classes/GetPlugins.h"
 #include "../common/ThreadStart.h"
@@ -353,6 +354,13 @@ private:
 	void doOnTakenWriteSync(thread_db* tdbb);
 	void doOnAst(thread_db* tdbb);
 
+	// Helper thread of the crypt thread
+	class CryptWorker;
+	friend class CryptWorker;
+
+	void cryptPages(thread_db* tdbb);
+	void cryptPage(thread_db* tdbb, ULONG pageNumber);
+
 	void loadPlugin(thread_db* tdbb, const char* pluginName);
 	bool validateAttachment(thread_db* tdbb, Attachment* att, bool consume);
 	ULONG getLastPage(thread_db* tdbb);
@@ -385,6 +393,11 @@ private:
 	Lock* threadLock;
 	Attachment* cryptAtt;
 
+	// Batch of pages processed by the crypt thread and its workers
+	Firebird::AtomicCounter nextPage;
+	ULONG batchEnd;
+	Firebird::Semaphore batchDone;
+
 	// This counter works only in a case when database encryption is changed.
 	// Traditional processing of AST can not be used for crypto manager.
 	// The problem is with taking state lock after AST.
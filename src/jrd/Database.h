@@ -65,6 +65,9 @@
 #include "../jrd/event_proto.h"
 #include "../jrd/ExtEngineManager.h"
 #include "../jrd/Coercion.h"
+#include "../jrd/JoinOrderCache.h"
+#include "../jrd/IndexHistogram.h"
+#include "../jrd/RelationStatistics.h"
 #include "../lock/lock_proto.h"
 #include "../common/config/config.h"
 #include "../common/classes/SyncObject.h"
@@ -396,6 +399,10 @@ public:
 	{
 		Firebird::MemoryStats temp_stats;
 		MemoryPool* const pool = MemoryPool::createPool(NULL, temp_stats);
+
+		if (shared)
+			pool->enableThreadCaches();
+
 		Database* const dbb = FB_NEW_POOL(*pool) Database(pool, pConf, shared);
 		pool->setStatsGroup(dbb->dbb_memory_stats);
 		return dbb;
@@ -545,6 +552,9 @@ public:
 
 	unsigned dbb_compatibility_index;	// datatype backward compatibility level
 	Dictionary dbb_dic;					// metanames dictionary
+	JoinOrderCache dbb_join_orders;		// join orders chosen by the optimizer
+	IndexHistogramCache dbb_index_histograms;	// value distribution of index keys
+	RelationStatisticsCache dbb_relation_statistics;	// sampled statistics of relation columns
 	Firebird::InitInstance<KeywordsMap, KeywordsMapAllocator, Firebird::TraditionalDelete> dbb_keywords_map;
 
 	// returns true if primary file is located on raw device
@@ -613,7 +623,10 @@ private:
 		dbb_repl_sequence(0),
 		dbb_replica_mode(REPLICA_NONE),
 		dbb_compatibility_index(~0U),
-		dbb_dic(*p)
+		dbb_dic(*p),
+		dbb_join_orders(*p),
+		dbb_index_histograms(*p),
+		dbb_relation_statistics(*p)
 	{
 		dbb_pools.add(p);
 	}
@@ -0,0 +1,270 @@
+/*
+ *      PROGRAM:        JRD access method
+ *      MODULE:         IndexHistogram.cpp
+ *      DESCRIPTION:    Value distribution of index keys
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../jrd/IndexHistogram.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+int IndexHistogram::Value::compare(const UCHAR* data, USHORT length) const
+{
+	const FB_SIZE_T keyLength = key.getCount();
+	const int result = memcmp(key.begin(), data, MIN(keyLength, length));
+
+	if (result)
+		return result;
+
+	return (keyLength < length) ? -1 : (keyLength > length) ? 1 : 0;
+}
+
+
+IndexHistogram::IndexHistogram(MemoryPool& p, ULONG rootPage)
+	: root(rootPage),
+	  buckets(p),
+	  values(p),
+	  current(p),
+	  total(0),
+	  distinct(0),
+	  step(1),
+	  pending(0)
+{
+}
+
+// Add the next key, keys are expected to come in the index order.
+void IndexHistogram::add(const UCHAR* key, USHORT length)
+{
+	if (!total || current.compare(key, length))
+	{
+		if (total)
+			addValue();
+
+		current.key.assign(key, length);
+		current.count = 0;
+		++distinct;
+	}
+
+	++current.count;
+	++total;
+
+	if (++pending < step)
+		return;
+
+	Value& bucket = buckets.add();
+	bucket.key.assign(key, length);
+	bucket.count = pending;
+	pending = 0;
+
+	if (buckets.getCount() == 2 * MAX_BUCKETS)
+	{
+		// Merge adjacent buckets
+		for (FB_SIZE_T i = 0; i < MAX_BUCKETS; i++)
+		{
+			const FB_UINT64 count = buckets[2 * i].count + buckets[2 * i + 1].count;
+			buckets[i].key.assign(buckets[2 * i + 1].key);
+			buckets[i].count = count;
+		}
+
+		buckets.shrink(MAX_BUCKETS);
+		step *= 2;
+	}
+}
+
+// Complete the histogram after the last key was added.
+void IndexHistogram::finish()
+{
+	if (!total)
+		return;
+
+	addValue();
+
+	if (pending)
+	{
+		Value& bucket = buckets.add();
+		bucket.key.assign(current.key);
+		bucket.count = pending;
+		pending = 0;
+	}
+}
+
+// Remember the value just passed if it's more common than the ones seen before.
+void IndexHistogram::addValue()
+{
+	if (current.count < 2)
+		return;
+
+	if (values.getCount() < MAX_VALUES)
+	{
+		values.add(current);
+		return;
+	}
+
+	FB_SIZE_T least = 0;
+
+	for (FB_SIZE_T i = 1; i < values.getCount(); i++)
+	{
+		if (values[i].count < values[least].count)
+			least = i;
+	}
+
+	if (values[least].count < current.count)
+	{
+		values[least].key.assign(current.key);
+		values[least].count = current.count;
+	}
+}
+
+// Estimate the part of keys less than the given one.
+double IndexHistogram::getFraction(const UCHAR* key, USHORT length) const
+{
+	double count = 0;
+
+	for (FB_SIZE_T i = 0; i < buckets.getCount(); i++)
+	{
+		const Value& bucket = buckets[i];
+
+		if (bucket.compare(key, length) >= 0)
+		{
+			// The key is somewhere inside this bucket
+			count += bucket.count / 2.0;
+			break;
+		}
+
+		count += bucket.count;
+	}
+
+	return count / total;
+}
+
+double IndexHistogram::getEqualSelectivity(const UCHAR* key, USHORT length) const
+{
+	fb_assert(total);
+
+	FB_UINT64 commonCount = 0;
+
+	for (FB_SIZE_T i = 0; i < values.getCount(); i++)
+	{
+		const Value& value = values[i];
+
+		if (!value.compare(key, length))
+			return (double) value.count / total;
+
+		commonCount += value.count;
+	}
+
+	// Not a common value, spread the rest of keys evenly among the rest of values
+
+	const FB_UINT64 otherValues = distinct - values.getCount();
+
+	if (!otherValues)
+		return 1.0 / total;
+
+	return (double) (total - commonCount) / otherValues / total;
+}
+
+double IndexHistogram::getRangeSelectivity(const UCHAR* lower, USHORT lowerLength,
+	const UCHAR* upper, USHORT upperLength) const
+{
+	fb_assert(total);
+
+	const double lowerFraction = lower ? getFraction(lower, lowerLength) : 0;
+	const double upperFraction = upper ? getFraction(upper, upperLength) : 1;
+	const double minimum = 1.0 / total;
+
+	return MAX(upperFraction - lowerFraction, minimum);
+}
+
+
+IndexHistogramCache::IndexHistogramCache(MemoryPool& p)
+	: histograms(p)
+{
+}
+
+IndexHistogramCache::~IndexHistogramCache()
+{
+	HistogramMap::Accessor accessor(&histograms);
+
+	for (bool found = accessor.getFirst(); found; found = accessor.getNext())
+		delete accessor.current()->second;
+}
+
+// Replace the histogram of the index, the cache takes the ownership.
+// NULL histogram means there's nothing known about the index.
+void IndexHistogramCache::put(USHORT relationId, USHORT indexId, IndexHistogram* histogram)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	const ULONG key = makeKey(relationId, indexId);
+	IndexHistogram* old = NULL;
+
+	if (histograms.get(key, old))
+		delete old;
+
+	histograms.put(key, histogram);
+}
+
+// Find the histogram of the index. It's ignored if the index was recreated
+// since the histogram was collected. Should be called with the mutex locked.
+const IndexHistogram* IndexHistogramCache::get(USHORT relationId, USHORT indexId, ULONG rootPage)
+{
+	IndexHistogram* histogram = NULL;
+
+	if (!histograms.get(makeKey(relationId, indexId), histogram) ||
+		!histogram || histogram->getRootPage() != rootPage)
+	{
+		return NULL;
+	}
+
+	return histogram;
+}
+
+bool IndexHistogramCache::getEqualSelectivity(USHORT relationId, USHORT indexId, ULONG rootPage,
+	const UCHAR* key, USHORT length, double& selectivity)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	const IndexHistogram* const histogram = get(relationId, indexId, rootPage);
+
+	if (!histogram)
+		return false;
+
+	selectivity = histogram->getEqualSelectivity(key, length);
+	return true;
+}
+
+bool IndexHistogramCache::getRangeSelectivity(USHORT relationId, USHORT indexId, ULONG rootPage,
+	const UCHAR* lower, USHORT lowerLength, const UCHAR* upper, USHORT upperLength,
+	double& selectivity)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	const IndexHistogram* const histogram = get(relationId, indexId, rootPage);
+
+	if (!histogram)
+		return false;
+
+	selectivity = histogram->getRangeSelectivity(lower, lowerLength, upper, upperLength);
+	return true;
+}
@@ -0,0 +1,141 @@
+/*
+ *      PROGRAM:        JRD access method
+ *      MODULE:         IndexHistogram.h
+ *      DESCRIPTION:    Value distribution of index keys
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef JRD_INDEX_HISTOGRAM_H
+#define JRD_INDEX_HISTOGRAM_H
+
+#include "firebird.h"
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
+#include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
+
+namespace Jrd
+{
+
+// Distribution of the first segment keys of an index, collected while the
+// leaf level is walked to recompute the index selectivity.
+//
+// The histogram is equi-depth: every bucket holds about the same number of
+// keys and is described by its upper bound. The keys are added in the index
+// order, so the bucket size is not known in advance. It starts from a single
+// key and is doubled (by merging adjacent buckets) as soon as the number of
+// buckets reaches its limit.
+//
+// The most common values are kept separately, as the histogram alone cannot
+// tell a frequent value from its neighbours in the same bucket.
+//
+// Keys are compared bytewise, in the form they're stored in the index.
+
+class IndexHistogram
+{
+public:
+	static const FB_SIZE_T MAX_BUCKETS = 64;
+	static const FB_SIZE_T MAX_VALUES = 16;
+
+	IndexHistogram(MemoryPool& p, ULONG rootPage);
+
+	void add(const UCHAR* key, USHORT length);
+	void finish();
+
+	double getEqualSelectivity(const UCHAR* key, USHORT length) const;
+	double getRangeSelectivity(const UCHAR* lower, USHORT lowerLength,
+		const UCHAR* upper, USHORT upperLength) const;
+
+	ULONG getRootPage() const
+	{
+		return root;
+	}
+
+private:
+	struct Value
+	{
+		explicit Value(MemoryPool& p)
+			: key(p), count(0)
+		{}
+
+		Value(MemoryPool& p, const Value& other)
+			: key(p), count(other.count)
+		{
+			key.assign(other.key);
+		}
+
+		int compare(const UCHAR* data, USHORT length) const;
+
+		Firebird::Array<UCHAR> key;
+		FB_UINT64 count;
+	};
+
+	void addValue();
+	double getFraction(const UCHAR* key, USHORT length) const;
+
+	const ULONG root;
+	Firebird::ObjectsArray<Value> buckets;	// upper bound and number of keys
+	Firebird::ObjectsArray<Value> values;	// most common values
+	Value current;							// last key and its number of duplicates
+	FB_UINT64 total;
+	FB_UINT64 distinct;
+	FB_UINT64 step;
+	FB_UINT64 pending;
+};
+
+// Histograms of the indices of the database.
+//
+// They live in memory only and are lost when the database is closed,
+// until the statistics of the index are recomputed again.
+
+class IndexHistogramCache
+{
+public:
+	explicit IndexHistogramCache(MemoryPool& p);
+	~IndexHistogramCache();
+
+	void put(USHORT relationId, USHORT indexId, IndexHistogram* histogram);
+
+	bool getEqualSelectivity(USHORT relationId, USHORT indexId, ULONG rootPage,
+		const UCHAR* key, USHORT length, double& selectivity);
+	bool getRangeSelectivity(USHORT relationId, USHORT indexId, ULONG rootPage,
+		const UCHAR* lower, USHORT lowerLength, const UCHAR* upper, USHORT upperLength,
+		double& selectivity);
+
+private:
+	static ULONG makeKey(USHORT relationId, USHORT indexId)
+	{
+		return ((ULONG) relationId << 16) | indexId;
+	}
+
+	const IndexHistogram* get(USHORT relationId, USHORT indexId, ULONG rootPage);
+
+	typedef Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<ULONG, IndexHistogram*> > >
+		HistogramMap;
+
+	Firebird::Mutex mutex;
+	HistogramMap histograms;
+};
+
+} // namespace Jrd
+
+#endif // JRD_INDEX_HISTOGRAM_H
@@ -0,0 +1,112 @@
+/*
+ *      PROGRAM:        JRD access method
+ *      MODULE:         JoinOrderCache.cpp
+ *      DESCRIPTION:    Join orders chosen by the optimizer
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../jrd/JoinOrderCache.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+JoinOrderCache::JoinOrderCache(MemoryPool& p)
+	: pool(p),
+	  entries(p),
+	  keys(p),
+	  nextKey(0)
+{
+}
+
+JoinOrderCache::~JoinOrderCache()
+{
+	for (FB_UINT64* iter = keys.begin(); iter != keys.end(); ++iter)
+	{
+		Entry* entry = NULL;
+
+		if (entries.get(*iter, entry))
+			delete entry;
+	}
+}
+
+void JoinOrderCache::clear()
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	for (FB_UINT64* iter = keys.begin(); iter != keys.end(); ++iter)
+	{
+		Entry* entry = NULL;
+
+		if (entries.get(*iter, entry))
+			delete entry;
+	}
+
+	entries.clear();
+	keys.clear();
+	nextKey = 0;
+}
+
+bool JoinOrderCache::get(FB_UINT64 key, FB_UINT64 signature, Order& order)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	Entry* entry = NULL;
+
+	if (!entries.get(key, entry) || entry->signature != signature)
+		return false;
+
+	order.assign(entry->order.begin(), entry->order.getCount());
+	return true;
+}
+
+void JoinOrderCache::put(FB_UINT64 key, FB_UINT64 signature, const Order& order)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	Entry* entry = NULL;
+
+	if (!entries.get(key, entry))
+	{
+		if (keys.getCount() < MAX_ENTRIES)
+			keys.add(key);
+		else
+		{
+			// Replace the oldest entry
+
+			FB_UINT64& oldKey = keys[nextKey];
+			nextKey = (nextKey + 1) % MAX_ENTRIES;
+
+			if (entries.get(oldKey, entry))
+				entries.remove(oldKey);
+
+			oldKey = key;
+		}
+
+		if (!entry)
+			entry = FB_NEW_POOL(pool) Entry(pool);
+
+		entries.put(key, entry);
+	}
+
+	entry->signature = signature;
+	entry->order.assign(order.begin(), order.getCount());
+}
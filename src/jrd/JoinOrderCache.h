@@ -0,0 +1,104 @@
+/*
+ *      PROGRAM:        JRD access method
+ *      MODULE:         JoinOrderCache.h
+ *      DESCRIPTION:    Join orders chosen by the optimizer
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef JRD_JOIN_ORDER_CACHE_H
+#define JRD_JOIN_ORDER_CACHE_H
+
+#include "firebird.h"
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
+
+namespace Jrd
+{
+
+// Join orders found by the optimizer for inner joins of compiled requests.
+//
+// The key identifies the request BLR and the join inside it. The signature
+// describes streams, relations, their cardinalities and index statistics the
+// order was found for. When they change, the signature does not match anymore
+// and the join order is searched again. So plans stay stable until either
+// metadata or statistics are changed. Statistics not covered by the signature
+// (index histograms, sampled table statistics) clear the whole cache when
+// they're collected.
+//
+// The order is stored as a sequence of rivers: stream count followed by the
+// streams in the join order.
+
+class JoinOrderCache
+{
+public:
+	typedef Firebird::HalfStaticArray<StreamType, 16> Order;
+
+	static const FB_SIZE_T MAX_ENTRIES = 1024;
+
+	explicit JoinOrderCache(MemoryPool& p);
+	~JoinOrderCache();
+
+	bool get(FB_UINT64 key, FB_UINT64 signature, Order& order);
+	void put(FB_UINT64 key, FB_UINT64 signature, const Order& order);
+	void clear();
+
+	// FNV-1a
+	static FB_UINT64 hash(const void* data, FB_SIZE_T length,
+		FB_UINT64 value = FB_CONST64(0xCBF29CE484222325))
+	{
+		for (const UCHAR* p = static_cast<const UCHAR*>(data), *end = p + length; p < end; ++p)
+		{
+			value ^= *p;
+			value *= FB_CONST64(0x100000001B3);
+		}
+
+		return value;
+	}
+
+	template <typename T>
+	static FB_UINT64 hashValue(const T& data, FB_UINT64 value)
+	{
+		return hash(&data, sizeof(T), value);
+	}
+
+private:
+	struct Entry
+	{
+		explicit Entry(MemoryPool& p)
+			: signature(0), order(p)
+		{}
+
+		FB_UINT64 signature;
+		Firebird::Array<StreamType> order;
+	};
+
+	MemoryPool& pool;
+	Firebird::Mutex mutex;
+	Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<FB_UINT64, Entry*> > > entries;
+	Firebird::Array<FB_UINT64> keys;	// in order of insertion, to evict the oldest entry
+	FB_SIZE_T nextKey;
+};
+
+} // namespace Jrd
+
+#endif // JRD_JOIN_ORDER_CACHE_H
@@ -1441,7 +1441,8 @@ void Monitoring::dumpAttachment(thread_db* tdbb, Attachment* attachment)
 		const jrd_req* const request = *i;
 
 		if (!(request->getStatement()->flags &
-				(JrdStatement::FLAG_INTERNAL | JrdStatement::FLAG_SYS_TRIGGER)))
+				(JrdStatement::FLAG_INTERNAL | JrdStatement::FLAG_SYS_TRIGGER)) &&
+			!(request->req_flags & req_cached))
 		{
 			const string plan = OPT_get_plan(tdbb, request, true);
 			putRequest(record, request, plan);
@@ -119,6 +119,73 @@ namespace
 		return value;
 	}
 
+	// Get the value of a literal, possibly hidden inside the cast injected for int64 matches
+	bool getLiteralValue(thread_db* tdbb, const ValueExprNode* node, dsc& desc, SINT64& buffer)
+	{
+		const CastNode* const cast = nodeAs<CastNode>(node);
+		const LiteralNode* const literal = nodeAs<LiteralNode>(cast ? cast->source : node);
+
+		if (!literal)
+			return false;
+
+		if (!cast)
+		{
+			desc = literal->litDesc;
+			return true;
+		}
+
+		if (cast->castDesc.dsc_dtype != dtype_int64)
+			return false;
+
+		ThreadStatusGuard tempStatus(tdbb);
+
+		try
+		{
+			buffer = MOV_get_int64(tdbb, &literal->litDesc, cast->castDesc.dsc_scale);
+		}
+		catch (const Exception&)
+		{
+			return false;
+		}
+
+		desc.makeInt64(cast->castDesc.dsc_scale, &buffer);
+		return true;
+	}
+
+	// Get the value of a literal converted to the column datatype as a number
+	bool getLiteralNumber(thread_db* tdbb, const ValueExprNode* node, const dsc& target, double& number)
+	{
+		const LiteralNode* const literal = nodeAs<LiteralNode>(node);
+
+		if (!literal)
+			return false;
+
+		union
+		{
+			SINT64 alignment;
+			UCHAR data[32];
+		} buffer;
+
+		if (target.dsc_length > sizeof(buffer.data))
+			return false;
+
+		dsc source = literal->litDesc;
+		dsc desc = target;
+		desc.dsc_address = buffer.data;
+
+		ThreadStatusGuard tempStatus(tdbb);
+
+		try
+		{
+			MOV_move(tdbb, &source, &desc);
+			return ColumnStatistics::getValue(tdbb, &desc, number);
+		}
+		catch (const Exception&)
+		{
+			return false;
+		}
+	}
+
 	ValueExprNode* invertBoolValue(CompilerScratch* csb, ValueExprNode* value)
 	{
 		// Having a condition (<field> != <boolean value>),
@@ -584,10 +651,16 @@ InversionCandidate* OptimizerRetrieval::generateInversion()
 			node->computable(csb, stream, true) &&
 			!invCandidate->matches.exist(node))
 		{
-			const ComparativeBoolNode* const cmpNode = nodeAs<ComparativeBoolNode>(node);
+			double factor;
+
+			if (!getFilterSelectivity(node, factor))
+			{
+				const ComparativeBoolNode* const cmpNode = nodeAs<ComparativeBoolNode>(node);
+
+				factor = (cmpNode && cmpNode->blrOp == blr_eql) ?
+					REDUCE_SELECTIVITY_FACTOR_EQUALITY : REDUCE_SELECTIVITY_FACTOR_INEQUALITY;
+			}
 
-			const double factor = (cmpNode && cmpNode->blrOp == blr_eql) ?
-				REDUCE_SELECTIVITY_FACTOR_EQUALITY : REDUCE_SELECTIVITY_FACTOR_INEQUALITY;
 			invCandidate->selectivity *= factor;
 		}
 	}
@@ -986,6 +1059,247 @@ bool OptimizerRetrieval::betterInversion(const InversionCandidate* inv1,
 	return false;
 }
 
+bool OptimizerRetrieval::getFilterSelectivity(const BoolExprNode* boolean, double& selectivity) const
+{
+/**************************************
+ *
+ *	g e t F i l t e r S e l e c t i v i t y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Estimate the selectivity of a conjunct not
+ *	matched to any index using the column statistics
+ *	collected by SET STATISTICS TABLE.
+ *
+ **************************************/
+	if (!relation)
+		return false;
+
+	const FieldNode* field = NULL;
+	const ValueExprNode* value = NULL;
+	const ValueExprNode* value2 = NULL;
+	UCHAR blrOp;
+
+	if (const MissingBoolNode* const missingNode = nodeAs<MissingBoolNode>(boolean))
+	{
+		field = nodeAs<FieldNode>(missingNode->arg);
+		blrOp = blr_missing;
+	}
+	else if (const ComparativeBoolNode* const cmpNode = nodeAs<ComparativeBoolNode>(boolean))
+	{
+		blrOp = cmpNode->blrOp;
+		field = nodeAs<FieldNode>(cmpNode->arg1);
+		value = cmpNode->arg2;
+		value2 = cmpNode->arg3;
+
+		if ((!field || field->fieldStream != stream) && blrOp != blr_between)
+		{
+			// Look at the other side of the comparison
+
+			field = nodeAs<FieldNode>(cmpNode->arg2);
+			value = cmpNode->arg1;
+
+			switch (blrOp)
+			{
+				case blr_gtr:
+					blrOp = blr_lss;
+					break;
+
+				case blr_geq:
+					blrOp = blr_leq;
+					break;
+
+				case blr_lss:
+					blrOp = blr_gtr;
+					break;
+
+				case blr_leq:
+					blrOp = blr_geq;
+					break;
+			}
+		}
+	}
+
+	if (!field || field->fieldStream != stream)
+		return false;
+
+	ColumnStatistics column(pool);
+
+	if (!database->dbb_relation_statistics.getColumn(relation->rel_id, relation->rel_current_fmt,
+			field->fieldId, column))
+	{
+		return false;
+	}
+
+	if (blrOp == blr_missing)
+	{
+		// No NULLs in the sample doesn't mean there are none at all
+		const double cardinality = csb->csb_rpt[stream].csb_cardinality;
+		const double minimum = (cardinality > MINIMUM_CARDINALITY) ? 1 / cardinality : MAXIMUM_SELECTIVITY;
+
+		selectivity = MAX(column.nullFraction, minimum);
+		return true;
+	}
+
+	if (column.distinct <= 0)
+		return false;
+
+	const double equalSelectivity = column.getEqualSelectivity();
+
+	switch (blrOp)
+	{
+		case blr_eql:
+		case blr_equiv:
+			selectivity = equalSelectivity;
+			return true;
+
+		case blr_neq:
+			selectivity = MAX(1 - column.nullFraction - equalSelectivity, equalSelectivity);
+			return true;
+
+		case blr_gtr:
+		case blr_geq:
+		case blr_lss:
+		case blr_leq:
+		case blr_between:
+			break;
+
+		default:
+			return false;
+	}
+
+	if (column.bounds.getCount() < 2)
+		return false;
+
+	const Format* const format = MET_current(tdbb, relation);
+	fb_assert(field->fieldId < format->fmt_count);
+	const dsc& fieldDesc = format->fmt_desc[field->fieldId];
+
+	double bound, bound2;
+
+	if (!getLiteralNumber(tdbb, value, fieldDesc, bound))
+		return false;
+
+	switch (blrOp)
+	{
+		case blr_gtr:
+		case blr_geq:
+			selectivity = column.getRangeSelectivity(&bound, NULL);
+			break;
+
+		case blr_lss:
+		case blr_leq:
+			selectivity = column.getRangeSelectivity(NULL, &bound);
+			break;
+
+		case blr_between:
+			if (!getLiteralNumber(tdbb, value2, fieldDesc, bound2))
+				return false;
+
+			selectivity = column.getRangeSelectivity(&bound, &bound2);
+			break;
+	}
+
+	return true;
+}
+
+bool OptimizerRetrieval::getHistogramSelectivity(const IndexScratch* indexScratch,
+	const IndexScratchSegment* segment, double& selectivity) const
+{
+/**************************************
+ *
+ *	g e t H i s t o g r a m S e l e c t i v i t y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Estimate the selectivity of the first index segment
+ *	matched against literal values using the histogram
+ *	collected when the index statistics were recomputed.
+ *
+ **************************************/
+	const index_desc* const idx = indexScratch->idx;
+
+	if (!relation || indexScratch->fuzzy)
+		return false;
+
+	const ValueExprNode* lowerValue = NULL;
+	const ValueExprNode* upperValue = NULL;
+
+	switch (segment->scanType)
+	{
+		case segmentScanEqual:
+		case segmentScanEquivalent:
+		case segmentScanBetween:
+			lowerValue = segment->lowerValue;
+			upperValue = segment->upperValue;
+			break;
+
+		case segmentScanLess:
+			upperValue = segment->upperValue;
+			break;
+
+		case segmentScanGreater:
+			lowerValue = segment->lowerValue;
+			break;
+
+		default:
+			return false;
+	}
+
+	temporary_key lowerKey, upperKey;
+	SINT64 lowerInt64, upperInt64;
+	dsc lowerDesc, upperDesc;
+
+	if ((lowerValue && !getLiteralValue(tdbb, lowerValue, lowerDesc, lowerInt64)) ||
+		(upperValue && !getLiteralValue(tdbb, upperValue, upperDesc, upperInt64)))
+	{
+		return false;
+	}
+
+	ThreadStatusGuard tempStatus(tdbb);
+
+	try
+	{
+		if ((lowerValue && !BTR_make_segment_key(tdbb, idx, &lowerDesc, &lowerKey)) ||
+			(upperValue && !BTR_make_segment_key(tdbb, idx, &upperDesc, &upperKey)))
+		{
+			return false;
+		}
+	}
+	catch (const Exception&)
+	{
+		// The value cannot be converted to the index key, leave it to the execution
+		return false;
+	}
+
+	IndexHistogramCache& histograms = database->dbb_index_histograms;
+
+	if (segment->scanType == segmentScanEqual || segment->scanType == segmentScanEquivalent)
+	{
+		return histograms.getEqualSelectivity(relation->rel_id, idx->idx_id, idx->idx_root,
+			lowerKey.key_data, lowerKey.key_length, selectivity);
+	}
+
+	// Keys of a descending index go in the reverse order of values
+
+	const temporary_key* lower = lowerValue ? &lowerKey : NULL;
+	const temporary_key* upper = upperValue ? &upperKey : NULL;
+
+	if (idx->idx_flags & idx_descending)
+	{
+		const temporary_key* const temp = lower;
+		lower = upper;
+		upper = temp;
+	}
+
+	return histograms.getRangeSelectivity(relation->rel_id, idx->idx_id, idx->idx_root,
+		lower ? lower->key_data : NULL, lower ? lower->key_length : 0,
+		upper ? upper->key_data : NULL, upper ? upper->key_length : 0,
+		selectivity);
+}
+
 void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversions,
 		IndexScratchList* fromIndexScratches, USHORT scope) const
 {
@@ -1020,9 +1334,15 @@ void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversio
 
 			bool unique = false;
 
+			// Correction of the average segment selectivities for the value
+			// matched by the first segment, taken from the index histogram
+			double skewFactor = 1;
+
 			for (int j = 0; j < scratch.idx->idx_count; j++)
 			{
 				const IndexScratchSegment* const segment = scratch.segments[j];
+				const double segmentSelectivity =
+					MIN(scratch.idx->idx_rpt[j].idx_selectivity * skewFactor, MAXIMUM_SELECTIVITY);
 
 				if (segment->scope == scope)
 					scratch.scopeCandidate = true;
@@ -1054,7 +1374,16 @@ void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversio
 					// This is a perfect usable segment thus update root selectivity
 					scratch.lowerCount++;
 					scratch.upperCount++;
-					scratch.selectivity = scratch.idx->idx_rpt[j].idx_selectivity;
+					scratch.selectivity = segmentSelectivity;
+
+					double histogramSelectivity;
+					if (j == 0 && scratch.selectivity > 0 &&
+						getHistogramSelectivity(&scratch, segment, histogramSelectivity))
+					{
+						skewFactor = histogramSelectivity / scratch.selectivity;
+						scratch.selectivity = histogramSelectivity;
+					}
+
 					scratch.nonFullMatchedSegments = scratch.idx->idx_count - (j + 1);
 					// Add matches for this segment to the main matches list
 					matches.join(segment->matches);
@@ -1099,19 +1428,19 @@ void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversio
 						case segmentScanBetween:
 							scratch.lowerCount++;
 							scratch.upperCount++;
-							selectivity = scratch.idx->idx_rpt[j].idx_selectivity;
+							selectivity = segmentSelectivity;
 							factor = REDUCE_SELECTIVITY_FACTOR_BETWEEN;
 							break;
 
 						case segmentScanLess:
 							scratch.upperCount++;
-							selectivity = scratch.idx->idx_rpt[j].idx_selectivity;
+							selectivity = segmentSelectivity;
 							factor = REDUCE_SELECTIVITY_FACTOR_LESS;
 							break;
 
 						case segmentScanGreater:
 							scratch.lowerCount++;
-							selectivity = scratch.idx->idx_rpt[j].idx_selectivity;
+							selectivity = segmentSelectivity;
 							factor = REDUCE_SELECTIVITY_FACTOR_GREATER;
 							break;
 
@@ -1120,7 +1449,7 @@ void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversio
 						case segmentScanEquivalent:
 							scratch.lowerCount++;
 							scratch.upperCount++;
-							selectivity = scratch.idx->idx_rpt[j].idx_selectivity;
+							selectivity = segmentSelectivity;
 							factor = REDUCE_SELECTIVITY_FACTOR_STARTING;
 							break;
 
@@ -1129,6 +1458,14 @@ void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversio
 							break;
 					}
 
+					double histogramSelectivity;
+					if (j == 0 && segment->scanType != segmentScanStarting &&
+						getHistogramSelectivity(&scratch, segment, histogramSelectivity))
+					{
+						selectivity = histogramSelectivity;
+						factor = 0;
+					}
+
 					// Adjust the compound selectivity using the reduce factor.
 					// It should be better than the previous segment but worse
 					// than a full match.
@@ -192,6 +192,9 @@ protected:
 		InversionNode::Type node_type) const;
 	const Firebird::string& getAlias();
 	InversionCandidate* generateInversion();
+	bool getFilterSelectivity(const BoolExprNode* boolean, double& selectivity) const;
+	bool getHistogramSelectivity(const IndexScratch* indexScratch,
+		const IndexScratchSegment* segment, double& selectivity) const;
 	void getInversionCandidates(InversionCandidateList* inversions,
 		IndexScratchList* indexScratches, USHORT scope) const;
 	InversionNode* makeIndexScanNode(IndexScratch* indexScratch) const;
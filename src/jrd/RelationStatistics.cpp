@@ -0,0 +1,404 @@
+/*
+ *      PROGRAM:        JRD access method
+ *      MODULE:         RelationStatistics.cpp
+ *      DESCRIPTION:    Sampled statistics of relation columns
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../jrd/RelationStatistics.h"
+#include "../jrd/JoinOrderCache.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/val.h"
+#include "../jrd/dpm_proto.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/met_proto.h"
+#include "../jrd/mov_proto.h"
+#include "../jrd/vio_proto.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	// Values of a column seen in the sampled records
+	struct Sample
+	{
+		explicit Sample(MemoryPool& p)
+			: hashes(p), values(p), nulls(0), ordered(true)
+		{}
+
+		Array<FB_UINT64> hashes;
+		Array<double> values;
+		FB_UINT64 nulls;
+		bool ordered;
+	};
+
+	FB_UINT64 hashValue(const dsc* desc)
+	{
+		switch (desc->dsc_dtype)
+		{
+			case dtype_varying:
+			{
+				const vary* const string = reinterpret_cast<const vary*>(desc->dsc_address);
+				return JoinOrderCache::hash(string->vary_string, string->vary_length);
+			}
+
+			case dtype_cstring:
+				return JoinOrderCache::hash(desc->dsc_address,
+					strlen(reinterpret_cast<const char*>(desc->dsc_address)));
+
+			default:
+				return JoinOrderCache::hash(desc->dsc_address, desc->dsc_length);
+		}
+	}
+
+	int compareHashes(const void* a, const void* b)
+	{
+		const FB_UINT64 first = *static_cast<const FB_UINT64*>(a);
+		const FB_UINT64 second = *static_cast<const FB_UINT64*>(b);
+
+		return (first < second) ? -1 : (first > second) ? 1 : 0;
+	}
+
+	int compareValues(const void* a, const void* b)
+	{
+		const double first = *static_cast<const double*>(a);
+		const double second = *static_cast<const double*>(b);
+
+		return (first < second) ? -1 : (first > second) ? 1 : 0;
+	}
+} // namespace
+
+
+double ColumnStatistics::getEqualSelectivity() const
+{
+	fb_assert(distinct > 0);
+
+	return (1 - nullFraction) / distinct;
+}
+
+// Estimate the part of non-null values less than the given one.
+double ColumnStatistics::getFraction(double value) const
+{
+	const FB_SIZE_T count = bounds.getCount();
+	fb_assert(count > 1);
+
+	if (value <= bounds[0])
+		return 0;
+
+	if (value >= bounds[count - 1])
+		return 1;
+
+	FB_SIZE_T i = 0;
+
+	while (bounds[i + 1] <= value)
+		i++;
+
+	// Values are assumed to be spread evenly inside the bucket
+	const double width = bounds[i + 1] - bounds[i];
+	const double part = (width > 0) ? (value - bounds[i]) / width : 0;
+
+	return (i + part) / (count - 1);
+}
+
+// Estimate the selectivity of a range. Missing bound means the range is open at that side.
+double ColumnStatistics::getRangeSelectivity(const double* lower, const double* upper) const
+{
+	fb_assert(bounds.getCount() > 1);
+
+	const double lowerFraction = lower ? getFraction(*lower) : 0;
+	const double upperFraction = upper ? getFraction(*upper) : 1;
+	const double selectivity = (upperFraction - lowerFraction) * (1 - nullFraction);
+
+	// The range includes its bounds, so it's not less selective than an equality
+	const double minimum = distinct > 0 ? getEqualSelectivity() : 0;
+
+	return MAX(selectivity, minimum);
+}
+
+// Represent a value of an orderable datatype as a number.
+bool ColumnStatistics::getValue(thread_db* tdbb, const dsc* desc, double& value)
+{
+	switch (desc->dsc_dtype)
+	{
+		case dtype_sql_date:
+			value = *reinterpret_cast<const ISC_DATE*>(desc->dsc_address);
+			return true;
+
+		case dtype_sql_time:
+		case dtype_sql_time_tz:
+			value = *reinterpret_cast<const ISC_TIME*>(desc->dsc_address);
+			return true;
+
+		case dtype_timestamp:
+		case dtype_timestamp_tz:
+		{
+			const ISC_TIMESTAMP* const timestamp =
+				reinterpret_cast<const ISC_TIMESTAMP*>(desc->dsc_address);
+			value = timestamp->timestamp_date +
+				(double) timestamp->timestamp_time / (86400.0 * ISC_TIME_SECONDS_PRECISION);
+			return true;
+		}
+
+		default:
+			if (!DTYPE_IS_NUMERIC(desc->dsc_dtype))
+				return false;
+
+			value = MOV_get_double(tdbb, desc);
+			return true;
+	}
+}
+
+
+RelationStatistics* RelationStatistics::collect(thread_db* tdbb, jrd_rel* relation,
+	jrd_tra* transaction)
+{
+/**************************************
+ *
+ *	c o l l e c t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read records from a sample of data pages of the relation
+ *	and estimate the number of records per data page, part of
+ *	NULLs, number of distinct values and value distribution of
+ *	every column.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	const Format* const format = MET_current(tdbb, relation);
+
+	Array<ULONG> pages(pool);
+	DPM_sample_pages(tdbb, relation, MAX_SAMPLE_PAGES, pages);
+
+	ObjectsArray<Sample> samples(pool);
+	samples.grow(format->fmt_count);
+
+	for (USHORT id = 0; id < format->fmt_count; id++)
+	{
+		const UCHAR dtype = format->fmt_desc[id].dsc_dtype;
+
+		samples[id].ordered = DTYPE_IS_NUMERIC(dtype) || DTYPE_IS_DATE(dtype);
+	}
+
+	FB_UINT64 records = 0;
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+	rpb.rpb_record = NULL;
+
+	try
+	{
+		for (const ULONG* page = pages.begin(); page != pages.end(); ++page)
+		{
+			for (USHORT line = 0; line < dbb->dbb_max_records; line++)
+			{
+				rpb.rpb_number.setValue((SINT64) *page * dbb->dbb_max_records + line);
+
+				if (!VIO_get(tdbb, &rpb, transaction, &pool))
+					continue;
+
+				++records;
+
+				for (USHORT id = 0; id < format->fmt_count; id++)
+				{
+					const UCHAR dtype = format->fmt_desc[id].dsc_dtype;
+
+					if (dtype == dtype_unknown || dtype == dtype_blob || dtype == dtype_array)
+						continue;
+
+					Sample& sample = samples[id];
+					dsc desc;
+
+					if (!EVL_field(relation, rpb.rpb_record, id, &desc))
+					{
+						++sample.nulls;
+						continue;
+					}
+
+					sample.hashes.add(hashValue(&desc));
+
+					double value;
+					if (sample.ordered && ColumnStatistics::getValue(tdbb, &desc, value))
+						sample.values.add(value);
+				}
+			}
+
+			JRD_reschedule(tdbb);
+		}
+	}
+	catch (const Exception&)
+	{
+		delete rpb.rpb_record;
+		throw;
+	}
+
+	delete rpb.rpb_record;
+
+	AutoPtr<RelationStatistics> statistics(FB_NEW_POOL(*dbb->dbb_permanent)
+		RelationStatistics(*dbb->dbb_permanent, format->fmt_version));
+
+	if (pages.hasData())
+		statistics->recordsPerPage = (double) records / pages.getCount();
+
+	// Scale factor from the sample to the whole relation
+	const ULONG dataPages = DPM_data_pages(tdbb, relation);
+	const double scale = pages.hasData() ? (double) dataPages / pages.getCount() : 1;
+
+	statistics->columns.grow(format->fmt_count);
+
+	for (USHORT id = 0; id < format->fmt_count; id++)
+	{
+		Sample& sample = samples[id];
+		ColumnStatistics& column = statistics->columns[id];
+
+		const FB_UINT64 count = sample.hashes.getCount();
+
+		if (!count)
+		{
+			column.nullFraction = records ? (double) sample.nulls / records : 0;
+			continue;
+		}
+
+		column.nullFraction = (double) sample.nulls / records;
+
+		// Count distinct values in the sample and values seen only once
+
+		qsort(sample.hashes.begin(), count, sizeof(FB_UINT64), compareHashes);
+
+		FB_UINT64 distinct = 0, singles = 0;
+
+		for (FB_SIZE_T i = 0; i < count; )
+		{
+			FB_SIZE_T next = i + 1;
+
+			while (next < count && sample.hashes[next] == sample.hashes[i])
+				next++;
+
+			++distinct;
+
+			if (next - i == 1)
+				++singles;
+
+			i = next;
+		}
+
+		// Extrapolate the number of distinct values using the Haas and Stokes estimator:
+		// D = n * d / (n - f1 + f1 * n / N), where n is the number of sampled values,
+		// d is the number of distinct ones among them, f1 is the number of values
+		// seen once and N is the total number of values.
+
+		const double n = (double) count;
+		const double total = n * scale;
+		const double estimate = n * distinct / (n - singles + singles * n / total);
+
+		column.distinct = MIN(MAX(estimate, (double) distinct), total);
+
+		// Build the histogram of ordered values
+
+		const FB_SIZE_T valueCount = sample.values.getCount();
+
+		if (valueCount > 1)
+		{
+			qsort(sample.values.begin(), valueCount, sizeof(double), compareValues);
+
+			const FB_SIZE_T buckets = MIN(ColumnStatistics::MAX_BUCKETS, valueCount - 1);
+
+			for (FB_SIZE_T i = 0; i <= buckets; i++)
+				column.bounds.add(sample.values[(FB_UINT64) i * (valueCount - 1) / buckets]);
+		}
+	}
+
+	return statistics.release();
+}
+
+
+RelationStatisticsCache::RelationStatisticsCache(MemoryPool& p)
+	: relations(p)
+{
+}
+
+RelationStatisticsCache::~RelationStatisticsCache()
+{
+	StatisticsMap::Accessor accessor(&relations);
+
+	for (bool found = accessor.getFirst(); found; found = accessor.getNext())
+		delete accessor.current()->second;
+}
+
+// Replace the statistics of the relation, the cache takes the ownership.
+void RelationStatisticsCache::put(USHORT relationId, RelationStatistics* statistics)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	RelationStatistics* old = NULL;
+
+	if (relations.get(relationId, old))
+		delete old;
+
+	relations.put(relationId, statistics);
+}
+
+// Find the statistics of the relation. They're ignored if the relation was altered
+// since they were collected. Should be called with the mutex locked.
+const RelationStatistics* RelationStatisticsCache::get(USHORT relationId, USHORT format)
+{
+	RelationStatistics* statistics = NULL;
+
+	if (!relations.get(relationId, statistics) || statistics->format != format)
+		return NULL;
+
+	return statistics;
+}
+
+bool RelationStatisticsCache::getRecordsPerPage(USHORT relationId, USHORT format,
+	double& recordsPerPage)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	const RelationStatistics* const statistics = get(relationId, format);
+
+	if (!statistics || statistics->recordsPerPage <= 0)
+		return false;
+
+	recordsPerPage = statistics->recordsPerPage;
+	return true;
+}
+
+bool RelationStatisticsCache::getColumn(USHORT relationId, USHORT format, USHORT fieldId,
+	ColumnStatistics& column)
+{
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	const RelationStatistics* const statistics = get(relationId, format);
+
+	if (!statistics || fieldId >= statistics->columns.getCount())
+		return false;
+
+	column.assign(statistics->columns[fieldId]);
+	return true;
+}
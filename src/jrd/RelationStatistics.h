@@ -0,0 +1,129 @@
+/*
+ *      PROGRAM:        JRD access method
+ *      MODULE:         RelationStatistics.h
+ *      DESCRIPTION:    Sampled statistics of relation columns
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef JRD_RELATION_STATISTICS_H
+#define JRD_RELATION_STATISTICS_H
+
+#include "firebird.h"
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
+#include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
+
+struct dsc;
+
+namespace Jrd
+{
+
+class thread_db;
+class jrd_rel;
+class jrd_tra;
+
+// Statistics of a single column
+
+class ColumnStatistics
+{
+public:
+	static const FB_SIZE_T MAX_BUCKETS = 64;
+
+	explicit ColumnStatistics(MemoryPool& p)
+		: nullFraction(0), distinct(0), bounds(p)
+	{}
+
+	ColumnStatistics(MemoryPool& p, const ColumnStatistics& other)
+		: nullFraction(other.nullFraction), distinct(other.distinct), bounds(p)
+	{
+		bounds.assign(other.bounds);
+	}
+
+	void assign(const ColumnStatistics& other)
+	{
+		nullFraction = other.nullFraction;
+		distinct = other.distinct;
+		bounds.assign(other.bounds);
+	}
+
+	double getEqualSelectivity() const;
+	double getRangeSelectivity(const double* lower, const double* upper) const;
+
+	static bool getValue(thread_db* tdbb, const dsc* desc, double& value);
+
+	double nullFraction;				// part of NULL values
+	double distinct;					// estimated number of distinct values, zero if unknown
+	Firebird::Array<double> bounds;		// equi-depth histogram of values, if they can be ordered
+
+private:
+	double getFraction(double value) const;
+};
+
+// Statistics collected by SET STATISTICS TABLE from a sample of data pages.
+// They're valid for the relation format they were collected for.
+
+class RelationStatistics
+{
+public:
+	static const ULONG MAX_SAMPLE_PAGES = 256;
+
+	RelationStatistics(MemoryPool& p, USHORT formatNumber)
+		: format(formatNumber), recordsPerPage(0), columns(p)
+	{}
+
+	static RelationStatistics* collect(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction);
+
+	const USHORT format;
+	double recordsPerPage;
+	Firebird::ObjectsArray<ColumnStatistics> columns;	// by field id
+};
+
+// Statistics of the relations of the database.
+//
+// They live in memory only and are lost when the database is closed,
+// until SET STATISTICS TABLE is run again.
+
+class RelationStatisticsCache
+{
+public:
+	explicit RelationStatisticsCache(MemoryPool& p);
+	~RelationStatisticsCache();
+
+	void put(USHORT relationId, RelationStatistics* statistics);
+
+	bool getRecordsPerPage(USHORT relationId, USHORT format, double& recordsPerPage);
+	bool getColumn(USHORT relationId, USHORT format, USHORT fieldId, ColumnStatistics& column);
+
+private:
+	const RelationStatistics* get(USHORT relationId, USHORT format);
+
+	typedef Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<USHORT, RelationStatistics*> > >
+		StatisticsMap;
+
+	Firebird::Mutex mutex;
+	StatisticsMap relations;
+};
+
+} // namespace Jrd
+
+#endif // JRD_RELATION_STATISTICS_H
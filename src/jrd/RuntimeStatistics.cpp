@@ -84,9 +84,15 @@ PerformanceInfo* RuntimeStatistics::computeDifference(Attachment* att,
 {
 	// NOTE: we do not initialize dest.pin_time. This must be done by the caller
 
+	static_assert((int) PerformanceInfo::ARENA_HIGH_WATER == (int) ARENA_HIGH_WATER,
+		"PerformanceInfo and RuntimeStatistics counters mismatch");
+
 	// Calculate database-level statistics
 	for (int i = 0; i < TOTAL_ITEMS; i++)
-		values[i] = new_stat.values[i] - values[i];
+	{
+		values[i] = (i == ARENA_HIGH_WATER) ?
+			new_stat.values[i] : new_stat.values[i] - values[i];
+	}
 
 	dest.pin_counters = values;
 
@@ -74,6 +74,7 @@ public:
 		RECORD_RPT_READS,
 		RECORD_IMGC,
 		RECORD_LAST_ITEM = RECORD_IMGC,
+		ARENA_HIGH_WATER,	// peak size of request arenas, not a counter
 		TOTAL_ITEMS		// last
 	};
 
@@ -217,6 +218,16 @@ public:
 		++allChgNumber;
 	}
 
+	// Used for the values which are maximums rather than counters
+	void setMaxValue(const StatType index, SINT64 value)
+	{
+		if (value > values[index])
+		{
+			values[index] = value;
+			++allChgNumber;
+		}
+	}
+
 	SINT64 getRelValue(const StatType index, SLONG relation_id) const
 	{
 		FB_SIZE_T pos;
@@ -251,7 +262,12 @@ public:
 
 			allChgNumber++;
 			for (size_t i = FIRST_ITEM; i < TOTAL_ITEMS; ++i)
-				values[i] += newStats.values[i] - baseStats.values[i];
+			{
+				if (i == ARENA_HIGH_WATER)
+					values[i] = MAX(values[i], newStats.values[i]);
+				else
+					values[i] += newStats.values[i] - baseStats.values[i];
+			}
 
 			if (baseStats.relChgNumber != newStats.relChgNumber)
 			{
@@ -388,6 +388,8 @@ const char
 	STATEMENT_TIMEOUT[] = "STATEMENT_TIMEOUT",
 	EFFECTIVE_USER_NAME[] = "EFFECTIVE_USER",
 	SESSION_TIMEZONE[] = "SESSION_TIMEZONE",
+	STATEMENT_CACHE_HITS[] = "STATEMENT_CACHE_HITS",
+	STATEMENT_CACHE_MISSES[] = "STATEMENT_CACHE_MISSES",
 	// SYSTEM namespace: transaction wise items
 	TRANSACTION_ID_NAME[] = "TRANSACTION_ID",
 	ISOLATION_LEVEL_NAME[] = "ISOLATION_LEVEL",
@@ -4429,6 +4431,16 @@ dsc* evlGetContext(thread_db* tdbb, const SysFunction*, const NestValueArray& ar
 			TimeZoneUtil::format(timeZoneBuffer, sizeof(timeZoneBuffer), attachment->att_current_timezone);
 			resultStr = timeZoneBuffer;
 		}
+		else if (nameStr == STATEMENT_CACHE_HITS || nameStr == STATEMENT_CACHE_MISSES)
+		{
+			const dsql_dbb* const dsqlDbb = attachment->att_dsql_instance;
+			const DsqlStatementCache* const cache = dsqlDbb ? &dsqlDbb->dbb_statement_cache : NULL;
+
+			if (nameStr == STATEMENT_CACHE_HITS)
+				resultStr.printf("%" UQUADFORMAT, cache ? cache->getHits() : 0);
+			else
+				resultStr.printf("%" UQUADFORMAT, cache ? cache->getMisses() : 0);
+		}
 		else
 		{
 			// "Context variable %s is not found in namespace %s"
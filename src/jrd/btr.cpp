@@ -207,6 +207,7 @@ static ULONG find_page(btree_page*, const temporary_key*, const index_desc*, Rec
 					   bool = false);
 
 static contents garbage_collect(thread_db*, WIN*, ULONG);
+static void get_segment_key(const temporary_key*, USHORT, bool, temporary_key*);
 static void generate_jump_nodes(thread_db*, btree_page*, JumpNodeList*, USHORT,
 								USHORT*, USHORT*, USHORT*, USHORT);
 
@@ -1746,6 +1747,79 @@ void BTR_make_null_key(thread_db* tdbb, const index_desc* idx, temporary_key* ke
 }
 
 
+bool BTR_make_segment_key(thread_db* tdbb, const index_desc* idx, const dsc* desc, temporary_key* key)
+{
+/**************************************
+ *
+ *	B T R _ m a k e _ s e g m e n t _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Construct the key of the first index segment
+ *	for the given value, the way the index histogram
+ *	keeps it (see get_segment_key). Return false if
+ *	the key is too big.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const Database* dbb = tdbb->getDatabase();
+
+	fb_assert(idx != NULL);
+	fb_assert(desc != NULL);
+	fb_assert(key != NULL);
+
+	key->key_flags = key_empty;
+	key->key_nulls = 0;
+
+	const bool descending = (idx->idx_flags & idx_descending);
+	const USHORT keyType = (idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT;
+	const USHORT maxKeyLength = dbb->getMaxIndexKeyLength();
+
+	if (idx->idx_count == 1)
+		compress(tdbb, desc, key, idx->idx_rpt[0].idx_itype, false, descending, keyType);
+	else
+	{
+		temporary_key temp;
+		temp.key_flags = key_empty;
+		temp.key_length = 0;
+
+		compress(tdbb, desc, &temp, idx->idx_rpt[0].idx_itype, false, descending, keyType);
+
+		// Stuff the segment number and pad the last part of the segment
+		UCHAR* p = key->key_data;
+		const UCHAR* q = temp.key_data;
+		USHORT stuff_count = 0;
+
+		for (USHORT l = temp.key_length; l; --l, --stuff_count)
+		{
+			if (stuff_count == 0)
+			{
+				*p++ = idx->idx_count;
+				stuff_count = STUFF_COUNT;
+			}
+
+			if (p - key->key_data >= maxKeyLength)
+				return false;
+
+			*p++ = *q++;
+		}
+
+		for (; stuff_count; --stuff_count)
+			*p++ = 0;
+
+		key->key_length = p - key->key_data;
+	}
+
+	if (key->key_length >= maxKeyLength)
+		return false;
+
+	if (descending)
+		BTR_complement_key(key);
+
+	return true;
+}
+
 bool BTR_next_index(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction, index_desc* idx, WIN* window)
 {
 /**************************************
@@ -2063,6 +2137,7 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 	const bool descending = (root->irt_rpt[id].irt_flags & irt_descending);
 	const ULONG segments = root->irt_rpt[id].irt_keys;
+	const ULONG indexRoot = page;
 
 	window.win_flags = WIN_large_scan;
 	window.win_scans = 1;
@@ -2081,7 +2156,7 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 	FB_UINT64 nodes = 0;
 	FB_UINT64 duplicates = 0;
-	temporary_key key;
+	temporary_key key, segmentKey;
 	key.key_flags = 0;
 	key.key_length = 0;
 	SSHORT l;
@@ -2092,7 +2167,11 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 	duplicatesList.grow(segments);
 	memset(duplicatesList.begin(), 0, segments * sizeof(FB_UINT64));
 
-	//const Database* dbb = tdbb->getDatabase();
+	Database* const dbb = tdbb->getDatabase();
+
+	// collect the distribution of the first segment keys as well
+	AutoPtr<IndexHistogram> histogram(FB_NEW_POOL(*dbb->dbb_permanent)
+		IndexHistogram(*dbb->dbb_permanent, indexRoot));
 
 	// go through all the leaf nodes and count them;
 	// also count how many of them are duplicates
@@ -2202,6 +2281,15 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 			// keep the key value current for comparison with the next key
 			key.key_length = l;
 			memcpy(key.key_data + node.prefix, node.data, node.length);
+
+			if (segments > 1)
+			{
+				get_segment_key(&key, segments, descending, &segmentKey);
+				histogram->add(segmentKey.key_data, segmentKey.key_length);
+			}
+			else
+				histogram->add(key.key_data, key.key_length);
+
 			pointer = node.readNode(pointer, true);
 		}
 
@@ -2214,6 +2302,12 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 	CCH_RELEASE_TAIL(tdbb, &window);
 
+	histogram->finish();
+	dbb->dbb_index_histograms.put(relation->rel_id, id, nodes ? histogram.release() : NULL);
+
+	// Join orders could be found with the previous histogram
+	dbb->dbb_join_orders.clear();
+
 	// calculate the selectivity
 	selectivity.grow(segments);
 	if (segments > 1)
@@ -5172,6 +5266,40 @@ static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_numbe
 }
 
 
+static void get_segment_key(const temporary_key* key, USHORT segments, bool descending,
+							temporary_key* result)
+{
+/**************************************
+ *
+ *	g e t _ s e g m e n t _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Extract the first segment part of a compound key.
+ *	The last part of the segment is padded, as it isn't
+ *	when the next segments are missing from the key.
+ *
+ **************************************/
+	const UCHAR segment = descending ? 255 - segments : segments;
+	const UCHAR pad = descending ? 255 : 0;
+
+	USHORT length = 0;
+
+	while (length < key->key_length && key->key_data[length] == segment)
+		length += STUFF_COUNT + 1;
+
+	if (length > key->key_length)
+	{
+		memcpy(result->key_data, key->key_data, key->key_length);
+		memset(result->key_data + key->key_length, pad, length - key->key_length);
+	}
+	else
+		memcpy(result->key_data, key->key_data, length);
+
+	result->key_length = length;
+}
+
 static void generate_jump_nodes(thread_db* tdbb, btree_page* page,
 								JumpNodeList* jumpNodes,
 								USHORT excludeOffset, USHORT* jumpersSize,
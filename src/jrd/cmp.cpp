@@ -173,6 +173,10 @@ jrd_req* CMP_compile2(thread_db* tdbb, const UCHAR* blr, ULONG blr_length, bool
 		CompilerScratch* csb =
 			PAR_parse(tdbb, blr, blr_length, internal_flag, dbginfo_length, dbginfo);
 
+		// Let the optimizer reuse join orders found for the same BLR
+		if (!internal_flag)
+			csb->csb_blr_hash = JoinOrderCache::hash(blr, blr_length);
+
 		request = JrdStatement::makeRequest(tdbb, csb, internal_flag);
 		new_pool->setStatsGroup(request->req_memory_stats);
 
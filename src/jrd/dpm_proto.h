@@ -73,6 +73,7 @@ void	DPM_pages(Jrd::thread_db*, SSHORT, int, ULONG, ULONG);
 #ifdef SUPERSERVER_V2
 SLONG	DPM_prefetch_bitmap(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::PageBitmap*, SLONG);
 #endif
+void	DPM_sample_pages(Jrd::thread_db*, Jrd::jrd_rel*, ULONG, Firebird::Array<ULONG>&);
 void	DPM_scan_pages(Jrd::thread_db*);
 void	DPM_store(Jrd::thread_db*, Jrd::record_param*, Jrd::PageStack&, const Jrd::RecordStorageType type);
 RecordNumber DPM_store_blob(Jrd::thread_db*, Jrd::blb*, Jrd::Record*);
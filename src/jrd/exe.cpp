@@ -772,6 +772,7 @@ void EXE_release(thread_db* tdbb, jrd_req* request)
 	SET_TDBB(tdbb);
 
 	EXE_unwind(tdbb, request);
+	request->resetArena(true);
 
 	// system requests are released after all attachments gone and with
 	// req_attachment not cleared
@@ -1003,6 +1004,8 @@ void EXE_unwind(thread_db* tdbb, jrd_req* request)
 	request->req_caller = NULL;
 	request->req_proc_inputs = NULL;
 	request->req_proc_caller = NULL;
+
+	request->resetArena(false);
 }
 
 
@@ -463,6 +463,8 @@ public:
 		csb_currentDMLNode(NULL),
 		csb_currentAssignTarget(NULL),
 		csb_preferredDesc(NULL),
+		csb_blr_hash(0),
+		csb_join_count(0),
 		csb_rpt(p)
 	{
 		csb_dbg_info = FB_NEW_POOL(p) Firebird::DbgInfo(p);
@@ -548,6 +550,8 @@ public:
 	StmtNode*	csb_currentDMLNode;		// could be StoreNode or ModifyNode
 	ExprNode*	csb_currentAssignTarget;
 	dsc*		csb_preferredDesc;		// expected by receiving side data format
+	FB_UINT64	csb_blr_hash;			// identifies the request in the join order cache, zero if none
+	ULONG		csb_join_count;			// inner joins optimized so far
 
 	struct csb_repeat
 	{
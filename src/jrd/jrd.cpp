@@ -7395,6 +7395,9 @@ void release_attachment(thread_db* tdbb, Jrd::Attachment* attachment)
 	if (attachment->att_event_session)
 		dbb->eventManager()->deleteSession(attachment->att_event_session);
 
+	// Release the statements kept compiled for reuse and the lock protecting them
+	DSQL_purge_statement_cache(tdbb, false);
+
     // CMP_release() changes att_requests.
 	while (attachment->att_requests.hasData())
 		CMP_release(tdbb, attachment->att_requests.back());
@@ -8732,6 +8735,14 @@ SSHORT thread_db::getCharSet() const
 	return attachment->att_charset;
 }
 
+MemoryPool& MoveStorage::getPool() const
+{
+	thread_db* const tdbb = JRD_get_thread_data();
+	jrd_req* const request = tdbb ? tdbb->getRequest() : NULL;
+
+	return request ? *request->getArena() : InlineStorage<UCHAR, 256>::getPool();
+}
+
 ISC_STATUS thread_db::getCancelState(ISC_STATUS* secondary)
 {
 	// Test for asynchronous shutdown/cancellation requests.
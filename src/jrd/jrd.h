@@ -892,8 +892,16 @@ inline char* stringDup(MemoryPool& p, const char* s)
 	return stringDup(p, s, strlen(s));
 }
 
+// Inline part of MoveBuffer. When it's not enough while a request is evaluated,
+// the buffer is allocated from the request arena, created on the first such use.
+class MoveStorage : public Firebird::InlineStorage<UCHAR, 256>
+{
+public:
+	MemoryPool& getPool() const;
+};
+
 // Used in string conversion calls
-typedef Firebird::HalfStaticArray<UCHAR, 256> MoveBuffer;
+typedef Firebird::Array<UCHAR, MoveStorage> MoveBuffer;
 
 } //namespace Jrd
 
@@ -584,6 +584,8 @@ static lck_owner_t get_owner_type(enum lck_t lock_type)
 	case LCK_record_gc:
 	case LCK_alter_database:
 	case LCK_repl_tables:
+	case LCK_dsql_statement_cache:
+	case LCK_dsql_statement_purge:
 		owner_type = LCK_OWNER_attachment;
 		break;
 
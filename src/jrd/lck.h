@@ -74,7 +74,9 @@ enum lck_t {
 	LCK_record_gc,				// Record-level GC lock
 	LCK_alter_database,			// ALTER DATABASE lock
 	LCK_repl_state,				// Replication state lock
-	LCK_repl_tables				// Replication set lock
+	LCK_repl_tables,			// Replication set lock
+	LCK_dsql_statement_cache,	// DSQL statement cache lock
+	LCK_dsql_statement_purge	// DSQL statement cache purge lock
 };
 
 // Lock owner types
@@ -346,6 +346,8 @@ static RecordSource* gen_residual_boolean(thread_db* tdbb, OptimizerBlk* opt, Re
 static RecordSource* gen_retrieval(thread_db* tdbb, OptimizerBlk* opt, StreamType stream,
 	SortNode** sort_ptr, bool outer_flag, bool inner_flag, BoolExprNode** return_boolean);
 static bool gen_equi_join(thread_db*, OptimizerBlk*, RiverList&);
+static FB_UINT64 get_join_signature(const OptimizerBlk*, const StreamList&);
+static bool is_join_order_valid(const StreamList&, const JoinOrderCache::Order&);
 static double get_cardinality(thread_db*, jrd_rel*, const Format*);
 static BoolExprNode* make_inference_node(CompilerScratch*, BoolExprNode*, ValueExprNode*, ValueExprNode*);
 static bool map_equal(const ValueExprNode*, const ValueExprNode*, const MapNode*);
@@ -407,6 +409,9 @@ inline bool TEST_DEP_ARRAYS(const ULONG* ar1, const ULONG* ar2)
 
 const int CACHE_PAGES_PER_STREAM			= 15;
 
+// Smaller joins are cheap to optimize, don't cache their orders
+const FB_SIZE_T MIN_CACHED_JOIN_STREAMS		= 3;
+
 // enumeration of sort datatypes
 
 static const UCHAR sort_dtypes[] =
@@ -2027,16 +2032,149 @@ static void gen_join(thread_db*		tdbb,
 		return;
 	}
 
-	OptimizerInnerJoin innerJoin(*tdbb->getDefaultPool(), opt, streams,
-								 (sort_clause ? *sort_clause : NULL), plan_clause);
+	CompilerScratch* const csb = opt->opt_csb;
+	const ULONG joinNumber = csb->csb_join_count++;
 
 	StreamList temp;
 	temp.assign(streams);
 
 	StreamType count;
+	JoinOrderCache::Order order;
+	FB_UINT64 key = 0, signature = 0;
+
+	// Reuse the join order found for the same join before, unless the statistics have changed
+
+	if (csb->csb_blr_hash && !plan_clause && streams.getCount() >= MIN_CACHED_JOIN_STREAMS)
+	{
+		key = JoinOrderCache::hashValue(joinNumber, csb->csb_blr_hash);
+		signature = get_join_signature(opt, streams);
+
+		if (tdbb->getDatabase()->dbb_join_orders.get(key, signature, order) &&
+			is_join_order_valid(streams, order))
+		{
+			const StreamType* river = order.begin();
+
+			do {
+				count = *river++;
+
+				for (StreamType i = 0; i < count; i++)
+					opt->opt_streams[i].opt_best_stream = *river++;
+			} while (form_river(tdbb, opt, count, streams.getCount(), temp, river_list, sort_clause));
+
+			return;
+		}
+
+		order.clear();
+	}
+
+	OptimizerInnerJoin innerJoin(*tdbb->getDefaultPool(), opt, streams,
+								 (sort_clause ? *sort_clause : NULL), plan_clause);
+
 	do {
 		count = innerJoin.findJoinOrder();
+
+		if (key)
+		{
+			order.add(count);
+
+			for (StreamType i = 0; i < count; i++)
+				order.add(opt->opt_streams[i].opt_best_stream);
+		}
 	} while (form_river(tdbb, opt, count, streams.getCount(), temp, river_list, sort_clause));
+
+	if (key)
+		tdbb->getDatabase()->dbb_join_orders.put(key, signature, order);
+}
+
+
+static FB_UINT64 get_join_signature(const OptimizerBlk* opt, const StreamList& streams)
+{
+/**************************************
+ *
+ *	g e t _ j o i n _ s i g n a t u r e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Describe the streams of an inner join together with
+ *	their cardinalities and the statistics of their indices.
+ *	A cached join order is valid while the description
+ *	remains the same.
+ *
+ **************************************/
+	const CompilerScratch* const csb = opt->opt_csb;
+
+	FB_UINT64 value = JoinOrderCache::hash(streams.begin(), streams.getCount() * sizeof(StreamType));
+	value = JoinOrderCache::hashValue(opt->favorFirstRows, value);
+
+	for (const StreamType* stream = streams.begin(); stream != streams.end(); ++stream)
+	{
+		const CompilerScratch::csb_repeat* const tail = &csb->csb_rpt[*stream];
+
+		const USHORT relationId = tail->csb_relation ? tail->csb_relation->rel_id : 0;
+		value = JoinOrderCache::hashValue(relationId, value);
+
+		// Cardinality is taken by the order of magnitude (log2),
+		// to not search the order again as the table grows slightly
+
+		USHORT cardinality = 0;
+		for (double count = tail->csb_cardinality; count >= 2; count /= 2)
+			cardinality++;
+
+		value = JoinOrderCache::hashValue(cardinality, value);
+		value = JoinOrderCache::hashValue(tail->csb_indices, value);
+
+		for (USHORT i = 0; i < tail->csb_indices; i++)
+		{
+			const index_desc* const idx = &tail->csb_idx->items[i];
+
+			value = JoinOrderCache::hashValue(idx->idx_id, value);
+			value = JoinOrderCache::hashValue(idx->idx_flags, value);
+			value = JoinOrderCache::hashValue(idx->idx_selectivity, value);
+
+			for (USHORT j = 0; j < idx->idx_count; j++)
+				value = JoinOrderCache::hashValue(idx->idx_rpt[j].idx_selectivity, value);
+		}
+	}
+
+	return value;
+}
+
+
+static bool is_join_order_valid(const StreamList& streams, const JoinOrderCache::Order& order)
+{
+/**************************************
+ *
+ *	i s _ j o i n _ o r d e r _ v a l i d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Make sure the cached join order consists of non-empty
+ *	rivers which take every stream of the join exactly once.
+ *
+ **************************************/
+	SortedStreamList used;
+	const StreamType* river = order.begin();
+	const StreamType* const end = order.end();
+
+	while (river < end)
+	{
+		const StreamType count = *river++;
+
+		if (!count || count > (StreamType) (end - river))
+			return false;
+
+		for (const StreamType* const riverEnd = river + count; river < riverEnd; ++river)
+		{
+			if (!streams.exist(*river) || used.exist(*river))
+				return false;
+
+			used.add(*river);
+		}
+	}
+
+	return used.getCount() == streams.getCount();
 }
 
 
@@ -3140,7 +3278,22 @@ static double get_cardinality(thread_db* tdbb, jrd_rel* relation, const Format*
 	}
 
 	MET_post_existence(tdbb, relation);
-	const double cardinality = DPM_cardinality(tdbb, relation, format);
+
+	// Prefer the number of records per data page sampled by SET STATISTICS TABLE
+	// to the estimation based on the first data page
+
+	const USHORT formatNumber = format ? format->fmt_version : relation->rel_current_fmt;
+	double recordsPerPage;
+	double cardinality;
+
+	if (tdbb->getDatabase()->dbb_relation_statistics.getRecordsPerPage(relation->rel_id,
+			formatNumber, recordsPerPage))
+	{
+		cardinality = DPM_data_pages(tdbb, relation) * recordsPerPage;
+	}
+	else
+		cardinality = DPM_cardinality(tdbb, relation, format);
+
 	MET_release_existence(tdbb, relation);
 
 	return cardinality;
@@ -21,6 +21,7 @@
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
 #include "../dsql/BoolNodes.h"
+#include "../dsql/ExprNodes.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/mov_proto.h"
@@ -31,17 +32,90 @@
 using namespace Firebird;
 using namespace Jrd;
 
+namespace
+{
+	// Get the value of an exact numeric literal at the given scale
+	bool getExactValue(const dsc* desc, SCHAR scale, SINT64& value)
+	{
+		switch (desc->dsc_dtype)
+		{
+			case dtype_short:
+				value = *(SSHORT*) desc->dsc_address;
+				break;
+
+			case dtype_long:
+				value = *(SLONG*) desc->dsc_address;
+				break;
+
+			case dtype_int64:
+				value = *(SINT64*) desc->dsc_address;
+				break;
+
+			default:
+				return false;
+		}
+
+		// The literal is rescaled only if it can be done exactly
+
+		if (desc->dsc_scale < scale)
+			return false;
+
+		for (int i = desc->dsc_scale; i > scale; i--)
+		{
+			if (value > MAX_SINT64 / 10 || value < MIN_SINT64 / 10)
+				return false;
+
+			value *= 10;
+		}
+
+		return true;
+	}
+
+	template <typename T>
+	int compareValues(T value1, T value2)
+	{
+		return (value1 < value2) ? -1 : (value1 > value2) ? 1 : 0;
+	}
+
+	// Comparison with swapped operands
+	UCHAR swapComparison(UCHAR blrOp)
+	{
+		switch (blrOp)
+		{
+			case blr_gtr:
+				return blr_lss;
+
+			case blr_geq:
+				return blr_leq;
+
+			case blr_lss:
+				return blr_gtr;
+
+			case blr_leq:
+				return blr_geq;
+		}
+
+		return blrOp;
+	}
+} // namespace
+
+
 // ------------------------------------
 // Data access: predicate driven filter
 // ------------------------------------
 
 FilteredStream::FilteredStream(CompilerScratch* csb, RecordSource* next, BoolExprNode* boolean)
-	: m_next(next), m_boolean(boolean), m_anyBoolean(NULL),
-	  m_ansiAny(false), m_ansiAll(false), m_ansiNot(false)
+	: m_next(next), m_boolean(boolean), m_residual(NULL), m_kernels(csb->csb_pool),
+	  m_anyBoolean(NULL), m_ansiAny(false), m_ansiAll(false), m_ansiNot(false)
 {
 	fb_assert(m_next && m_boolean);
 
 	m_impure = csb->allocImpure<Impure>();
+
+	compileKernels(JRD_get_thread_data(), csb, boolean);
+
+	if (m_kernels.isEmpty())
+		m_residual = m_boolean;
 }
 
 void FilteredStream::open(thread_db* tdbb) const
@@ -342,7 +416,7 @@ bool FilteredStream::evaluateBoolean(thread_db* tdbb) const
 	bool result = false;
 	while (m_next->getRecord(tdbb))
 	{
-		if (m_boolean->execute(tdbb, request))
+		if (evaluateConjuncts(tdbb))
 		{
 			result = true;
 			break;
@@ -357,3 +431,280 @@ bool FilteredStream::evaluateBoolean(thread_db* tdbb) const
 
 	return result;
 }
+
+void FilteredStream::compileKernels(thread_db* tdbb, CompilerScratch* csb, BoolExprNode* boolean)
+{
+	// Split the conjunction and compile the simple comparisons into kernels,
+	// the rest of conjuncts is evaluated as usual
+
+	BinaryBoolNode* const andNode = nodeAs<BinaryBoolNode>(boolean);
+
+	if (andNode && andNode->blrOp == blr_and)
+	{
+		compileKernels(tdbb, csb, andNode->arg1);
+		compileKernels(tdbb, csb, andNode->arg2);
+		return;
+	}
+
+	Kernel kernel;
+
+	if (kernel.compile(tdbb, boolean))
+	{
+		m_kernels.add(kernel);
+		return;
+	}
+
+	m_residual = m_residual ?
+		FB_NEW_POOL(csb->csb_pool) BinaryBoolNode(csb->csb_pool, blr_and, m_residual, boolean) :
+		boolean;
+}
+
+bool FilteredStream::evaluateConjuncts(thread_db* tdbb) const
+{
+	jrd_req* const request = tdbb->getRequest();
+
+	if (m_kernels.isEmpty())
+		return m_boolean->execute(tdbb, request);
+
+	// Same as the conjunction of the kernels and the residual boolean:
+	// FALSE if any conjunct is FALSE, otherwise NULL if any conjunct is NULL
+
+	bool unknown = false;
+
+	for (const Kernel* kernel = m_kernels.begin(); kernel != m_kernels.end(); ++kernel)
+	{
+		request->req_flags &= ~req_null;
+
+		if (!kernel->execute(tdbb, request))
+		{
+			if (!(request->req_flags & req_null))
+				return false;
+
+			unknown = true;
+		}
+	}
+
+	request->req_flags &= ~req_null;
+
+	if (m_residual)
+	{
+		if (!m_residual->execute(tdbb, request))
+		{
+			if (!(request->req_flags & req_null))
+				return false;
+
+			unknown = true;
+		}
+
+		request->req_flags &= ~req_null;
+	}
+
+	if (unknown)
+	{
+		request->req_flags |= req_null;
+		return false;
+	}
+
+	return true;
+}
+
+
+bool FilteredStream::Kernel::compile(thread_db* tdbb, const BoolExprNode* boolean)
+{
+	const ComparativeBoolNode* const cmpNode = nodeAs<ComparativeBoolNode>(boolean);
+
+	if (!cmpNode)
+		return false;
+
+	const ValueExprNode* fieldArg = cmpNode->arg1;
+	const ValueExprNode* literalArg = cmpNode->arg2;
+	blrOp = cmpNode->blrOp;
+
+	switch (blrOp)
+	{
+		case blr_eql:
+		case blr_neq:
+		case blr_gtr:
+		case blr_geq:
+		case blr_lss:
+		case blr_leq:
+			if (nodeIs<LiteralNode>(fieldArg))
+			{
+				fieldArg = cmpNode->arg2;
+				literalArg = cmpNode->arg1;
+				blrOp = swapComparison(blrOp);
+			}
+			break;
+
+		case blr_between:
+			if (!nodeIs<LiteralNode>(cmpNode->arg3))
+				return false;
+			break;
+
+		default:
+			return false;
+	}
+
+	const FieldNode* const field = nodeAs<FieldNode>(fieldArg);
+	const LiteralNode* const literal = nodeAs<LiteralNode>(literalArg);
+
+	if (!field || !literal || field->cursorNumber.specified ||
+		!field->format || field->fieldId >= field->format->fmt_count)
+	{
+		return false;
+	}
+
+	const dsc& desc = field->format->fmt_desc[field->fieldId];
+
+	node = boolean;
+	stream = field->fieldStream;
+	fieldId = field->fieldId;
+	dtype = desc.dsc_dtype;
+	scale = desc.dsc_scale;
+
+	if (!getValue(tdbb, &literal->litDesc, value))
+		return false;
+
+	if (blrOp == blr_between)
+		return getValue(tdbb, &nodeAs<LiteralNode>(cmpNode->arg3)->litDesc, value2);
+
+	return true;
+}
+
+// Convert the literal into the form of the field data. Only conversions
+// giving the same result as the generic comparison are allowed.
+bool FilteredStream::Kernel::getValue(thread_db* tdbb, const dsc* desc, KernelValue& kernelValue)
+{
+	switch (dtype)
+	{
+		case dtype_short:
+		case dtype_long:
+		case dtype_int64:
+			return getExactValue(desc, scale, kernelValue.exact);
+
+		case dtype_double:
+			switch (desc->dsc_dtype)
+			{
+				case dtype_short:
+				case dtype_long:
+				case dtype_int64:
+				case dtype_double:
+					kernelValue.approx = MOV_get_double(tdbb, desc);
+					return true;
+			}
+			return false;
+
+		case dtype_sql_date:
+			if (desc->dsc_dtype != dtype_sql_date)
+				return false;
+
+			kernelValue.timestamp.timestamp_date = *(ISC_DATE*) desc->dsc_address;
+			kernelValue.timestamp.timestamp_time = 0;
+			return true;
+
+		case dtype_sql_time:
+			if (desc->dsc_dtype != dtype_sql_time)
+				return false;
+
+			kernelValue.timestamp.timestamp_date = 0;
+			kernelValue.timestamp.timestamp_time = *(ISC_TIME*) desc->dsc_address;
+			return true;
+
+		case dtype_timestamp:
+			if (desc->dsc_dtype != dtype_timestamp)
+				return false;
+
+			kernelValue.timestamp = *(ISC_TIMESTAMP*) desc->dsc_address;
+			return true;
+	}
+
+	return false;
+}
+
+int FilteredStream::Kernel::compare(const UCHAR* data, const KernelValue& kernelValue) const
+{
+	switch (dtype)
+	{
+		case dtype_short:
+			return compareValues<SINT64>(*(const SSHORT*) data, kernelValue.exact);
+
+		case dtype_long:
+			return compareValues<SINT64>(*(const SLONG*) data, kernelValue.exact);
+
+		case dtype_int64:
+			return compareValues<SINT64>(*(const SINT64*) data, kernelValue.exact);
+
+		case dtype_double:
+			return compareValues<double>(*(const double*) data, kernelValue.approx);
+
+		case dtype_sql_date:
+			return compareValues<SLONG>(*(const ISC_DATE*) data, kernelValue.timestamp.timestamp_date);
+
+		case dtype_sql_time:
+			return compareValues<ULONG>(*(const ISC_TIME*) data, kernelValue.timestamp.timestamp_time);
+
+		case dtype_timestamp:
+		{
+			const ISC_TIMESTAMP* const timestamp = (const ISC_TIMESTAMP*) data;
+			const int result = compareValues<SLONG>(timestamp->timestamp_date,
+				kernelValue.timestamp.timestamp_date);
+
+			return result ? result :
+				compareValues<ULONG>(timestamp->timestamp_time, kernelValue.timestamp.timestamp_time);
+		}
+	}
+
+	fb_assert(false);
+	return 0;
+}
+
+bool FilteredStream::Kernel::execute(thread_db* tdbb, jrd_req* request) const
+{
+	const Record* const record = request->req_rpb[stream].rpb_record;
+
+	// Records of other formats than the field was compiled for
+	// are left for the generic evaluation
+
+	const Format* const format = record ? record->getFormat() : NULL;
+	const dsc* const desc = (format && fieldId < format->fmt_count) ?
+		&format->fmt_desc[fieldId] : NULL;
+
+	if (!desc || desc->dsc_dtype != dtype || desc->dsc_scale != scale || !desc->dsc_address)
+		return node->execute(tdbb, request);
+
+	if (record->isNull(fieldId))
+	{
+		request->req_flags |= req_null;
+		return false;
+	}
+
+	const UCHAR* const data = record->getData() + (IPTR) desc->dsc_address;
+	const int comparison = compare(data, value);
+
+	switch (blrOp)
+	{
+		case blr_eql:
+			return comparison == 0;
+
+		case blr_neq:
+			return comparison != 0;
+
+		case blr_gtr:
+			return comparison > 0;
+
+		case blr_geq:
+			return comparison >= 0;
+
+		case blr_lss:
+			return comparison < 0;
+
+		case blr_leq:
+			return comparison <= 0;
+
+		case blr_between:
+			return comparison >= 0 && compare(data, value2) <= 0;
+	}
+
+	fb_assert(false);
+	return false;
+}
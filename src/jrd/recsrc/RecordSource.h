@@ -496,10 +496,42 @@ namespace Jrd
 		}
 
 	private:
+		union KernelValue
+		{
+			SINT64 exact;
+			double approx;
+			ISC_TIMESTAMP timestamp;
+		};
+
+		// Comparison of a field with a literal evaluated directly over the record data,
+		// bypassing the generic expression evaluation
+		struct Kernel
+		{
+			bool compile(thread_db* tdbb, const BoolExprNode* boolean);
+			bool execute(thread_db* tdbb, jrd_req* request) const;
+
+			const BoolExprNode* node;	// original comparison
+			StreamType stream;
+			USHORT fieldId;
+			UCHAR dtype;
+			SCHAR scale;
+			UCHAR blrOp;
+			KernelValue value;
+			KernelValue value2;			// upper bound of BETWEEN
+
+		private:
+			bool getValue(thread_db* tdbb, const dsc* desc, KernelValue& kernelValue);
+			int compare(const UCHAR* data, const KernelValue& kernelValue) const;
+		};
+
+		void compileKernels(thread_db* tdbb, CompilerScratch* csb, BoolExprNode* boolean);
+		bool evaluateConjuncts(thread_db* tdbb) const;
 		bool evaluateBoolean(thread_db* tdbb) const;
 
 		NestConst<RecordSource> m_next;
 		NestConst<BoolExprNode> const m_boolean;
+		NestConst<BoolExprNode> m_residual;
+		Firebird::Array<Kernel> m_kernels;
 		NestConst<BoolExprNode> m_anyBoolean;
 		bool m_ansiAny;
 		bool m_ansiAll;
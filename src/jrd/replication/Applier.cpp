@@ -259,6 +259,10 @@ void Applier::process(thread_db* tdbb, ULONG length, const UCHAR* data)
 
 	BlockReader reader(length, data);
 
+	// Records of the block mostly belong to few tables, so tables and their keys
+	// are looked up once per block rather than per every record
+	m_relations.clear();
+
 	const auto traNum = reader.getTransactionId();
 	const auto protocol = reader.getProtocolVersion();
 
@@ -495,12 +499,7 @@ void Applier::insertRecord(thread_db* tdbb, TraNumber traNum,
 
 	TRA_attach_request(transaction, m_request);
 
-	const auto relation = MET_lookup_relation(tdbb, relName);
-	if (!relation)
-		raiseError("Table %s is not found", relName.c_str());
-
-	if (!(relation->rel_flags & REL_scanned))
-		MET_scan_relation(tdbb, relation);
+	const auto relation = lookupRelation(tdbb, relName);
 
 	const auto format = findFormat(tdbb, relation, length);
 
@@ -614,12 +613,7 @@ void Applier::updateRecord(thread_db* tdbb, TraNumber traNum,
 
 	TRA_attach_request(transaction, m_request);
 
-	const auto relation = MET_lookup_relation(tdbb, relName);
-	if (!relation)
-		raiseError("Table %s is not found", relName.c_str());
-
-	if (!(relation->rel_flags & REL_scanned))
-		MET_scan_relation(tdbb, relation);
+	const auto relation = lookupRelation(tdbb, relName);
 
 	const auto orgFormat = findFormat(tdbb, relation, orgLength);
 
@@ -754,12 +748,7 @@ void Applier::deleteRecord(thread_db* tdbb, TraNumber traNum,
 
 	TRA_attach_request(transaction, m_request);
 
-	const auto relation = MET_lookup_relation(tdbb, relName);
-	if (!relation)
-		raiseError("Table %s is not found", relName.c_str());
-
-	if (!(relation->rel_flags & REL_scanned))
-		MET_scan_relation(tdbb, relation);
+	const auto relation = lookupRelation(tdbb, relName);
 
 	const auto format = findFormat(tdbb, relation, length);
 
@@ -904,10 +893,50 @@ void Applier::executeSql(thread_db* tdbb,
 	DSQL_execute_immediate(tdbb, attachment, &transaction,
 						   0, sql.c_str(), dialect,
 						   NULL, NULL, NULL, NULL, false);
+
+	// DDL may change the tables or their keys
+	m_relations.clear();
+}
+
+jrd_rel* Applier::lookupRelation(thread_db* tdbb, const MetaName& relName)
+{
+	for (const auto& cached : m_relations)
+	{
+		if (cached.relation->rel_name == relName)
+			return cached.relation;
+	}
+
+	const auto relation = MET_lookup_relation(tdbb, relName);
+	if (!relation)
+		raiseError("Table %s is not found", relName.c_str());
+
+	if (!(relation->rel_flags & REL_scanned))
+		MET_scan_relation(tdbb, relation);
+
+	m_relations.add(CachedRelation(relation));
+
+	return relation;
 }
 
 bool Applier::lookupKey(thread_db* tdbb, jrd_rel* relation, index_desc& key)
 {
+	CachedRelation* cached = NULL;
+
+	for (auto& item : m_relations)
+	{
+		if (item.relation == relation)
+		{
+			cached = &item;
+			break;
+		}
+	}
+
+	if (cached && cached->keyKnown)
+	{
+		key = cached->key;
+		return (key.idx_id != idx_invalid);
+	}
+
 	RelationPages* const relPages = relation->getPages(tdbb);
 	auto page = relPages->rel_index_root;
 	if (!page)
@@ -965,6 +994,12 @@ bool Applier::lookupKey(thread_db* tdbb, jrd_rel* relation, index_desc& key)
 
 	CCH_RELEASE(tdbb, &window);
 
+	if (cached)
+	{
+		cached->key = key;
+		cached->keyKnown = true;
+	}
+
 	return (key.idx_id != idx_invalid);
 }
 
@@ -37,6 +37,20 @@ namespace Jrd
 	{
 		typedef Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<TraNumber, jrd_tra*> > > TransactionMap;
 		typedef Firebird::HalfStaticArray<bid, 16> BlobList;
+
+		// Relation used by the current block and its key, looked up on demand
+		struct CachedRelation
+		{
+			explicit CachedRelation(jrd_rel* rel = NULL)
+				: relation(rel), keyKnown(false)
+			{}
+
+			jrd_rel* relation;
+			bool keyKnown;
+			index_desc key;
+		};
+
+		typedef Firebird::HalfStaticArray<CachedRelation, 8> RelationCache;
 /*
 		class ReplicatedTransaction : public Firebird::IReplicatedTransaction
 		{
@@ -128,7 +142,8 @@ namespace Jrd
 				Jrd::jrd_req* request)
 			: PermanentStorage(pool),
 			  m_txnMap(pool), m_database(pool, database),
-			  m_request(request), m_bitmap(FB_NEW_POOL(pool) RecordBitmap(pool)), m_record(NULL)
+			  m_request(request), m_bitmap(FB_NEW_POOL(pool) RecordBitmap(pool)), m_record(NULL),
+			  m_relations(pool)
 		{}
 
 		static Applier* create(thread_db* tdbb);
@@ -154,6 +169,7 @@ namespace Jrd
 		Firebird::AutoPtr<RecordBitmap> m_bitmap;
 		Record* m_record;
 		JReplicator* m_interface;
+		RelationCache m_relations;
 
 		void startTransaction(thread_db* tdbb, TraNumber traNum);
 		void prepareTransaction(thread_db* tdbb, TraNumber traNum);
@@ -185,6 +201,7 @@ namespace Jrd
 						const Firebird::string& sql,
 						const MetaName& owner);
 
+		jrd_rel* lookupRelation(thread_db* tdbb, const MetaName& relName);
 		bool lookupKey(thread_db* tdbb, jrd_rel* relation, index_desc& idx);
 		bool compareKey(thread_db* tdbb, jrd_rel* relation,
 						const index_desc& idx,
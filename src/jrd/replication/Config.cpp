@@ -58,6 +58,8 @@ namespace
 	const ULONG DEFAULT_GROUP_FLUSH_DELAY = 0;
 	const ULONG DEFAULT_APPLY_IDLE_TIMEOUT = 10;				// seconds
 	const ULONG DEFAULT_APPLY_ERROR_TIMEOUT = 60;				// seconds
+	const ULONG DEFAULT_APPLY_PARALLEL_WORKERS = 1;
+	const ULONG MAX_APPLY_PARALLEL_WORKERS = 64;
 
 	void parseLong(const string& input, ULONG& output)
 	{
@@ -123,6 +125,7 @@ Config::Config()
 	  verboseLogging(false),
 	  applyIdleTimeout(DEFAULT_APPLY_IDLE_TIMEOUT),
 	  applyErrorTimeout(DEFAULT_APPLY_ERROR_TIMEOUT),
+	  applyParallelWorkers(DEFAULT_APPLY_PARALLEL_WORKERS),
 	  pluginName(getPool()),
 	  logErrors(true),
 	  reportErrors(false),
@@ -149,6 +152,7 @@ Config::Config(const Config& other)
 	  verboseLogging(other.verboseLogging),
 	  applyIdleTimeout(other.applyIdleTimeout),
 	  applyErrorTimeout(other.applyErrorTimeout),
+	  applyParallelWorkers(other.applyParallelWorkers),
 	  pluginName(getPool(), other.pluginName),
 	  logErrors(other.logErrors),
 	  reportErrors(other.reportErrors),
@@ -401,6 +405,16 @@ void Config::enumerate(Firebird::Array<Config*>& replicas)
 				{
 					parseLong(value, config->applyErrorTimeout);
 				}
+				else if (key == "apply_parallel_workers")
+				{
+					parseLong(value, config->applyParallelWorkers);
+
+					if (!config->applyParallelWorkers ||
+						config->applyParallelWorkers > MAX_APPLY_PARALLEL_WORKERS)
+					{
+						configError("invalid (out of range) value", key, value);
+					}
+				}
 			}
 
 			if (dbName.hasData() && config->sourceDirectory.hasData())
@@ -57,6 +57,7 @@ namespace Replication
 		bool verboseLogging;
 		ULONG applyIdleTimeout;
 		ULONG applyErrorTimeout;
+		ULONG applyParallelWorkers;
 		Firebird::string pluginName;
 		bool logErrors;
 		bool reportErrors;
@@ -173,6 +173,8 @@ public:
 		: statement(aStatement),
 		  req_pool(statement->pool),
 		  req_memory_stats(parent_stats),
+		  req_arena_stats(&req_memory_stats),
+		  req_arena(NULL),
 		  req_blobs(req_pool),
 		  req_stats(*req_pool),
 		  req_base_stats(*req_pool),
@@ -240,6 +242,8 @@ public:
 	Attachment*	req_attachment;			// database attachment
 	USHORT		req_incarnation;		// incarnation number
 	Firebird::MemoryStats req_memory_stats;
+	Firebird::MemoryStats req_arena_stats;
+	MemoryPool* req_arena;				// see getArena()
 
 	// Transaction pointer and doubly linked list pointers for requests in this
 	// transaction. Maintained by TRA_attach_request/TRA_detach_request.
@@ -345,6 +349,41 @@ public:
 		return reinterpret_cast<T*>(&impureArea[offset]);
 	}
 
+	// Arena memory kept between executions of the request
+	static const size_t MAX_ARENA_MAPPING = 1024 * 1024;
+
+	// Pool for conversion buffers overflowing their inline part while the request
+	// is evaluated. They're freed in the same execution, so the pool keeps no live
+	// data when the request is unwound and it's released if it has grown too much.
+	MemoryPool* getArena()
+	{
+		if (!req_arena)
+			req_arena = MemoryPool::createPool(req_pool, req_arena_stats);
+
+		return req_arena;
+	}
+
+	void resetArena(bool release)
+	{
+		if (!req_arena)
+			return;
+
+		req_stats.setMaxValue(RuntimeStatistics::ARENA_HIGH_WATER, req_arena_stats.getMaximumUsage());
+
+		// Don't pull the memory from under a buffer still in use
+		if (req_arena_stats.getCurrentUsage())
+		{
+			fb_assert(!release);
+			return;
+		}
+
+		if (release || req_arena_stats.getCurrentMapping() > MAX_ARENA_MAPPING)
+		{
+			MemoryPool::deletePool(req_arena);
+			req_arena = NULL;
+		}
+	}
+
 	void adjustCallerStats()
 	{
 		if (req_caller) {
@@ -402,6 +441,7 @@ const ULONG req_same_tx_upd		= 0x400L;		// record was updated by same transactio
 const ULONG req_reserved		= 0x800L;		// Request reserved for client
 const ULONG req_update_conflict	= 0x1000L;		// We need to restart request due to update conflict
 const ULONG req_restart_ready	= 0x2000L;		// Request is ready to restat in case of update conflict
+const ULONG req_cached			= 0x4000L;		// Request is idle in the DSQL statement cache
 
 
 // Index lock block
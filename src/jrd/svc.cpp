@@ -1206,6 +1206,20 @@ ISC_STATUS Service::query2(thread_db* /*tdbb*/,
 
 			break;
 
+		case isc_info_svc_wire_stats:
+			// Empty cluster is filled by the network server with the statistics
+			// of its request queue, nothing to report in embedded mode
+			if (svc_user_flag & SVC_user_dba)
+			{
+				if (!ck_space_for_numeric(info, end))
+					return 0;
+				*info++ = item;
+				*info++ = isc_info_flag_end;
+			}
+			else
+				need_admin_privs(status, "isc_info_svc_wire_stats");
+			break;
+
 		case isc_info_svc_svr_online:
 			*info++ = item;
 			if (svc_user_flag & SVC_user_dba)
@@ -2690,6 +2704,15 @@ bool Service::process_switches(ClumpletReader& spb, string& switches)
 				get_action_svc_string(spb, switches);
 				break;
 
+			case isc_spb_nbk_parallel_workers:
+			case isc_spb_nbk_zstd_level:
+				if (!get_action_svc_parameter(spb.getClumpTag(), nbackup_in_sw_table, switches))
+				{
+					return false;
+				}
+				get_action_svc_data(spb, switches, false);
+				break;
+
 			default:
 				return false;
 			}
@@ -2940,6 +2963,8 @@ bool Service::process_switches(ClumpletReader& spb, string& switches)
 				get_action_svc_data(spb, burp_database, bigint);
 				break;
 			case isc_spb_bkp_factor:
+			case isc_spb_bkp_parallel_workers:
+			case isc_spb_bkp_zstd_level:
 			case isc_spb_res_buffers:
 			case isc_spb_res_page_size:
 			case isc_spb_verbint:
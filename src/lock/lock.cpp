@@ -163,6 +163,115 @@ static const bool compatibility[LCK_max][LCK_max] =
 
 namespace Jrd {
 
+// Copy of the wait-for graph used by the deadlock detection thread.
+// Nodes are pending requests grouped by their owners, edges point
+// from a request to the owners blocking it.
+
+class WaitForGraph
+{
+public:
+	struct Node
+	{
+		SRQ_PTR request;
+		FB_SIZE_T firstEdge;
+		FB_SIZE_T edgeCount;
+	};
+
+	struct Owner
+	{
+		SRQ_PTR owner;
+		FB_SIZE_T firstNode;
+		FB_SIZE_T nodeCount;
+
+		static const SRQ_PTR& generate(const Owner& item)
+		{
+			return item.owner;
+		}
+	};
+
+	explicit WaitForGraph(MemoryPool& pool)
+		: nodes(pool), edges(pool), owners(pool)
+	{
+		owners.setSortMode(FB_ARRAY_SORT_MANUAL);
+	}
+
+	// Return the request closing a cycle or zero if the graph has no cycles
+
+	SRQ_PTR findCycle() const
+	{
+		enum { WHITE = 0, GREY, BLACK };
+
+		const FB_SIZE_T count = owners.getCount();
+		HalfStaticArray<UCHAR, 128> colors(*getDefaultMemoryPool());
+		memset(colors.getBuffer(count), WHITE, count);
+
+		// Path of the depth-first search: owner position and next edge to visit
+		struct Step
+		{
+			FB_SIZE_T owner;
+			FB_SIZE_T node;
+			FB_SIZE_T edge;
+		};
+
+		HalfStaticArray<Step, 32> path(*getDefaultMemoryPool());
+
+		for (FB_SIZE_T root = 0; root < count; root++)
+		{
+			if (colors[root] != WHITE)
+				continue;
+
+			colors[root] = GREY;
+			Step step = {root, owners[root].firstNode, 0};
+			path.push(step);
+
+			while (path.hasData())
+			{
+				Step& top = path[path.getCount() - 1];
+				const Owner& owner = owners[top.owner];
+
+				if (top.node >= owner.firstNode + owner.nodeCount)
+				{
+					colors[top.owner] = BLACK;
+					path.pop();
+					continue;
+				}
+
+				const Node& node = nodes[top.node];
+
+				if (top.edge >= node.edgeCount)
+				{
+					top.node++;
+					top.edge = 0;
+					continue;
+				}
+
+				const SRQ_PTR blocker = edges[node.firstEdge + top.edge++];
+
+				// Owners not waiting for anything can't be a part of a cycle
+				FB_SIZE_T pos;
+				if (!owners.find(blocker, pos))
+					continue;
+
+				if (colors[pos] == GREY)
+					return node.request;
+
+				if (colors[pos] == WHITE)
+				{
+					colors[pos] = GREY;
+					Step next = {pos, owners[pos].firstNode, 0};
+					path.push(next);
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	Array<Node> nodes;
+	Array<SRQ_PTR> edges;
+	SortedArray<Owner, EmptyStorage<Owner>, SRQ_PTR, Owner> owners;
+};
+
 
 LockManager::LockManager(const string& id, const Config* conf)
 	: PID(getpid()),
@@ -170,6 +279,8 @@ LockManager::LockManager(const string& id, const Config* conf)
 	  m_process(NULL),
 	  m_processOffset(0),
 	  m_cleanupSync(getPool(), blocking_action_thread, THREAD_high),
+	  m_deadlockSync(getPool(), deadlock_thread, THREAD_medium),
+	  m_deadlockShutdown(false),
 	  m_sharedMemory(NULL),
 	  m_blockage(false),
 	  m_dbId(id),
@@ -218,6 +329,11 @@ LockManager::~LockManager()
 			m_cleanupSync.waitForCompletion();
 		}
 
+		// Stop the deadlock detection thread
+		m_deadlockShutdown = true;
+		m_deadlockSemaphore.release();
+		m_deadlockSync.waitForCompletion();
+
 #ifdef HAVE_OBJECT_MAP
 		m_sharedMemory->unmapObject(&localStatus, &m_process);
 #else
@@ -1484,7 +1600,7 @@ void LockManager::blocking_action_thread()
 
 
 void LockManager::exceptionHandler(const Exception& ex,
-	ThreadFinishSync<LockManager*>::ThreadRoutine* /*routine*/)
+	ThreadFinishSync<LockManager*>::ThreadRoutine* routine)
 {
 /**************************************
  *
@@ -1493,10 +1609,13 @@ void LockManager::exceptionHandler(const Exception& ex,
  **************************************
  *
  * Functional description
- *	Handler for blocking thread close bugs.
+ *	Handler for blocking and deadlock detection thread close bugs.
  *
  **************************************/
-	iscLogException("Error closing blocking action thread\n", ex);
+	if (routine == static_cast<ThreadFinishSync<LockManager*>::ThreadRoutine*>(deadlock_thread))
+		iscLogException("Error closing deadlock detection thread\n", ex);
+	else
+		iscLogException("Error closing blocking action thread\n", ex);
 }
 
 
@@ -1766,6 +1885,18 @@ bool LockManager::create_process(CheckStatusWrapper* statusVector)
 		}
 	}
 
+	try
+	{
+		m_deadlockSync.run(this);
+	}
+	catch (const Exception& ex)
+	{
+		(Arg::Gds(isc_lockmanerr) << Arg::StatusVector(ex) <<
+			Arg::Gds(isc_random) << Arg::Str("deadlock detection thread failed to start")).copyTo(statusVector);
+
+		return false;
+	}
+
 	return true;
 }
 
@@ -1800,48 +1931,250 @@ void LockManager::deadlock_clear()
 }
 
 
-lrq* LockManager::deadlock_scan(own* owner, lrq* request)
+bool LockManager::deadlock_detect()
 {
 /**************************************
  *
- *	d e a d l o c k _ s c a n
+ *	d e a d l o c k _ d e t e c t
  *
  **************************************
  *
  * Functional description
- *	Given an owner block that has been stalled for some time, find
- *	a deadlock cycle if there is one.  If a deadlock is found, return
- *	the address of a pending lock request in the deadlock request.
- *	If no deadlock is found, return null.
+ *	Look for a deadlock cycle in the wait-for graph.
+ *	The graph is copied while the lock table is held
+ *	and walked after it's released. A cycle found is
+ *	confirmed against the lock table before one of
+ *	its requests is rejected. Return true if
+ *	a deadlock has been broken.
  *
  **************************************/
-	LOCK_TRACE(("deadlock_scan: owner %ld request %ld\n", SRQ_REL_PTR(owner),
-			   SRQ_REL_PTR(request)));
+	WaitForGraph graph(getPool());
 
-	ASSERT_ACQUIRED;
-	++(m_sharedMemory->getHeader()->lhb_scans);
-	post_history(his_scan, request->lrq_owner, request->lrq_lock, SRQ_REL_PTR(request), true);
-	deadlock_clear();
+	SINT64 start = fb_utils::query_performance_counter();
+
+	{ // guardian's scope
+		LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
+
+		if (!m_processOffset)
+			return false;
+
+		deadlock_snapshot(graph);
+
+		lhb* const header = m_sharedMemory->getHeader();
+		++header->lhb_scans;
+		header->lhb_scan_time += (fb_utils::query_performance_counter() - start) *
+			1000000 / fb_utils::query_performance_frequency();
+	}
+
+	start = fb_utils::query_performance_counter();
+	const SRQ_PTR candidate = graph.findCycle();
+	const SINT64 walk_time = (fb_utils::query_performance_counter() - start) *
+		1000000 / fb_utils::query_performance_frequency();
+
+	start = fb_utils::query_performance_counter();
+
+	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
+
+	lhb* header = m_sharedMemory->getHeader();
+	header->lhb_walk_time += walk_time;
+
+	if (!candidate || !m_processOffset)
+		return false;
+
+	// The graph could change since the snapshot was taken, so ensure
+	// the candidate is still waiting and still a part of a deadlock
+
+	bool victim_found = false;
+	lrq* const request = (lrq*) SRQ_ABS_PTR(candidate);
+
+	if (request->lrq_type == type_lrq && (request->lrq_flags & LRQ_pending) &&
+		!(request->lrq_flags & LRQ_wait_timeout))
+	{
+		post_history(his_scan, request->lrq_owner, request->lrq_lock, candidate, true);
+		deadlock_clear();
 
 #ifdef VALIDATE_LOCK_TABLE
-	validate_lhb(m_sharedMemory->getHeader());
+		validate_lhb(m_sharedMemory->getHeader());
 #endif
 
-	bool maybe_deadlock = false;
-	lrq* victim = deadlock_walk(request, &maybe_deadlock);
+		bool maybe_deadlock = false;
+		lrq* const victim = deadlock_walk(request, &maybe_deadlock);
+
+		if (victim)
+		{
+			// Something has been selected for rejection to prevent a
+			// deadlock. Clean things up and wake up its owner.
 
-	// Only when it is certain that this request is not part of a deadlock do we
-	// mark this request as 'scanned' so that we will not check this request again.
-	// Note that this request might be part of multiple deadlocks.
+			DEBUG_MSG(0, ("deadlock_detect: selecting something for deadlock kill\n"));
 
-	if (!victim && !maybe_deadlock)
-		owner->own_flags |= OWN_scanned;
-#ifdef DEBUG_LM
-	else if (!victim && maybe_deadlock)
-		DEBUG_MSG(0, ("deadlock_scan: not marking due to maybe_deadlock\n"));
-#endif
+			++(m_sharedMemory->getHeader()->lhb_deadlocks);
+			victim->lrq_flags |= LRQ_rejected;
+			remove_que(&victim->lrq_own_pending);
+			victim->lrq_flags &= ~LRQ_pending;
+			lbl* const victim_lock = (lbl*) SRQ_ABS_PTR(victim->lrq_lock);
+			victim_lock->lbl_pending_lrq_count--;
+
+			own* const victim_owner = (own*) SRQ_ABS_PTR(victim->lrq_owner);
+			post_wakeup(victim_owner);
+
+			victim_found = true;
+		}
+	}
+
+	header = m_sharedMemory->getHeader();
+	header->lhb_scan_time += (fb_utils::query_performance_counter() - start) *
+		1000000 / fb_utils::query_performance_frequency();
+
+	return victim_found;
+}
+
+
+void LockManager::deadlock_snapshot(WaitForGraph& graph)
+{
+/**************************************
+ *
+ *	d e a d l o c k _ s n a p s h o t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Copy the wait-for graph: every pending request
+ *	waiting without a timeout and the waiting owners
+ *	blocking it. Owners not waiting are skipped, they
+ *	can't be a part of a cycle. Blocking rules are the
+ *	same as in deadlock_walk().
+ *
+ **************************************/
+	ASSERT_ACQUIRED;
+
+	srq* lock_srq;
+	SRQ_LOOP(m_sharedMemory->getHeader()->lhb_owners, lock_srq)
+	{
+		const own* const owner = (own*) ((UCHAR*) lock_srq - offsetof(own, own_lhb_owners));
+
+		if (SRQ_EMPTY(owner->own_pending))
+			continue;
+
+		WaitForGraph::Owner waiter;
+		waiter.owner = SRQ_REL_PTR(owner);
+		waiter.firstNode = graph.nodes.getCount();
+
+		srq* lock_srq2;
+		SRQ_LOOP(owner->own_pending, lock_srq2)
+		{
+			const lrq* const request = (lrq*) ((UCHAR*) lock_srq2 - offsetof(lrq, lrq_own_pending));
+			fb_assert(request->lrq_flags & LRQ_pending);
+
+			// Circles including requests waiting with a timeout
+			// are broken automatically when the timeout expires
 
-	return victim;
+			if (request->lrq_flags & LRQ_wait_timeout)
+				continue;
+
+			WaitForGraph::Node node;
+			node.request = SRQ_REL_PTR(request);
+			node.firstEdge = graph.edges.getCount();
+
+			const bool conversion = (request->lrq_state > LCK_null);
+			const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+
+			srq* lock_srq3;
+			SRQ_LOOP(lock->lbl_requests, lock_srq3)
+			{
+				const lrq* const block = (lrq*) ((UCHAR*) lock_srq3 - offsetof(lrq, lrq_lbl_requests));
+
+				if (conversion)
+				{
+					if (request == block)
+						continue;
+
+					if (compatibility[request->lrq_requested][block->lrq_state])
+						continue;
+				}
+				else
+				{
+					if (request == block)
+						break;
+
+					const UCHAR max_state = MAX(block->lrq_state, block->lrq_requested);
+
+					if (compatibility[request->lrq_requested][max_state])
+						continue;
+				}
+
+				// Owners still processing their ASTs are not considered as blocking,
+				// the blockage is likely to be resolved soon
+
+				const own* const blocker = (own*) SRQ_ABS_PTR(block->lrq_owner);
+
+				if ((blocker->own_flags & (OWN_signaled | OWN_wakeup)) ||
+					!SRQ_EMPTY(blocker->own_blocks) || (block->lrq_flags & LRQ_just_granted))
+				{
+					continue;
+				}
+
+				// Owner not waiting itself can't be a part of a cycle
+
+				if (SRQ_EMPTY(blocker->own_pending))
+					continue;
+
+				graph.edges.add(block->lrq_owner);
+			}
+
+			node.edgeCount = graph.edges.getCount() - node.firstEdge;
+			graph.nodes.add(node);
+		}
+
+		waiter.nodeCount = graph.nodes.getCount() - waiter.firstNode;
+		if (waiter.nodeCount)
+			graph.owners.add(waiter);
+	}
+
+	graph.owners.sort();
+}
+
+
+void LockManager::deadlock_thread()
+{
+/**************************************
+ *
+ *	d e a d l o c k _ t h r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Thread to detect deadlocks. It's woken up by owners
+ *	waiting longer than the deadlock scan interval.
+ *
+ **************************************/
+
+	while (true)
+	{
+		m_deadlockSemaphore.enter();
+
+		// Requests posted while the previous scan was running
+		// are served by the next one
+
+		while (m_deadlockSemaphore.tryEnter())
+			;
+
+		if (m_deadlockShutdown)
+			break;
+
+		// Continue scanning while deadlocks are found,
+		// a few cycles could exist at once. A failed scan
+		// is repeated when the waiters ask for it again.
+
+		try
+		{
+			while (deadlock_detect() && !m_deadlockShutdown)
+				;
+		}
+		catch (const Exception& ex)
+		{
+			iscLogException("Error in deadlock detection thread\n", ex);
+		}
+	}
 }
 
 
@@ -3448,7 +3781,7 @@ void LockManager::validate_owner(const SRQ_PTR own_ptr, USHORT freed)
 	CHECK(owner->own_acquire_time <= m_sharedMemory->getHeader()->lhb_acquires);
 
 	// Check that no invalid flag bit is set
-	CHECK(!(owner->own_flags & ~(OWN_scanned | OWN_wakeup | OWN_signaled)));
+	CHECK(!(owner->own_flags & ~(OWN_wakeup | OWN_signaled)));
 
 	const srq* lock_srq;
 	SRQ_LOOP(owner->own_requests, lock_srq)
@@ -3725,7 +4058,7 @@ void LockManager::wait_for_request(thread_db* tdbb, lrq* request, SSHORT lck_wai
 	const SRQ_PTR owner_offset = request->lrq_owner;
 
 	own* owner = (own*) SRQ_ABS_PTR(owner_offset);
-	owner->own_flags &= ~(OWN_scanned | OWN_wakeup);
+	owner->own_flags &= ~OWN_wakeup;
 	owner->own_waits++;
 
 	request->lrq_flags &= ~LRQ_rejected;
@@ -3912,64 +4245,38 @@ void LockManager::wait_for_request(thread_db* tdbb, lrq* request, SSHORT lck_wai
 		if (probe_processes() && !(request->lrq_flags & LRQ_pending))
 			break;
 
-		// If we've not previously been scanned for a deadlock and going to wait
-		// forever, go do a deadlock scan
-
-		lrq* blocking_request;
-		if (!(owner->own_flags & OWN_scanned) &&
-			!(request->lrq_flags & LRQ_wait_timeout) &&
-			(blocking_request = deadlock_scan(owner, request)))
+		// If going to wait forever, ask the deadlock detection thread to
+		// look for a cycle in the wait-for graph. If a deadlock is found,
+		// some request gets rejected and its owner is woken up.
+
+		if (!(request->lrq_flags & LRQ_wait_timeout))
+			m_deadlockSemaphore.release();
+
+		// Our request is not resolved, all the owners are alive, there's
+		// no deadlock -- there's nothing else to do.  Let's
+		// make sure our request hasn't been forgotten by reminding
+		// all the owners we're waiting - some plaforms under CLASSIC
+		// architecture had problems with "missing signals" - which is
+		// another reason to repost the blockage.
+		// Also, the ownership of the lock could have changed, and we
+		// weren't woken up because we weren't next in line for the lock.
+		// We need to inform the new owner.
+
+		DEBUG_MSG(0, ("wait_for_request: forcing a resignal of blockers\n"));
+		post_blockage(tdbb, request, lock);
+#ifdef DEV_BUILD
+		repost_counter++;
+		if (repost_counter % 50 == 0)
 		{
-			// Something has been selected for rejection to prevent a
-			// deadlock. Clean things up and go on. We still have to
-			// wait for our request to be resolved.
-
-			DEBUG_MSG(0, ("wait_for_request: selecting something for deadlock kill\n"));
-
-			++(m_sharedMemory->getHeader()->lhb_deadlocks);
-			blocking_request->lrq_flags |= LRQ_rejected;
-			remove_que(&blocking_request->lrq_own_pending);
-			blocking_request->lrq_flags &= ~LRQ_pending;
-			lbl* const blocking_lock = (lbl*) SRQ_ABS_PTR(blocking_request->lrq_lock);
-			blocking_lock->lbl_pending_lrq_count--;
-
-			own* const blocking_owner = (own*) SRQ_ABS_PTR(blocking_request->lrq_owner);
-			blocking_owner->own_flags &= ~OWN_scanned;
-			if (blocking_request != request)
-				post_wakeup(blocking_owner);
-			// else
-			// We rejected our own request to avoid a deadlock.
-			// When we get back to the top of the master loop we
-			// fall out and start cleaning up.
+			gds__log("wait_for_request: owner %d reposted %ld times for lock %d",
+					owner_offset,
+					repost_counter,
+					lock_offset);
+			DEBUG_MSG(0,
+					  ("wait_for_request: reposted %ld times for this lock!\n",
+					   repost_counter));
 		}
-		else
-		{
-			// Our request is not resolved, all the owners are alive, there's
-			// no deadlock -- there's nothing else to do.  Let's
-			// make sure our request hasn't been forgotten by reminding
-			// all the owners we're waiting - some plaforms under CLASSIC
-			// architecture had problems with "missing signals" - which is
-			// another reason to repost the blockage.
-			// Also, the ownership of the lock could have changed, and we
-			// weren't woken up because we weren't next in line for the lock.
-			// We need to inform the new owner.
-
-			DEBUG_MSG(0, ("wait_for_request: forcing a resignal of blockers\n"));
-			post_blockage(tdbb, request, lock);
-#ifdef DEV_BUILD
-			repost_counter++;
-			if (repost_counter % 50 == 0)
-			{
-				gds__log("wait_for_request: owner %d reposted %ld times for lock %d",
-						owner_offset,
-						repost_counter,
-						lock_offset);
-				DEBUG_MSG(0,
-						  ("wait_for_request: reposted %ld times for this lock!\n",
-						   repost_counter));
-			}
 #endif
-		}
 	}
 
 	CHECK(!(request->lrq_flags & LRQ_pending));
@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <sys/types.h>
+#include <atomic>
 
 #include "../common/classes/semaphore.h"
 #include "../common/classes/rwlock.h"
@@ -93,7 +94,7 @@ const UCHAR type_lpr	= 7;
 
 // Version number of the lock table.
 // Must be increased every time the shmem layout is changed.
-const USHORT BASE_LHB_VERSION = 18;
+const USHORT BASE_LHB_VERSION = 20;
 
 #if SIZEOF_VOID_P == 8
 const USHORT PLATFORM_LHB_VERSION = 128;	// 64-bit target
@@ -142,6 +143,8 @@ struct lhb : public Firebird::MemoryHeader
 	FB_UINT64 lhb_wakeups;
 	FB_UINT64 lhb_scans;
 	FB_UINT64 lhb_deadlocks;
+	FB_UINT64 lhb_scan_time;		// Time (us) the lock table was held by deadlock scans
+	FB_UINT64 lhb_walk_time;		// Time (us) spent walking wait-for graph snapshots
 	srq lhb_data[LCK_MAX_SERIES];
 	srq lhb_hash[1];			// Hash table
 };
@@ -242,7 +245,6 @@ struct own
 };
 
 // Flags in own_flags
-const USHORT OWN_scanned	= 1;	// Owner has been deadlock scanned
 const USHORT OWN_wakeup		= 2;	// Owner has been awoken
 const USHORT OWN_signaled	= 4;	// Signal is thought to be delivered
 
@@ -291,6 +293,7 @@ namespace Firebird {
 namespace Jrd {
 
 class thread_db;
+class WaitForGraph;
 
 class LockManager final : public Firebird::GlobalStorage, public Firebird::IpcObject
 {
@@ -424,7 +427,9 @@ private:
 	SRQ_PTR create_owner(Firebird::CheckStatusWrapper*, LOCK_OWNER_T, UCHAR);
 	bool create_process(Firebird::CheckStatusWrapper*);
 	void deadlock_clear();
-	lrq* deadlock_scan(own*, lrq*);
+	bool deadlock_detect();
+	void deadlock_snapshot(WaitForGraph&);
+	void deadlock_thread();
 	lrq* deadlock_walk(lrq*, bool*);
 	void debug_delay(ULONG);
 	lbl* find_lock(USHORT, const UCHAR*, USHORT, USHORT*);
@@ -467,6 +472,11 @@ private:
 		lockMgr->blocking_action_thread();
 	}
 
+	static void deadlock_thread(LockManager* lockMgr)
+	{
+		lockMgr->deadlock_thread();
+	}
+
 	bool initialize(Firebird::SharedMemoryBase* sm, bool init);
 	void mutexBug(int osErrorCode, const char* text);
 
@@ -481,6 +491,10 @@ private:
 	ThreadFinishSync<LockManager*> m_cleanupSync;
 	Firebird::Semaphore m_startupSemaphore;
 
+	ThreadFinishSync<LockManager*> m_deadlockSync;
+	Firebird::Semaphore m_deadlockSemaphore;
+	std::atomic<bool> m_deadlockShutdown;
+
 public:
 	Firebird::AutoPtr<Firebird::SharedMemory<lhb> > m_sharedMemory;
 
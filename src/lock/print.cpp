@@ -811,6 +811,10 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 			LOCK_header->lhb_scans, LOCK_header->lhb_deadlocks,
 			LOCK_header->lhb_scan_interval);
 
+	FPRINTF(outfile,
+			"\tDeadlock scan time (us): %9" UQUADFORMAT", Graph walk time (us): %9" UQUADFORMAT"\n",
+			LOCK_header->lhb_scan_time, LOCK_header->lhb_walk_time);
+
 	FPRINTF(outfile,
 			"\tAcquires: %6" UQUADFORMAT", Acquire blocks: %6" UQUADFORMAT
 			", Spin count: %3" ULONGFORMAT"\n",
@@ -1398,7 +1402,6 @@ static void prt_owner(OUTFILE outfile,
 	const USHORT flags = owner->own_flags;
 	FPRINTF(outfile, "\tFlags: 0x%02X ", flags);
 	FPRINTF(outfile, " %s", (flags & OWN_wakeup) ? "wake" : "    ");
-	FPRINTF(outfile, " %s", (flags & OWN_scanned) ? "scan" : "    ");
 	FPRINTF(outfile, " %s", (flags & OWN_signaled) ? "sgnl" : "    ");
 	FPRINTF(outfile, "\n");
 
@@ -1969,6 +1969,21 @@ ERROR: Backup incomplete', NULL, NULL);
 (NULL, 'get_pub_table', 'restore.epp', NULL, 12, 402, NULL, 'publication for table', NULL, NULL);
 ('gbak_opt_replica', 'burp_usage', 'burp.c', NULL, 12, 403, NULL, '    @1REPLICA <mode>      "none", "read_only" or "read_write" replica mode', NULL, NULL);
 ('gbak_replica_req', 'BURP_gbak', 'burp.c', NULL, 12, 404, NULL, '"none", "read_only" or "read_write" required', NULL, NULL);
+('gbak_opt_parallel', 'burp_usage', 'burp.c', NULL, 12, 405, NULL, '    @1PAR(ALLEL)           parallel workers', NULL, NULL);
+('gbak_missing_prl_wrks', 'BURP_gbak', 'burp.c', NULL, 12, 406, NULL, 'parallel workers parameter missing', NULL, NULL);
+('gbak_inv_prl_wrks', 'BURP_gbak', 'burp.c', NULL, 12, 407, NULL, 'expected parallel workers, encountered "@1"', NULL, NULL);
+(NULL, 'BackupRelationTask', 'BurpTasks.cpp', NULL, 12, 408, NULL, 'cannot start parallel worker', NULL, NULL);
+(NULL, 'BackupRelationTask', 'BurpTasks.cpp', NULL, 12, 409, NULL, 'error finishing parallel worker', NULL, NULL);
+(NULL, 'RestoreRelationTask', 'BurpTasks.cpp', NULL, 12, 410, NULL, 'worker @1: @2 records restored into table @3', NULL, NULL);
+(NULL, 'RestoreRelationTask', 'BurpTasks.cpp', NULL, 12, 411, NULL, 'worker @1: table @2 done, @3 records restored, @4 records per second', NULL, NULL);
+(NULL, 'RestoreRelationTask', 'BurpTasks.cpp', NULL, 12, 412, NULL, 'worker @1: activating indexes of table @2', NULL, NULL);
+(NULL, 'RestoreRelationTask', 'BurpTasks.cpp', NULL, 12, 413, NULL, 'could not start batch when restoring table @1', NULL, NULL);
+(NULL, 'restore', 'restore.epp', NULL, 12, 414, NULL, 'transportable backup -- data in binary format', NULL, NULL);
+(NULL, 'burp_usage', 'burp.cpp', NULL, 12, 415, NULL, '    @1ZSTD <level>         backup file is compressed by zstd with given level', NULL, NULL);
+(NULL, 'BURP_gbak', 'burp.cpp', NULL, 12, 416, NULL, 'zstd compression level parameter missing', NULL, NULL);
+(NULL, 'BURP_gbak', 'burp.cpp', NULL, 12, 417, NULL, 'expected zstd compression level, encountered "@1"', NULL, NULL);
+(NULL, 'start_block_zip', 'mvol.cpp', NULL, 12, 418, NULL, 'zstd compression level @1 is out of range 1 - @2', NULL, NULL);
+(NULL, 'BackupRelationTask', 'BurpTasks.cpp', NULL, 12, 419, NULL, 'snapshot number of the main transaction is not available, parallel workers are not used', NULL, NULL);
 -- SQLERR
 (NULL, NULL, NULL, NULL, 13, 1, NULL, 'Firebird error', NULL, NULL);
 (NULL, NULL, NULL, NULL, 13, 74, NULL, 'Rollback not performed', NULL, NULL);
@@ -2907,6 +2922,13 @@ Analyzing database pages ...', NULL, NULL);
 ('fbsvcmgr_limbo_state', 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 59, NULL, 'Unknown tag (@1) in isc_spb_tra_state block after isc_svc_query()', NULL, NULL);
 ('fbsvcmgr_limbo_advise', 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 60, NULL, 'Unknown tag (@1) in isc_spb_tra_advise block after isc_svc_query()', NULL, NULL);
 ('fbsvcmgr_bad_rm', 'putReplicaMode', 'fbsvcmgr.cpp', NULL, 22, 61, NULL, 'Wrong value for replica mode', NULL, NULL);
+(NULL, 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 62, NULL, 'Network server request queue', NULL, NULL);
+(NULL, 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 63, NULL, '   Requests served', NULL, NULL);
+(NULL, 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 64, NULL, '   Total queue time (us)', NULL, NULL);
+(NULL, 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 65, NULL, '   Total service time (us)', NULL, NULL);
+(NULL, 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 66, NULL, '   Requests pending', NULL, NULL);
+(NULL, 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 67, NULL, '   Requests active', NULL, NULL);
+(NULL, 'printInfo', 'fbsvcmgr.cpp', NULL, 22, 68, NULL, '   Peak worker threads', NULL, NULL);
 -- UTL (messages common for many utilities)
 -- All messages use the new format.
 ('utl_trusted_switch', 'checkService', 'UtilSvc.cpp', NULL, 23, 1, NULL, 'Switches trusted_user and trusted_role are not supported from command line', NULL, NULL);
@@ -2993,6 +3015,8 @@ Analyzing database pages ...', NULL, NULL);
 (NULL, 'usage', 'nbackup.cpp', NULL, 24, 79, NULL, '  -INPLACE option could corrupt the database that has changed since previous restore.', NULL, NULL)
 (NULL, 'usage', 'nbackup.cpp', NULL, 24, 80, NULL, '  -SEQ(UENCE)                            Preserve original replication sequence', NULL, NULL)
 ('nbackup_seq_misuse', 'nbackup', 'nbackup.cpp', NULL, 24, 81, NULL, 'Switch -SEQ(UENCE) can be used only with -FIXUP or -RESTORE', NULL, NULL)
+(NULL, 'usage', 'nbackup.cpp', NULL, 24, 82, NULL, '  -PAR(ALLEL) <n>                        Number of threads reading database and (de)compressing backup', NULL, NULL)
+(NULL, 'usage', 'nbackup.cpp', NULL, 24, 83, NULL, '  -ZSTD <level>                          Compress backup file by zstd with given level', NULL, NULL)
 -- FBTRACEMGR
 -- All messages use the new format.
 (NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, 1, NULL, 'Firebird Trace Manager version @1', NULL, NULL)
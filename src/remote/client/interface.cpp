@@ -853,6 +853,8 @@ public:
 	Replicator* replicator;
 
 private:
+	Statement* preparePipelined(CheckStatusWrapper* status, ITransaction* transaction,
+		unsigned int stmtLength, const char* sqlStmt, unsigned dialect);
 	void execWithCheck(CheckStatusWrapper* status, const string& stmt);
 	void freeClientData(CheckStatusWrapper* status, bool force = false);
 	SLONG getSingleInfo(CheckStatusWrapper* status, UCHAR infoItem);
@@ -1005,7 +1007,9 @@ extern "C" void FB_PLUGIN_ENTRY_POINT(IMaster* master)
 namespace Remote {
 
 static Rvnt* add_event(rem_port*);
+static void add_inline_blob(rem_port*, P_INLINE_BLOB*);
 static void add_other_params(rem_port*, ClumpletWriter&, const ParametersSet&);
+static void add_pending_blobs(rem_port*, Rsr*, const UCHAR*);
 static void add_working_directory(ClumpletWriter&, const PathName&);
 static rem_port* analyze(ClntAuthBlock& cBlock, PathName& attach_name, unsigned flags,
 	ClumpletWriter& pb, const ParametersSet& parSet, PathName& node_name, PathName* ref_db_name,
@@ -1014,6 +1018,9 @@ static void batch_gds_receive(rem_port*, struct rmtque *, USHORT);
 static void batch_dsql_fetch(rem_port*, struct rmtque *, USHORT);
 static void clear_queue(rem_port*);
 static void clear_stmt_que(rem_port*, Rsr*);
+static USHORT fetch_batch_size(rem_port*, Rsr*);
+static void fetch_batch_measured(Rsr*);
+static void fetch_blobs(Rdb*, Rtr*);
 static void disconnect(rem_port*);
 static void enqueue_receive(rem_port*, t_rmtque_fn, Rdb*, void*, Rrq::rrq_repeat*);
 static void dequeue_receive(rem_port*);
@@ -1024,12 +1031,15 @@ static void info(CheckStatusWrapper*, Rdb*, P_OP, USHORT, USHORT, USHORT,
 	const UCHAR*, USHORT, const UCHAR*, ULONG, UCHAR*);
 static void init(CheckStatusWrapper*, ClntAuthBlock&, rem_port*, P_OP, PathName&,
 	ClumpletWriter&, IntlParametersBlock&, ICryptKeyCallback* cryptCallback);
+static bool info_cached_blob(const Rbl*, unsigned int, const UCHAR*, unsigned int, UCHAR*);
 static Rtr* make_transaction(Rdb*, USHORT);
 static void mov_dsql_message(const UCHAR*, const rem_fmt*, UCHAR*, const rem_fmt*);
 static void move_error(const Arg::StatusVector& v);
 static void receive_after_start(Rrq*, USHORT);
 static void receive_packet(rem_port*, PACKET *);
 static void receive_packet_noqueue(rem_port*, PACKET *);
+static void open_cached_blob(CheckStatusWrapper*, Rbl*);
+static void pipeline_response(rem_port*, PACKET*, P_OP);
 static void receive_queued_packet(rem_port*, USHORT);
 static void receive_response(IStatus*, Rdb*, PACKET *);
 static void release_blob(Rbl*);
@@ -1208,6 +1218,14 @@ void Blob::getInfo(CheckStatusWrapper* status,
 		rem_port* port = rdb->rdb_port;
 		RefMutexGuard portGuard(*port->port_sync, FB_FUNCTION);
 
+		if (blob->rbl_flags & Rbl::CACHED)
+		{
+			if (info_cached_blob(blob, itemsLength, items, bufferLength, buffer))
+				return;
+
+			open_cached_blob(status, blob);
+		}
+
 		info(status, rdb, op_info_blob, blob->rbl_id, 0,
 			 itemsLength, items, 0, 0, bufferLength, buffer);
 	}
@@ -1246,7 +1264,8 @@ void Blob::freeClientData(CheckStatusWrapper* status, bool force)
 
 		try
 		{
-			release_object(status, rdb, op_cancel_blob, blob->rbl_id);
+			if (!(blob->rbl_flags & Rbl::CACHED))
+				release_object(status, rdb, op_cancel_blob, blob->rbl_id);
 		}
 		catch (const Exception&)
 		{
@@ -1308,7 +1327,8 @@ void Blob::close(CheckStatusWrapper* status)
 			send_blob(status, blob, 0, NULL);
 		}
 
-		release_object(status, rdb, op_close_blob, blob->rbl_id);
+		if (!(blob->rbl_flags & Rbl::CACHED))
+			release_object(status, rdb, op_close_blob, blob->rbl_id);
 		release_blob(blob);
 		blob = NULL;
 	}
@@ -3108,6 +3128,7 @@ ITransaction* Statement::execute(CheckStatusWrapper* status, ITransaction* apiTr
 		sqldata->p_sqldata_out_blr.cstr_address = const_cast<UCHAR*>(out_blr);
 		sqldata->p_sqldata_out_message_number = 0;	// out_msg_type
 		sqldata->p_sqldata_timeout = statement->rsr_timeout;
+		sqldata->p_sqldata_inline_blob_size = port->getPortConfig()->getMaxInlineBlobSize();
 
 		send_packet(port, packet);
 
@@ -3273,6 +3294,7 @@ ResultSet* Statement::openCursor(CheckStatusWrapper* status, Firebird::ITransact
 		sqldata->p_sqldata_out_blr.cstr_address = const_cast<UCHAR*>(out_blr);
 		sqldata->p_sqldata_out_message_number = 0;	// out_msg_type
 		sqldata->p_sqldata_timeout = statement->rsr_timeout;
+		sqldata->p_sqldata_inline_blob_size = port->getPortConfig()->getMaxInlineBlobSize();
 
 		send_partial_packet(port, packet);
 		defer_packet(port, packet, true);
@@ -3295,8 +3317,13 @@ IResultSet* Attachment::openCursor(CheckStatusWrapper* status, ITransaction* tra
 		IMessageMetadata* inMetadata, void* inBuffer, IMessageMetadata* outMetadata,
 		const char* cursorName, unsigned int cursorFlags)
 {
-	Statement* stmt = prepare(status, transaction, stmtLength, sqlStmt, dialect,
-		(outMetadata ? 0 : IStatement::PREPARE_PREFETCH_OUTPUT_PARAMETERS));
+	// With output format known in advance statement may be allocated, prepared
+	// and executed in one flight completed by the first fetch
+
+	Statement* stmt = outMetadata ?
+		preparePipelined(status, transaction, stmtLength, sqlStmt, dialect) :
+		prepare(status, transaction, stmtLength, sqlStmt, dialect,
+			IStatement::PREPARE_PREFETCH_OUTPUT_PARAMETERS);
 	if (status->getState() & Firebird::IStatus::STATE_ERRORS)
 	{
 		return NULL;
@@ -3547,7 +3574,10 @@ void Statement::freeClientData(CheckStatusWrapper* status, bool force)
 		free_stmt->p_sqlfree_statement = statement->rsr_id;
 		free_stmt->p_sqlfree_option = DSQL_drop;
 
-		if (rdb->rdb_port->port_flags & PORT_lazy)
+		// Pipelined statement, whose id is not known yet, is freed synchronously,
+		// so that deferred responses to its allocation are processed first
+
+		if ((rdb->rdb_port->port_flags & PORT_lazy) && !statement->rsr_flags.test(Rsr::PIPELINED))
 		{
 			send_packet(rdb->rdb_port, packet);
 			defer_packet(rdb->rdb_port, packet, true);
@@ -3794,6 +3824,112 @@ Statement* Attachment::prepare(CheckStatusWrapper* status, ITransaction* apiTra,
 }
 
 
+Statement* Attachment::preparePipelined(CheckStatusWrapper* status, ITransaction* apiTra,
+	unsigned int stmtLength, const char* sqlStmt, unsigned int dialect)
+{
+/**************************************
+ *
+ *	p r e p a r e P i p e l i n e d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Send allocate and prepare of a statement not waiting
+ *	for responses. Execute is deferred by openCursor too,
+ *	so the whole flight is completed by the first fetch
+ *	and the first error met is reported by it.
+ *	No info items are requested - statement is used
+ *	with output format supplied by the caller.
+ *
+ **************************************/
+
+	Statement* stmt = NULL;
+
+	try
+	{
+		reset(status);
+
+		// Check and validate handles, etc.
+
+		CHECK_HANDLE(rdb, isc_bad_db_handle);
+		rem_port* port = rdb->rdb_port;
+		RefMutexGuard portGuard(*port->port_sync, FB_FUNCTION);
+
+		// Only one statement may be referenced by INVALID_OBJECT at a time
+
+		if (port->port_protocol < PROTOCOL_PIPELINE || !(port->port_flags & PORT_lazy) ||
+			(port->port_pipe_statement && port->port_pipe_statement->rsr_flags.test(Rsr::PIPELINED)))
+		{
+			return prepare(status, apiTra, stmtLength, sqlStmt, dialect, 0);
+		}
+
+		Rtr* transaction = NULL;
+		if (apiTra)
+		{
+			transaction = remoteTransaction(apiTra);
+			CHECK_HANDLE(transaction, isc_bad_trans_handle);
+		}
+
+		if (sqlStmt && !stmtLength)
+			stmtLength = static_cast<ULONG>(strlen(sqlStmt));
+
+		// Validate string length
+
+		CHECK_LENGTH(port, stmtLength);
+
+		if (dialect > 10)
+			dialect /= 10;
+
+		stmt = createStatement(status, dialect);
+		Rsr* statement = stmt->getStatement();
+
+		clear_queue(port);
+		REMOTE_reset_statement(statement);
+
+		PACKET* packet = &rdb->rdb_packet;
+		packet->p_operation = op_allocate_statement;
+		packet->p_rlse.p_rlse_object = rdb->rdb_id;
+
+		send_partial_packet(port, packet);
+		defer_packet(port, packet, true);
+
+		statement->rsr_flags.clear(Rsr::LAZY | Rsr::DEFER_EXECUTE);
+		statement->rsr_flags.set(Rsr::PIPELINED);
+		port->port_pipe_statement = statement;
+
+		Array<UCHAR> items;
+		const ULONG bufferLength = StatementMetadata::buildInfoItems(items, 0);
+
+		packet->p_operation = op_prepare_statement;
+		P_SQLST* prepare = &packet->p_sqlst;
+		prepare->p_sqlst_transaction = transaction ? transaction->rtr_id : 0;
+		prepare->p_sqlst_statement = statement->rsr_id;
+		prepare->p_sqlst_SQL_dialect = dialect;
+		prepare->p_sqlst_SQL_str.cstr_length = stmtLength;
+		prepare->p_sqlst_SQL_str.cstr_address = reinterpret_cast<const UCHAR*>(sqlStmt);
+		prepare->p_sqlst_items.cstr_length = (ULONG) items.getCount();
+		prepare->p_sqlst_items.cstr_address = items.begin();
+		prepare->p_sqlst_buffer_length = bufferLength;
+
+		send_partial_packet(port, packet);
+		defer_packet(port, packet, true);
+
+		return stmt;
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(status);
+	}
+
+	// free statement in case of error
+	if (stmt)
+	{
+		stmt->release();
+	}
+	return NULL;
+}
+
+
 void Statement::getInfo(CheckStatusWrapper* status,
 						unsigned int itemsLength, const unsigned char* items,
 						unsigned int bufferLength, unsigned char* buffer)
@@ -4175,8 +4311,7 @@ int ResultSet::fetchNext(CheckStatusWrapper* status, void* buffer)
 			sqldata->p_sqldata_messages = 0;
 			if (statement->rsr_select_format)
 			{
-				sqldata->p_sqldata_messages =
-					REMOTE_compute_batch_size(port, 0, op_fetch_response, statement->rsr_select_format);
+				sqldata->p_sqldata_messages = fetch_batch_size(port, statement);
 
 				// Reorder data when the local buffer is half empty
 
@@ -4202,6 +4337,14 @@ int ResultSet::fetchNext(CheckStatusWrapper* status, void* buffer)
 
 			send_packet(port, packet);
 
+			// Measure the batch if there is no other one in the pipeline
+
+			if (!statement->rsr_batch_count)
+			{
+				statement->rsr_fetch_sent = fb_utils::query_performance_counter();
+				statement->rsr_fetch_received = 0;
+			}
+
 			statement->rsr_batch_count++;
 
 			// Queue up receipt of the pending data
@@ -4270,6 +4413,8 @@ int ResultSet::fetchNext(CheckStatusWrapper* status, void* buffer)
 			status_exception::raise(Arg::Gds(isc_port_len) <<
 				Arg::Num(msg_length) << Arg::Num(statement->rsr_user_select_format->fmt_length));
 		}
+		add_pending_blobs(port, statement, message->msg_address);
+
 		if (statement->rsr_user_select_format == statement->rsr_select_format)
 		{
 			if (!msg || !message->msg_address)
@@ -4935,6 +5080,47 @@ IBlob* Attachment::openBlob(CheckStatusWrapper* status, ITransaction* apiTra, IS
 
 		CHECK_LENGTH(port, bpb_length);
 
+		// Blob could be received together with the rows or requested in bulk
+		// with other fetched blobs. Its data is not converted, so BPB is not supported.
+
+		if (!bpb_length && port->port_protocol >= PROTOCOL_INLINE_BLOB)
+		{
+			AutoPtr<InlineBlob> cached(transaction->getInlineBlob(*id));
+
+			if (!cached && transaction->rtr_blobs_pending.exist(blobKey(*id)))
+			{
+				fetch_blobs(rdb, transaction);
+				cached = transaction->getInlineBlob(*id);
+			}
+
+			if (cached)
+			{
+				Rbl* blob = FB_NEW Rbl;
+				blob->rbl_rdb = rdb;
+				blob->rbl_rtr = transaction;
+				blob->rbl_blob_id = *id;
+				blob->rbl_flags = Rbl::CACHED | Rbl::EOF_PENDING;
+				blob->rbl_info.assign(cached->ibl_info);
+
+				const USHORT length = (USHORT) cached->ibl_data.getCount();
+				if (length > blob->rbl_buffer_length)
+				{
+					blob->rbl_buffer = blob->rbl_data.getBuffer(length);
+					blob->rbl_buffer_length = length;
+				}
+				memcpy(blob->rbl_buffer, cached->ibl_data.begin(), length);
+				blob->rbl_ptr = blob->rbl_buffer;
+				blob->rbl_length = length;
+
+				blob->rbl_next = transaction->rtr_blobs;
+				transaction->rtr_blobs = blob;
+
+				Firebird::IBlob* b = FB_NEW Blob(blob);
+				b->addRef();
+				return b;
+			}
+		}
+
 		PACKET* packet = &rdb->rdb_packet;
 		packet->p_operation = op_open_blob2;
 		P_BLOB* p_blob = &packet->p_blob;
@@ -5055,6 +5241,9 @@ void Blob::putSegment(CheckStatusWrapper* status, unsigned int segment_length, c
 
 		if (!(blob->rbl_flags & Rbl::CREATE))
 		{
+			if (blob->rbl_flags & Rbl::CACHED)
+				open_cached_blob(status, blob);
+
 			send_blob(status, blob, segment_length, segmentPtr);
 			fb_assert(false);
 		}
@@ -5737,6 +5926,9 @@ int Blob::seek(CheckStatusWrapper* status, int mode, int offset)
 		rem_port* port = rdb->rdb_port;
 		RefMutexGuard portGuard(*port->port_sync, FB_FUNCTION);
 
+		if (blob->rbl_flags & Rbl::CACHED)
+			open_cached_blob(status, blob);
+
 		PACKET* packet = &rdb->rdb_packet;
 		packet->p_operation = op_seek_blob;
 		P_SEEK* seek = &packet->p_seek;
@@ -6492,6 +6684,37 @@ static Rvnt* add_event( rem_port* port)
 }
 
 
+static void add_inline_blob(rem_port* port, P_INLINE_BLOB* packet)
+{
+/**************************************
+ *
+ *	a d d _ i n l i n e _ b l o b
+ *
+ **************************************
+ *
+ * Functional description
+ *	Save blob sent by server ahead of the row
+ *	referencing it in the transaction cache.
+ *
+ **************************************/
+	Rdb* rdb = port->port_context;
+
+	Rtr* transaction = rdb ? rdb->rdb_transactions : NULL;
+	while (transaction && transaction->rtr_id != packet->p_tran_id)
+		transaction = transaction->rtr_next;
+
+	// Transaction could be already released, or data does not fit into blob buffer
+	if (!transaction || packet->p_blob_data.cstr_length > MAX_USHORT)
+		return;
+
+	InlineBlob* blob = FB_NEW InlineBlob(packet->p_blob_id);
+	blob->ibl_info.assign(packet->p_blob_info.cstr_address, packet->p_blob_info.cstr_length);
+	blob->ibl_data.assign(packet->p_blob_data.cstr_address, packet->p_blob_data.cstr_length);
+
+	transaction->addInlineBlob(blob);
+}
+
+
 static void add_other_params(rem_port* port, ClumpletWriter& dpb, const ParametersSet& par)
 {
 /**************************************
@@ -6541,6 +6764,55 @@ static void add_other_params(rem_port* port, ClumpletWriter& dpb, const Paramete
 }
 
 
+static void add_pending_blobs(rem_port* port, Rsr* statement, const UCHAR* msg)
+{
+/**************************************
+ *
+ *	a d d _ p e n d i n g _ b l o b s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Remember blobs referenced by the fetched row
+ *	which were not sent inline, to request them in
+ *	bulk when one of them is opened.
+ *
+ **************************************/
+	const rem_fmt* const format = statement->rsr_select_format;
+	Rtr* const transaction = statement->rsr_rtr;
+
+	if (port->port_protocol < PROTOCOL_INLINE_BLOB || !format || !transaction || !msg ||
+		!transaction->rtr_fetch_blobs || !port->getPortConfig()->getMaxInlineBlobSize())
+	{
+		return;
+	}
+
+	const FB_SIZE_T count = format->fmt_desc.getCount();
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		const dsc& desc = format->fmt_desc[i];
+		if (desc.dsc_dtype != dtype_blob && desc.dsc_dtype != dtype_quad)
+			continue;
+
+		// Each field is followed by its null indicator
+
+		if (i + 1 < count && format->fmt_desc[i + 1].dsc_dtype == dtype_short)
+		{
+			SSHORT null_flag;
+			memcpy(&null_flag, msg + (IPTR) format->fmt_desc[i + 1].dsc_address, sizeof(SSHORT));
+			if (null_flag)
+				continue;
+		}
+
+		ISC_QUAD id;
+		memcpy(&id, msg + (IPTR) desc.dsc_address, sizeof(ISC_QUAD));
+		if (id.gds_quad_high || id.gds_quad_low)
+			transaction->addPendingBlob(id);
+	}
+}
+
+
 static void add_working_directory(ClumpletWriter& dpb, const PathName& node_name)
 {
 /************************************************
@@ -6821,6 +7093,150 @@ static void clear_stmt_que(rem_port* port, Rsr* statement)
 	}
 }
 
+static USHORT fetch_batch_size(rem_port* port, Rsr* statement)
+{
+/**************************************
+ *
+ *	f e t c h _ b a t c h _ s i z e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compute number of rows to ask the server for.
+ *	Start with the packet based estimation and grow
+ *	up to the size measured by fetch_batch_measured()
+ *	while the rows fit into the client fetch buffer.
+ *	Never go below the packet based estimation.
+ *
+ **************************************/
+	const rem_fmt* const format = statement->rsr_select_format;
+
+	const USHORT estimate = REMOTE_compute_batch_size(port, 0, op_fetch_response, format);
+
+	// Other servers cut batches by packets count anyway
+	if (port->port_protocol < PROTOCOL_FETCH_BUDGET)
+		return estimate;
+
+	const ULONG budget = port->getPortConfig()->getClientFetchBuffer() / MAX(format->fmt_length, 1);
+
+	// Fetch buffer limits the growth only, not the packet based estimation
+	ULONG result = MIN(statement->rsr_fetch_rows, budget);
+	result = MAX(result, estimate);
+	result = MIN(result, MAX_USHORT);
+
+	return static_cast<USHORT>(result);
+}
+
+
+static void fetch_batch_measured(Rsr* statement)
+{
+/**************************************
+ *
+ *	f e t c h _ b a t c h _ m e a s u r e d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Measured batch is received completely. Compute
+ *	how many rows could be transferred while waiting
+ *	for the first row of the next batch and make
+ *	next batches large enough to hide that latency.
+ *
+ **************************************/
+	if (!statement->rsr_fetch_sent)
+		return;
+
+	const SINT64 sent = statement->rsr_fetch_sent;
+	statement->rsr_fetch_sent = 0;
+
+	const ULONG received = statement->rsr_fetch_received;
+
+	// Too few rows to estimate throughput
+	if (received < MIN_ROWS_PER_BATCH)
+		return;
+
+	const SINT64 latency = statement->rsr_fetch_first - sent;
+	const SINT64 transfer = MAX(fb_utils::query_performance_counter() - statement->rsr_fetch_first, 1);
+
+	// Rows in flight, doubled to let the next batch be requested
+	// when half of the current one is consumed
+
+	FB_UINT64 rows = 2 * (FB_UINT64) received * latency / transfer;
+
+	// Grow no faster than twice per batch
+	rows = MIN(rows, 2 * received);
+
+	statement->rsr_fetch_rows = static_cast<USHORT>(MIN(rows, MAX_USHORT));
+}
+
+
+static void fetch_blobs(Rdb* rdb, Rtr* transaction)
+{
+/**************************************
+ *
+ *	f e t c h _ b l o b s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Request all fetched blobs not received inline
+ *	in one round trip. Server sends ones small
+ *	enough as op_inline_blob packets before the
+ *	response, they are cached by the transaction.
+ *
+ **************************************/
+	rem_port* port = rdb->rdb_port;
+
+	HalfStaticArray<UCHAR, 16 * sizeof(ISC_QUAD)> ids;
+	UCHAR* p = ids.getBuffer(transaction->rtr_blobs_pending.getCount() * 2 * sizeof(SLONG));
+
+	for (const FB_UINT64* key = transaction->rtr_blobs_pending.begin();
+		key != transaction->rtr_blobs_pending.end(); ++key)
+	{
+		const ISC_QUAD id = blobId(*key);
+		const ULONG values[2] = {(ULONG) id.gds_quad_high, id.gds_quad_low};
+
+		for (int i = 0; i < 2; i++)
+		{
+			for (unsigned shift = 0; shift < 32; shift += 8)
+				*p++ = (UCHAR) (values[i] >> shift);
+		}
+	}
+
+	transaction->rtr_blobs_pending.clear();
+	const FB_SIZE_T cached = transaction->rtr_inline_blobs.getCount();
+
+	PACKET* packet = &rdb->rdb_packet;
+	packet->p_operation = op_fetch_blobs;
+	P_FETCH_BLOBS* fetch = &packet->p_fblb;
+	fetch->p_fblb_transaction = transaction->rtr_id;
+	fetch->p_fblb_max_size = port->getPortConfig()->getMaxInlineBlobSize();
+	fetch->p_fblb_ids.cstr_length = ids.getCount();
+	fetch->p_fblb_ids.cstr_address = ids.begin();
+
+	send_packet(port, packet);
+	receive_packet(port, packet);
+
+	fetch->p_fblb_ids.cstr_length = 0;
+	fetch->p_fblb_ids.cstr_address = NULL;
+
+	// Blobs are too big to be sent inline, don't waste round trips anymore
+	if (transaction->rtr_inline_blobs.getCount() <= cached)
+		transaction->rtr_fetch_blobs = false;
+
+	// Errors are reported when the blob is opened in a regular way
+
+	try
+	{
+		LocalStatus ls;
+		CheckStatusWrapper status(&ls);
+		REMOTE_check_response(&status, rdb, packet);
+	}
+	catch (const Exception&)
+	{ }
+}
+
+
 static void batch_dsql_fetch(rem_port*	port,
 							 rmtque*	que_inst,
 							 USHORT		id)
@@ -6946,6 +7362,8 @@ static void batch_dsql_fetch(rem_port*	port,
 			}
 			dequeue_receive(port);
 
+			fetch_batch_measured(statement);
+
 			// clear next queued batch(es) if present
 			if (packet->p_sqldata.p_sqldata_status == 100)
 			{
@@ -6957,6 +7375,9 @@ static void batch_dsql_fetch(rem_port*	port,
 			}
 			break;
 		}
+		if (statement->rsr_fetch_sent && !statement->rsr_fetch_received++)
+			statement->rsr_fetch_first = fb_utils::query_performance_counter();
+
 		statement->rsr_msgs_waiting++;
 		statement->rsr_rows_pending--;
 #ifdef DEBUG
@@ -7535,7 +7956,7 @@ static void authReceiveResponse(bool havePacket, ClntAuthBlock& cBlock, rem_port
 				n->cstr_length, n->cstr_address, n->cstr_address ? n->cstr_address[0] : 0));
 			if (packet->p_acpd.p_acpt_type & pflag_compress)
 			{
-				port->initCompression();
+				port->initCompression(packet->p_acpd.p_acpt_type);
 				port->port_flags |= PORT_compressed;
 			}
 			packet->p_acpd.p_acpt_type &= ptype_MASK;
@@ -7667,6 +8088,60 @@ static void init(CheckStatusWrapper* status, ClntAuthBlock& cBlock, rem_port* po
 }
 
 
+static bool info_cached_blob(const Rbl* blob, unsigned int item_length, const UCHAR* items,
+	unsigned int buffer_length, UCHAR* buffer)
+{
+/**************************************
+ *
+ *	i n f o _ c a c h e d _ b l o b
+ *
+ **************************************
+ *
+ * Functional description
+ *	Answer blob info request using the info received
+ *	with the cached blob. Return false if some item
+ *	is not known locally.
+ *
+ **************************************/
+	const UCHAR* const info_end = blob->rbl_info.end();
+	UCHAR* p = buffer;
+	const UCHAR* const end = buffer + buffer_length;
+
+	for (const UCHAR* const items_end = items + item_length; items < items_end; items++)
+	{
+		if (*items == isc_info_end)
+			break;
+
+		const UCHAR* clump = blob->rbl_info.begin();
+		while (clump + 3 <= info_end && *clump != *items && *clump != isc_info_end)
+			clump += 3 + gds__vax_integer(clump + 1, 2);
+
+		if (clump + 3 > info_end || *clump != *items)
+			return false;
+
+		const FB_SIZE_T length = 3 + gds__vax_integer(clump + 1, 2);
+
+		if (clump + length > info_end)
+			return false;
+
+		if (p + length >= end)
+		{
+			if (p < end)
+				*p = isc_info_truncated;
+			return true;
+		}
+
+		memcpy(p, clump, length);
+		p += length;
+	}
+
+	if (p < end)
+		*p = isc_info_end;
+
+	return true;
+}
+
+
 static Rtr* make_transaction( Rdb* rdb, USHORT id)
 {
 /**************************************
@@ -7751,6 +8226,88 @@ static void move_error(const Arg::StatusVector& v)
 }
 
 
+static void open_cached_blob(CheckStatusWrapper* status, Rbl* blob)
+{
+/**************************************
+ *
+ *	o p e n _ c a c h e d _ b l o b
+ *
+ **************************************
+ *
+ * Functional description
+ *	Open blob received inline at server when
+ *	its data is not enough to serve the call.
+ *	Buffered data is still returned locally.
+ *
+ **************************************/
+	Rdb* rdb = blob->rbl_rdb;
+
+	PACKET* packet = &rdb->rdb_packet;
+	packet->p_operation = op_open_blob2;
+	P_BLOB* p_blob = &packet->p_blob;
+	p_blob->p_blob_transaction = blob->rbl_rtr->rtr_id;
+	p_blob->p_blob_id = blob->rbl_blob_id;
+	p_blob->p_blob_bpb.cstr_length = 0;
+	p_blob->p_blob_bpb.cstr_address = NULL;
+
+	send_and_receive(status, rdb, packet);
+
+	blob->rbl_id = packet->p_resp.p_resp_object;
+	SET_OBJECT(rdb, blob, blob->rbl_id);
+	blob->rbl_flags &= ~Rbl::CACHED;
+}
+
+
+static void pipeline_response(rem_port* port, PACKET* packet, P_OP operation)
+{
+/**************************************
+ *
+ *	p i p e l i n e _ r e s p o n s e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Handle deferred response to allocate or prepare
+ *	sent in one flight with execute of the statement.
+ *	The first error is saved within the statement and
+ *	reported by fetch, the following ones are dropped.
+ *
+ **************************************/
+	Rsr* statement = port->port_pipe_statement;
+	if (!statement)
+		return;
+
+	Rdb* rdb = port->port_context;
+
+	try
+	{
+		LocalStatus ls;
+		CheckStatusWrapper status(&ls);
+		REMOTE_check_response(&status, rdb, packet);
+		statement->saveException(&status, false);
+	}
+	catch (const Exception& ex)
+	{
+		statement->saveException(ex, false);
+
+		if (operation == op_allocate_statement)
+		{
+			// nothing was allocated at server, statement may be released locally
+			statement->rsr_flags.clear(Rsr::PIPELINED);
+			statement->rsr_flags.set(Rsr::LAZY);
+		}
+		return;
+	}
+
+	if (operation == op_allocate_statement)
+	{
+		statement->rsr_id = packet->p_resp.p_resp_object;
+		SET_OBJECT(rdb, statement, statement->rsr_id);
+		statement->rsr_flags.clear(Rsr::PIPELINED);
+	}
+}
+
+
 static void receive_after_start(Rrq* request, USHORT msg_type)
 {
 /*****************************************
@@ -7918,6 +8475,11 @@ static void receive_packet_with_callback(rem_port* port, PACKET* packet)
 				port->send(packet);
 			}
 			break;
+
+		case op_inline_blob:
+			add_inline_blob(port, &packet->p_inline_blob);
+			break;
+
 		default:
 			return;
 		}
@@ -7963,13 +8525,14 @@ static void receive_packet_noqueue(rem_port* port, PACKET* packet)
 
 			OBJCT stmt_id = 0;
 			bool bCheckResponse = false, bFreeStmt = false;
+			const P_OP operation = p->packet.p_operation;
 
-			if (p->packet.p_operation == op_execute)
+			if (operation == op_execute)
 			{
 				stmt_id = p->packet.p_sqldata.p_sqldata_statement;
 				bCheckResponse = true;
 			}
-			else if (p->packet.p_operation == op_free_statement)
+			else if (operation == op_free_statement)
 			{
 				stmt_id = p->packet.p_sqlfree.p_sqlfree_statement;
 				bFreeStmt = (p->packet.p_sqlfree.p_sqlfree_option == DSQL_drop);
@@ -7977,9 +8540,15 @@ static void receive_packet_noqueue(rem_port* port, PACKET* packet)
 
 			receive_packet_with_callback(port, &p->packet);
 
+			if (operation == op_allocate_statement || operation == op_prepare_statement)
+				pipeline_response(port, &p->packet, operation);
+
 			Rsr* statement = NULL;
 			if (bCheckResponse || bFreeStmt)
-				statement = port->port_objects[stmt_id];
+			{
+				statement = (stmt_id == INVALID_OBJECT) ? port->port_pipe_statement :
+					static_cast<Rsr*>(port->port_objects[stmt_id]);
+			}
 
 			if (bCheckResponse)
 			{
@@ -8142,7 +8711,8 @@ static void release_blob( Rbl* blob)
  **************************************/
 	Rtr* transaction = blob->rbl_rtr;
 	Rdb* rdb = blob->rbl_rdb;
-	rdb->rdb_port->releaseObject(blob->rbl_id);
+	if (!(blob->rbl_flags & Rbl::CACHED))
+		rdb->rdb_port->releaseObject(blob->rbl_id);
 
 	for (Rbl** p = &transaction->rtr_blobs; *p; p = &(*p)->rbl_next)
 	{
@@ -8281,6 +8851,9 @@ static void release_sql_request( Rsr* statement)
 	Rdb* rdb = statement->rsr_rdb;
 	rdb->rdb_port->releaseObject(statement->rsr_id);
 
+	if (rdb->rdb_port->port_pipe_statement == statement)
+		rdb->rdb_port->port_pipe_statement = NULL;
+
 	for (Rsr** p = &rdb->rdb_sql_requests; *p; p = &(*p)->rsr_next)
 	{
 		if (*p == statement)
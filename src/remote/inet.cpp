@@ -95,6 +95,11 @@
 #include <sys/select.h>
 #endif
 
+#if defined(HAVE_POLL) && defined(HAVE_SYS_EPOLL_H) && defined(HAVE_EPOLL_CREATE1)
+#include <sys/epoll.h>
+#define USE_EPOLL
+#endif
+
 #endif // !WIN_NT
 
 const int INET_RETRY_CALL = 5;
@@ -249,16 +254,71 @@ private:
 	}
 #endif
 
+#ifdef USE_EPOLL
+	// Multiplexed mode: a port is added to the epoll set once its socket is
+	// connected and removed when it's disconnected or closed. Ready sockets
+	// are mapped back to the ports, so a wakeup costs by number of ready
+	// sockets rather than by number of connections. Everything but the wait
+	// itself is done under port_mutex.
+
+	struct EpollPort
+	{
+		int fd;
+		rem_port* port;
+
+		static int generate(const EpollPort& item) { return item.fd; }
+	};
+
+	void epollForget(FB_SIZE_T pos)
+	{
+		// Ignore errors - the socket could be closed already,
+		// closing removes it from the epoll set
+		epoll_ctl(slct_epoll, EPOLL_CTL_DEL, slct_epoll_ports[pos].fd, NULL);
+		slct_epoll_ports.remove(pos);
+	}
+
+	void epollSelect(timeval* timeout)
+	{
+		epoll_event* const events = slct_epoll_events.getBuffer(MAX_EPOLL_EVENTS);
+
+		const int milliseconds = timeout ? timeout->tv_sec * 1000 + timeout->tv_usec / 1000 : -1;
+		slct_count = epoll_wait(slct_epoll, events, MAX_EPOLL_EVENTS, milliseconds);
+
+		slct_epoll_next = 0;
+		slct_epoll_count = MAX(slct_count, 0);
+	}
+
+	static const int MAX_EPOLL_EVENTS = 1024;
+#endif
+
 public:
 #ifdef HAVE_POLL
 	Select()
 		: slct_time(0), slct_count(0), slct_poll(*getDefaultMemoryPool()),
 		  slct_ready(*getDefaultMemoryPool())
+#ifdef USE_EPOLL
+		  , slct_multiplex(false), slct_epoll(-1), slct_epoll_ports(*getDefaultMemoryPool()),
+		  slct_epoll_ready(*getDefaultMemoryPool()), slct_epoll_due(*getDefaultMemoryPool()),
+		  slct_epoll_events(*getDefaultMemoryPool()), slct_epoll_count(0), slct_epoll_next(0)
+#endif
 	{ }
 
-	explicit Select(Firebird::MemoryPool& pool)
+	explicit Select(Firebird::MemoryPool& pool, bool multiplex = false)
 		: slct_time(0), slct_count(0), slct_poll(pool), slct_ready(pool)
+#ifdef USE_EPOLL
+		  , slct_multiplex(multiplex), slct_epoll(-1), slct_epoll_ports(pool),
+		  slct_epoll_ready(pool), slct_epoll_due(pool), slct_epoll_events(pool),
+		  slct_epoll_count(0), slct_epoll_next(0)
+#endif
 	{ }
+
+#ifdef USE_EPOLL
+	~Select()
+	{
+		if (slct_epoll >= 0)
+			close(slct_epoll);
+	}
+#endif
 #else
 	Select()
 		: slct_time(0), slct_count(0), slct_width(0)
@@ -266,7 +326,7 @@ public:
 		memset(&slct_fdset, 0, sizeof slct_fdset);
 	}
 
-	explicit Select(Firebird::MemoryPool& /*pool*/)
+	explicit Select(Firebird::MemoryPool& /*pool*/, bool /*multiplex*/ = false)
 		: slct_time(0), slct_count(0), slct_width(0)
 	{
 		memset(&slct_fdset, 0, sizeof slct_fdset);
@@ -304,6 +364,11 @@ public:
 		}
 #endif
 
+#ifdef USE_EPOLL
+		if (slct_multiplex)
+			return epollNext(port);
+#endif
+
 		if (slct_port && slct_port->port_state == rem_port::DISCONNECTED)
 		{
 			// restart from main port
@@ -430,9 +495,111 @@ public:
 #endif
 	}
 
+	// Multiplexed select watches the port from now on
+	void add(rem_port* port)
+	{
+#ifdef USE_EPOLL
+		if (!slct_multiplex)
+			return;
+
+		const int fd = port->port_handle;
+
+		FB_SIZE_T pos;
+		if (slct_epoll_ports.find(fd, pos))
+		{
+			if (slct_epoll_ports[pos].port == port)
+				return;
+
+			// Socket was closed without removal and its number is reused
+			epollForget(pos);
+		}
+
+		if (slct_epoll < 0)
+		{
+			slct_epoll = epoll_create1(EPOLL_CLOEXEC);
+			if (slct_epoll < 0)
+				system_error::raise("epoll_create1");
+		}
+
+		EpollPort item;
+		item.fd = fd;
+		item.port = port;
+		slct_epoll_ports.add(item);
+
+		epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+
+		if (epoll_ctl(slct_epoll, EPOLL_CTL_ADD, fd, &ev) != 0 &&
+			(errno != EEXIST || epoll_ctl(slct_epoll, EPOLL_CTL_MOD, fd, &ev) != 0))
+		{
+			// Report a bad socket as ready, receive() will break its connection
+			slct_epoll_ready.push(fd);
+		}
+#endif
+	}
+
+	// Port is going to be closed, stop watching it
+	void remove(rem_port* port)
+	{
+#ifdef USE_EPOLL
+		FB_SIZE_T pos;
+		if (slct_multiplex && slct_epoll_ports.find(port->port_handle, pos) &&
+			slct_epoll_ports[pos].port == port)
+		{
+			epollForget(pos);
+		}
+#endif
+	}
+
+	// Port's keepalive timer is expired, report it with no wait
+	void due(rem_port* port)
+	{
+#ifdef USE_EPOLL
+		slct_epoll_due.push(port->port_handle);
+#endif
+	}
+
+	// Ports are added and removed explicitly rather than set() every time
+	bool isPersistent() const
+	{
+#ifdef USE_EPOLL
+		return slct_multiplex;
+#else
+		return false;
+#endif
+	}
+
+	bool hasPorts() const
+	{
+#ifdef USE_EPOLL
+		return slct_epoll_ports.hasData();
+#else
+		return false;
+#endif
+	}
+
+	// Some ports are known to be ready with no wait
+	bool hasPending() const
+	{
+#ifdef USE_EPOLL
+		return slct_epoll_ready.hasData() || slct_epoll_due.hasData();
+#else
+		return false;
+#endif
+	}
+
 	void select(timeval* timeout)
 	{
 #ifdef HAVE_POLL
+#ifdef USE_EPOLL
+		if (slct_multiplex)
+		{
+			epollSelect(timeout);
+			return;
+		}
+#endif
 		slct_ready.clear();
 		bool hasRequest = false;
 		pollfd* const end = slct_poll.end();
@@ -479,6 +646,38 @@ public:
 	time_t	slct_time;
 
 private:
+#ifdef USE_EPOLL
+	HandleState epollNext(RemPortPtr& port)
+	{
+		while (slct_epoll_ready.hasData() || slct_epoll_next < slct_epoll_count ||
+			slct_epoll_due.hasData())
+		{
+			const bool ready = slct_epoll_ready.hasData() || slct_epoll_next < slct_epoll_count;
+			const int fd = slct_epoll_ready.hasData() ? slct_epoll_ready.pop() :
+				ready ? slct_epoll_events[slct_epoll_next++].data.fd : slct_epoll_due.pop();
+
+			FB_SIZE_T pos;
+			if (!slct_epoll_ports.find(fd, pos))
+				continue;		// removed after epoll_wait() reported it
+
+			rem_port* const p = slct_epoll_ports[pos].port;
+
+			if (p->port_state != rem_port::PENDING)
+			{
+				// Port is going to be disconnected, stop watching it
+				epollForget(pos);
+				continue;
+			}
+
+			port = p;
+			return ready ? SEL_READY : SEL_NO_DATA;
+		}
+
+		port = nullptr;
+		return SEL_NO_DATA;
+	}
+#endif
+
 	int		slct_count;
 #ifdef HAVE_POLL
 	class PollToFD
@@ -490,6 +689,16 @@ private:
 
 	SortedArray<pollfd, InlineStorage<pollfd, 8>, int, PollToFD>  slct_poll;
 	SortedArray<pollfd*, InlineStorage<pollfd*, 8>, int, PollToFD>  slct_ready;
+#ifdef USE_EPOLL
+	bool	slct_multiplex;		// use epoll instead of poll()
+	int		slct_epoll;			// epoll descriptor, created on demand
+	SortedArray<EpollPort, EmptyStorage<EpollPort>, int, EpollPort>  slct_epoll_ports;	// registered ports
+	HalfStaticArray<int, 8>  slct_epoll_ready;		// bad sockets, reported as ready
+	HalfStaticArray<int, 8>  slct_epoll_due;		// sockets with expired keepalive timer
+	HalfStaticArray<epoll_event, 8>  slct_epoll_events;	// returned by epoll_wait()
+	int		slct_epoll_count;	// number of events returned
+	int		slct_epoll_next;	// next event to report
+#endif
 #else
 	int		slct_width;
 	fd_set	slct_fdset;
@@ -568,6 +777,9 @@ static rem_port*		select_accept(rem_port*);
 static void		select_port(rem_port*, Select*, RemPortPtr&);
 static bool		select_multi(rem_port*, UCHAR* buffer, SSHORT bufsize, SSHORT* length, RemPortPtr&);
 static bool		select_wait(rem_port*, Select*);
+#ifdef USE_EPOLL
+static bool		select_wait_persistent(rem_port*, Select*);
+#endif
 static int		send_full(rem_port*, PACKET *);
 static int		send_partial(rem_port*, PACKET *);
 
@@ -617,7 +829,16 @@ ULONG INET_remote_buffer;
 static GlobalPtr<Mutex> init_mutex;
 static volatile bool INET_initialized = false;
 static volatile bool INET_shutting_down = false;
-static Firebird::GlobalPtr<Select> INET_select;
+// Select used by the multi-client listener
+class MultiplexSelect : public Select
+{
+public:
+	explicit MultiplexSelect(MemoryPool& pool)
+		: Select(pool, true)
+	{ }
+};
+
+static Firebird::GlobalPtr<MultiplexSelect> INET_select;
 static rem_port* inet_async_receive = NULL;
 
 
@@ -698,6 +919,9 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 	// Should compression be tried?
 
 	bool compression = config && (*config)->getWireCompression();
+	const bool zstd = compression &&
+		fb_utils::stricmp((*config)->getWireCompressionMethod(), "zstd") == 0 &&
+		rem_port::checkCompression(pflag_compress | pflag_compress_zstd);
 
 	// Establish connection to server
 	// If we want user verification, we can't speak anything less than version 7
@@ -715,7 +939,10 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 		REMOTE_PROTOCOL(PROTOCOL_VERSION13, ptype_lazy_send, 4),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION14, ptype_lazy_send, 5),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION15, ptype_lazy_send, 6),
-		REMOTE_PROTOCOL(PROTOCOL_VERSION16, ptype_lazy_send, 7)
+		REMOTE_PROTOCOL(PROTOCOL_VERSION16, ptype_lazy_send, 7),
+		REMOTE_PROTOCOL(PROTOCOL_INLINE_BLOB, ptype_lazy_send, 8),
+		REMOTE_PROTOCOL(PROTOCOL_PIPELINE, ptype_lazy_send, 9),
+		REMOTE_PROTOCOL(PROTOCOL_FETCH_BUDGET, ptype_lazy_send, 10)
 	};
 	fb_assert(FB_NELEM(protocols_to_try) <= FB_NELEM(cnct->p_cnct_versions));
 	cnct->p_cnct_count = FB_NELEM(protocols_to_try);
@@ -726,6 +953,8 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 			rem_port::checkCompression())
 		{
 			cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_compress;
+			if (zstd)
+				cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_compress_zstd;
 		}
 	}
 
@@ -837,7 +1066,7 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 		port->port_flags |= PORT_symmetric;
 	}
 
-	bool compress = accept->p_acpt_type & pflag_compress;
+	const USHORT compress = accept->p_acpt_type & (pflag_compress | pflag_compress_zstd);
 	accept->p_acpt_type &= ptype_MASK;
 
 	if (accept->p_acpt_type != ptype_out_of_band) {
@@ -848,9 +1077,9 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 		port->port_flags |= PORT_lazy;
 	}
 
-	if (compress)
+	if (compress & pflag_compress)
 	{
-		port->initCompression();
+		port->initCompression(compress);
 		port->port_flags |= PORT_compressed;
 	}
 
@@ -1538,6 +1767,12 @@ static rem_port* aux_connect(rem_port* port, PACKET* packet)
 		port->port_handle = n;
 		port->port_flags |= PORT_async;
 
+		if (port->port_parent)
+		{
+			MutexLockGuard guard(port_mutex, FB_FUNCTION);
+			INET_select->add(port);
+		}
+
 		get_peer_info(port);
 
 		return port;
@@ -1795,6 +2030,7 @@ static void disconnect(rem_port* port)
 	port->unlinkParent();
 
 	inet_ports->unRegisterPort(port);
+	INET_select->remove(port);
 
 	if (delayClose)
 	{
@@ -1854,6 +2090,9 @@ static void force_close(rem_port* port)
 	if (port->port_handle != INVALID_SOCKET)
 	{
 		shutdown(port->port_handle, 2);
+
+		MutexLockGuard guard(port_mutex, FB_FUNCTION);
+		INET_select->remove(port);
 		SOCLOSE(port->port_handle);
 	}
 }
@@ -2102,6 +2341,9 @@ static bool select_multi(rem_port* main_port, UCHAR* buffer, SSHORT bufsize, SSH
 					main_port->port_state = rem_port::BROKEN;
 
 					shutdown(main_port->port_handle, 2);
+
+					MutexLockGuard guard(port_mutex, FB_FUNCTION);
+					INET_select->remove(main_port);
 					SOCLOSE(main_port->port_handle);
 				}
 			}
@@ -2185,6 +2427,9 @@ static rem_port* select_accept( rem_port* main_port)
 		return port;
 	}
 
+	MutexLockGuard guard(port_mutex, FB_FUNCTION);
+	INET_select->add(port);
+
 	return 0;
 }
 
@@ -2252,6 +2497,11 @@ static bool select_wait( rem_port* main_port, Select* selct)
  *	to read from them.
  *
  **************************************/
+#ifdef USE_EPOLL
+	if (selct->isPersistent())
+		return select_wait_persistent(main_port, selct);
+#endif
+
 	struct timeval timeout;
 	bool checkPorts = false;
 
@@ -2407,6 +2657,109 @@ static bool select_wait( rem_port* main_port, Select* selct)
 	}
 }
 
+#ifdef USE_EPOLL
+static bool select_wait_persistent(rem_port* main_port, Select* selct)
+{
+/**************************************
+ *
+ *	s e l e c t _ w a i t _ p e r s i s t e n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Wait for something to read from the ports
+ *	registered in the multiplexed select. Unlike
+ *	select_wait() ports are not walked on every
+ *	wakeup, keepalive timers are adjusted once
+ *	a second.
+ *
+ **************************************/
+	selct->clear();
+
+	const time_t now = time(NULL);
+	const time_t delta_time = selct->slct_time ? now - selct->slct_time : 0;
+	selct->slct_time = now;
+
+	{ // port_mutex scope
+		MutexLockGuard guard(port_mutex, FB_FUNCTION);
+
+		while (ports_to_close->hasData())
+		{
+			SOCKET s = ports_to_close->pop();
+			SOCLOSE(s);
+		}
+
+		// if process is shuting down - don't listen on main port
+		if (INET_shutting_down)
+			selct->remove(main_port);
+		else if (main_port->port_state == rem_port::PENDING)
+			selct->add(main_port);
+
+		if (delta_time)
+		{
+			for (rem_port* port = main_port; port; port = port->port_next)
+			{
+				if (port->port_state == rem_port::PENDING && port->port_dummy_packet_interval &&
+					port->port_handle != INVALID_SOCKET)
+				{
+					port->port_dummy_timeout -= delta_time;
+
+					if (port->port_dummy_timeout < 0)
+						selct->due(port);
+				}
+			}
+		}
+
+		if (!selct->hasPorts())
+		{
+			if (!INET_shutting_down && (main_port->port_server_flags & SRVR_multi_client))
+				gds__log("INET/select_wait: client rundown complete, server exiting");
+
+			return false;
+		}
+
+		// Bad sockets and ports with expired keepalive timer are reported at once
+		if (selct->hasPending())
+		{
+			RemPortPtr p(main_port);
+			selct->checkStart(p);
+			return true;
+		}
+	} // port_mutex scope
+
+	for (;;)
+	{
+		// Before waiting for incoming packet, check for server shutdown
+		if (tryStopMainThread && tryStopMainThread())
+		{
+			// this is not server port any more
+			main_port->port_server_flags &= ~SRVR_multi_client;
+			return false;
+		}
+
+		struct timeval timeout;
+		timeout.tv_sec = SELECT_TIMEOUT;
+		timeout.tv_usec = 0;
+
+		selct->select(&timeout);
+		const int inetErrNo = INET_ERRNO;
+
+		if (selct->getCount() != -1)
+		{
+			RemPortPtr p(main_port);
+			selct->checkStart(p);
+			return true;
+		}
+
+		if (!INTERRUPT_ERROR(inetErrNo))
+		{
+			gds__log("INET/select_wait: epoll_wait failed, errno = %d", inetErrNo);
+			return false;
+		}
+	}
+}
+#endif
+
 static int send_full( rem_port* port, PACKET * packet)
 {
 /**************************************
@@ -173,7 +173,10 @@ rem_port* WNET_analyze(ClntAuthBlock* cBlock,
 		REMOTE_PROTOCOL(PROTOCOL_VERSION13, ptype_batch_send, 4),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION14, ptype_batch_send, 5),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION15, ptype_batch_send, 6),
-		REMOTE_PROTOCOL(PROTOCOL_VERSION16, ptype_batch_send, 7)
+		REMOTE_PROTOCOL(PROTOCOL_VERSION16, ptype_batch_send, 7),
+		REMOTE_PROTOCOL(PROTOCOL_INLINE_BLOB, ptype_batch_send, 8),
+		REMOTE_PROTOCOL(PROTOCOL_PIPELINE, ptype_batch_send, 9),
+		REMOTE_PROTOCOL(PROTOCOL_FETCH_BUDGET, ptype_batch_send, 10)
 	};
 	fb_assert(FB_NELEM(protocols_to_try) <= FB_NELEM(cnct->p_cnct_versions));
 	cnct->p_cnct_count = FB_NELEM(protocols_to_try);
@@ -376,6 +376,7 @@ static rem_fmt* parse_format(const UCHAR*& blr, size_t& blr_length)
 
 	format->fmt_length = offset;
 	format->fmt_net_length = net_length;
+	format->compileEncoder();
 
 	return format.release();
 }
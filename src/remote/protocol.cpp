@@ -111,6 +111,7 @@ static bool_t xdr_debug_packet(RemoteXdr*, enum xdr_op, PACKET*);
 #endif
 static bool_t xdr_longs(RemoteXdr*, CSTRING*);
 static bool_t xdr_message(RemoteXdr*, RMessage*, const rem_fmt*);
+static UCHAR* put_item(UCHAR*, const rem_fmt*, FB_SIZE_T, const UCHAR*);
 static bool_t xdr_packed_message(RemoteXdr*, RMessage*, const rem_fmt*);
 static bool_t xdr_request(RemoteXdr*, USHORT, USHORT, USHORT);
 static bool_t xdr_slice(RemoteXdr*, lstring*, /*USHORT,*/ const UCHAR*);
@@ -122,6 +123,7 @@ static bool_t xdr_trrq_message(RemoteXdr*, USHORT);
 static bool_t xdr_bytes(RemoteXdr*, void*, ULONG);
 static bool_t xdr_blob_stream(RemoteXdr*, SSHORT, CSTRING*);
 static Rsr* getStatement(RemoteXdr*, USHORT);
+static Rsr* lookupStatement(rem_port*, SLONG);
 
 
 inline void fixupLength(const RemoteXdr* xdrs, ULONG& length)
@@ -137,6 +139,51 @@ inline void fixupLength(const RemoteXdr* xdrs, ULONG& length)
 }
 
 
+// Precompiled encoding puts data right into the packet buffer
+
+inline bool canPutDirect(const RemoteXdr* xdrs, const rem_fmt* format, ULONG extra)
+{
+	return !xdrs->x_local && format->fmt_step_index.hasData() &&
+		xdrs->x_handy >= format->fmt_max_xdr_length + extra;
+}
+
+inline void putDirectDone(RemoteXdr* xdrs, const UCHAR* to)
+{
+	const unsigned length = to - reinterpret_cast<UCHAR*>(xdrs->x_private);
+	fb_assert(length <= xdrs->x_handy);
+	xdrs->x_private += length;
+	xdrs->x_handy -= length;
+}
+
+inline UCHAR* put32(UCHAR* to, ULONG value)
+{
+	to[0] = (UCHAR) (value >> 24);
+	to[1] = (UCHAR) (value >> 16);
+	to[2] = (UCHAR) (value >> 8);
+	to[3] = (UCHAR) value;
+	return to + 4;
+}
+
+inline UCHAR* put64(UCHAR* to, const UCHAR* from)
+{
+	FB_UINT64 value;
+	memcpy(&value, from, sizeof(value));
+	to = put32(to, (ULONG) (value >> 32));
+	return put32(to, (ULONG) value);
+}
+
+inline UCHAR* putOpaque(UCHAR* to, const UCHAR* from, ULONG length)
+{
+	memcpy(to, from, length);
+	to += length;
+
+	for (; length & 3; ++length)
+		*to++ = 0;
+
+	return to;
+}
+
+
 #ifdef DEBUG
 static ULONG xdr_save_size = 0;
 inline void DEBUG_PRINTSIZE(RemoteXdr* xdrs, P_OP p)
@@ -662,6 +709,8 @@ bool_t xdr_protocol(RemoteXdr* xdrs, PACKET* p)
 			rem_port* port = xdrs->x_public;
 			if (port->port_protocol >= PROTOCOL_STMT_TOUT)
 				MAP(xdr_u_long, sqldata->p_sqldata_timeout);
+			if (port->port_protocol >= PROTOCOL_INLINE_BLOB)
+				MAP(xdr_u_long, sqldata->p_sqldata_inline_blob_size);
 		}
 		DEBUG_PRINTSIZE(xdrs, p->p_operation);
 		return P_TRUE(xdrs, p);
@@ -1115,6 +1164,29 @@ bool_t xdr_protocol(RemoteXdr* xdrs, PACKET* p)
 			return P_TRUE(xdrs, p);
 		}
 
+	case op_inline_blob:
+		{
+			P_INLINE_BLOB* b = &p->p_inline_blob;
+			MAP(xdr_short, reinterpret_cast<SSHORT&>(b->p_tran_id));
+			MAP(xdr_quad, b->p_blob_id);
+			MAP(xdr_cstring, b->p_blob_info);
+			MAP(xdr_cstring, b->p_blob_data);
+			DEBUG_PRINTSIZE(xdrs, p->p_operation);
+
+			return P_TRUE(xdrs, p);
+		}
+
+	case op_fetch_blobs:
+		{
+			P_FETCH_BLOBS* b = &p->p_fblb;
+			MAP(xdr_short, reinterpret_cast<SSHORT&>(b->p_fblb_transaction));
+			MAP(xdr_u_long, b->p_fblb_max_size);
+			MAP(xdr_cstring_const, b->p_fblb_ids);
+			DEBUG_PRINTSIZE(xdrs, p->p_operation);
+
+			return P_TRUE(xdrs, p);
+		}
+
 	///case op_insert:
 	default:
 #ifdef DEV_BUILD
@@ -1528,6 +1600,17 @@ static bool_t xdr_message( RemoteXdr* xdrs, RMessage* message, const rem_fmt* fo
 	if (port->port_flags & PORT_symmetric)
 		return xdr_opaque(xdrs, reinterpret_cast<SCHAR*>(message->msg_address), format->fmt_length);
 
+	if (xdrs->x_op == XDR_ENCODE && canPutDirect(xdrs, format, 0))
+	{
+		UCHAR* to = reinterpret_cast<UCHAR*>(xdrs->x_private);
+		for (FB_SIZE_T i = 0; i < format->fmt_desc.getCount(); ++i)
+			to = put_item(to, format, i, message->msg_address);
+
+		putDirectDone(xdrs, to);
+		DEBUG_PRINTSIZE(xdrs, op_void);
+		return TRUE;
+	}
+
 	const dsc* desc = format->fmt_desc.begin();
 	for (const dsc* const end = format->fmt_desc.end(); desc < end; ++desc)
 	{
@@ -1540,6 +1623,100 @@ static bool_t xdr_message( RemoteXdr* xdrs, RMessage* message, const rem_fmt* fo
 }
 
 
+static UCHAR* put_item(UCHAR* to, const rem_fmt* format, FB_SIZE_T item, const UCHAR* msg)
+{
+/**************************************
+ *
+ *	p u t _ i t e m
+ *
+ **************************************
+ *
+ * Functional description
+ *	Encode message item by the program compiled for its
+ *	format, exactly as xdr_datum() does it. Caller makes
+ *	sure the packet buffer has enough room.
+ *
+ **************************************/
+	const XdrStep* step = format->fmt_steps.begin() + format->fmt_step_index[item];
+	const XdrStep* const end = format->fmt_steps.begin() + format->fmt_step_index[item + 1];
+
+	for (; step < end; ++step)
+	{
+		const UCHAR* from = msg + step->step_offset;
+
+		switch (step->step_op)
+		{
+		case XdrStep::OPAQUE:
+			to = putOpaque(to, from, step->step_length);
+			break;
+
+		case XdrStep::VARYING:
+			{
+				const vary* v = reinterpret_cast<const vary*>(from);
+				to = put32(to, (ULONG) (SLONG) (SSHORT) v->vary_length);
+				to = putOpaque(to, reinterpret_cast<const UCHAR*>(v->vary_string),
+					MIN((USHORT) (step->step_length - sizeof(USHORT)), v->vary_length));
+			}
+			break;
+
+		case XdrStep::CSTRING:
+			{
+				const USHORT max = step->step_length - 1;
+				USHORT n = 0;
+				while (n < max && from[n])
+					++n;
+				to = put32(to, (ULONG) (SLONG) (SSHORT) n);
+				to = putOpaque(to, from, n);
+			}
+			break;
+
+		case XdrStep::SHORT:
+			{
+				SSHORT value;
+				memcpy(&value, from, sizeof(value));
+				to = put32(to, (ULONG) (SLONG) value);
+			}
+			break;
+
+		case XdrStep::LONGS:
+			for (const UCHAR* const last = from + step->step_length * sizeof(SLONG);
+				from < last; from += sizeof(SLONG))
+			{
+				ULONG value;
+				memcpy(&value, from, sizeof(value));
+				to = put32(to, value);
+			}
+			break;
+
+		case XdrStep::HYPER:
+			to = put64(to, from);
+			break;
+
+		case XdrStep::DOUBLE:
+			{
+				ULONG words[2];
+				memcpy(words, from, sizeof(words));
+				to = put32(to, words[FB_LONG_DOUBLE_FIRST]);
+				to = put32(to, words[FB_LONG_DOUBLE_SECOND]);
+			}
+			break;
+
+		case XdrStep::WIDE:
+#ifndef WORDS_BIGENDIAN
+			to = put64(to, from + sizeof(SINT64));
+			to = put64(to, from);
+#else
+			to = put64(to, from);
+			to = put64(to, from + sizeof(SINT64));
+#endif
+			break;
+		}
+	}
+
+	return to;
+}
+
+
 static bool_t xdr_packed_message( RemoteXdr* xdrs, RMessage* message, const rem_fmt* format)
 {
 /**************************************
@@ -1613,6 +1790,24 @@ static bool_t xdr_packed_message( RemoteXdr* xdrs, RMessage* message, const rem_
 				nulls.setNull(index);
 		}
 
+		// Put the whole row into the packet buffer if it surely fits there
+
+		if (canPutDirect(xdrs, format, FB_ALIGN(flagBytes, 4)))
+		{
+			UCHAR* to = reinterpret_cast<UCHAR*>(xdrs->x_private);
+			to = putOpaque(to, nulls.getData(), flagBytes);
+
+			for (FB_SIZE_T i = 0; i < format->fmt_desc.getCount(); i += 2)
+			{
+				if (!nulls.isNull((USHORT) (i / 2)))
+					to = put_item(to, format, i, message->msg_address);
+			}
+
+			putDirectDone(xdrs, to);
+			DEBUG_PRINTSIZE(xdrs, op_void);
+			return TRUE;
+		}
+
 		// Send the NULL bitmap
 
 		if (!xdr_opaque(xdrs, reinterpret_cast<SCHAR*>(nulls.getData()), flagBytes))
@@ -1857,17 +2052,8 @@ static bool_t xdr_sql_blr(RemoteXdr* xdrs,
 
 	if (statement_id >= 0)
 	{
-		if (static_cast<ULONG>(statement_id) >= port->port_objects.getCount())
+		if (!(statement = lookupStatement(port, statement_id)))
 			return FALSE;
-
-		try
-		{
-			statement = port->port_objects[statement_id];
-		}
-		catch (const status_exception&)
-		{
-			return FALSE;
-		}
 	}
 	else
 	{
@@ -1955,23 +2141,9 @@ static bool_t xdr_sql_message( RemoteXdr* xdrs, SLONG statement_id)
 	rem_port* port = xdrs->x_public;
 
 	if (statement_id >= 0)
-	{
-		if (static_cast<ULONG>(statement_id) >= port->port_objects.getCount())
-			return FALSE;
-
-		try
-		{
-			statement = port->port_objects[statement_id];
-		}
-		catch (const status_exception&)
-		{
-			return FALSE;
-		}
-	}
+		statement = lookupStatement(port, statement_id);
 	else
-	{
 		statement = port->port_statement;
-	}
 
 	if (!statement)
 		return FALSE;
@@ -2216,38 +2388,55 @@ static void reset_statement( RemoteXdr* xdrs, SSHORT statement_id)
 
 	fb_assert(statement_id >= -1);
 
-	if (((ULONG) statement_id < port->port_objects.getCount()) && (statement_id >= 0))
+	if (statement_id >= 0 || (port->port_flags & PORT_lazy))
 	{
-		try
-		{
-			statement = port->port_objects[statement_id];
+		statement = lookupStatement(port, (USHORT) statement_id);
+		if (statement)
 			REMOTE_reset_statement(statement);
-		}
-		catch (const status_exception&)
-		{} // no-op
 	}
 }
 
 static Rsr* getStatement(RemoteXdr* xdrs, USHORT statement_id)
 {
-	rem_port* port = xdrs->x_public;
+	return lookupStatement(xdrs->x_public, statement_id);
+}
 
-	if (statement_id >= 0)
+static Rsr* lookupStatement(rem_port* port, SLONG statement_id)
+{
+/**************************************
+ *
+ *	l o o k u p S t a t e m e n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Find the statement referenced by a packet.
+ *	A statement allocated in the same flight as its
+ *	prepare and execute is referenced by INVALID_OBJECT:
+ *	the client knows it as the pipelined statement,
+ *	the server as the object allocated last.
+ *
+ **************************************/
+
+	if (statement_id == INVALID_OBJECT && (port->port_flags & PORT_lazy))
 	{
-		if (statement_id >= port->port_objects.getCount())
-			return nullptr;
+		if (port->port_pipe_statement)
+			return port->port_pipe_statement;
 
-		try
-		{
-			return port->port_objects[statement_id];
-		}
-		catch (const status_exception&)
-		{
-			return nullptr;
-		}
+		statement_id = port->port_last_object_id;
 	}
 
-	return port->port_statement;
+	if (statement_id < 0 || static_cast<ULONG>(statement_id) >= port->port_objects.getCount())
+		return nullptr;
+
+	try
+	{
+		return port->port_objects[statement_id];
+	}
+	catch (const status_exception&)
+	{
+		return nullptr;
+	}
 }
 
 static bool_t xdr_blob_stream(RemoteXdr* xdrs, SSHORT statement_id, CSTRING* strmPortion)
@@ -93,6 +93,29 @@ const USHORT PROTOCOL_VERSION15 = (FB_PROTOCOL_FLAG | 15);
 const USHORT PROTOCOL_VERSION16 = (FB_PROTOCOL_FLAG | 16);
 const USHORT PROTOCOL_STMT_TOUT = PROTOCOL_VERSION16;
 
+// Private protocol versions are numbered from PROTOCOL_PRIVATE_BASE, far from
+// the ones assigned by the Firebird project, so that a peer never takes them
+// for each other. Server accepts them by exact value.
+
+const USHORT PROTOCOL_PRIVATE_BASE = 0x1000;
+
+// Private protocol 1:
+//	- supports inline blobs in fetch responses and bulk fetch of blobs
+
+const USHORT PROTOCOL_INLINE_BLOB = (FB_PROTOCOL_FLAG | PROTOCOL_PRIVATE_BASE | 1);
+
+// Private protocol 2:
+//	- supports allocate, prepare and execute of a statement in one flight,
+//	  statement referenced by INVALID_OBJECT until its id is known
+
+const USHORT PROTOCOL_PIPELINE = (FB_PROTOCOL_FLAG | PROTOCOL_PRIVATE_BASE | 2);
+
+// Private protocol 3:
+//	- client bounds fetch batches by its cache size, server doesn't cut
+//	  them at MAX_PACKETS_PER_BATCH
+
+const USHORT PROTOCOL_FETCH_BUDGET = (FB_PROTOCOL_FLAG | PROTOCOL_PRIVATE_BASE | 3);
+
 // Architecture types
 
 enum P_ARCH
@@ -126,6 +149,7 @@ const USHORT ptype_MASK			= 0xFF;	// Mask - up to 255 types of protocol
 //
 // upper byte is used for protocol flags
 const USHORT pflag_compress		= 0x100;	// Turn on compression if possible
+const USHORT pflag_compress_zstd	= 0x200;	// Use zstd instead of zlib, together with pflag_compress
 
 // Generic object id
 
@@ -290,6 +314,11 @@ enum P_OP
 
 	op_batch_cancel			= 109,
 
+	// Private operations, numbered far from the ones of the Firebird project
+
+	op_inline_blob			= 200,
+	op_fetch_blobs			= 201,
+
 	op_max
 };
 
@@ -598,6 +627,7 @@ typedef struct p_sqldata
     USHORT	p_sqldata_out_message_number;
     ULONG	p_sqldata_status;			// final eof status
 	ULONG	p_sqldata_timeout;			// statement timeout
+	ULONG	p_sqldata_inline_blob_size;	// max size of blob sent with fetched rows
 } P_SQLDATA;
 
 typedef struct p_sqlfree
@@ -725,6 +755,24 @@ typedef struct p_replicate
 } P_REPLICATE;
 
 
+// Inline blobs
+
+typedef struct p_inline_blob
+{
+	OBJCT		p_tran_id;			// transaction object id
+	SQUAD		p_blob_id;			// blob id
+	CSTRING		p_blob_info;		// response to blob info items
+	CSTRING		p_blob_data;		// segments, each preceded by 2 bytes of length
+} P_INLINE_BLOB;
+
+typedef struct p_fetch_blobs
+{
+	OBJCT			p_fblb_transaction;	// transaction object id
+	ULONG			p_fblb_max_size;	// max size of blob to send
+	CSTRING_CONST	p_fblb_ids;			// blob ids, 8 bytes each in vax format
+} P_FETCH_BLOBS;
+
+
 // Generalize packet (sic!)
 
 typedef struct packet
@@ -777,6 +825,8 @@ typedef struct packet
 	P_BATCH_REGBLOB p_batch_regblob;	// Register already existing BLOB in batch
 	P_BATCH_SETBPB p_batch_setbpb;		// Set default BPB for batch
 	P_REPLICATE p_replicate;	// replicate
+	P_INLINE_BLOB p_inline_blob;	// Blob sent with fetched rows
+	P_FETCH_BLOBS p_fblb;		// Bulk fetch of blobs
 
 public:
 	packet()
@@ -864,6 +864,226 @@ void Rsr::saveException(const Firebird::Exception& ex, bool overwrite)
 	}
 }
 
+void Rtr::addInlineBlob(InlineBlob* blob)
+{
+	// The cache only saves round trips, when it grows too big start it over
+	if (rtr_inline_size + blob->ibl_data.getCount() > MAX_INLINE_BLOB_CACHE)
+		clearInlineBlobs();
+
+	FB_SIZE_T pos;
+	if (rtr_inline_blobs.find(blob->ibl_key, pos))
+	{
+		rtr_inline_size -= rtr_inline_blobs[pos]->ibl_data.getCount();
+		delete rtr_inline_blobs[pos];
+		rtr_inline_blobs[pos] = blob;
+	}
+	else
+		rtr_inline_blobs.insert(pos, blob);
+
+	rtr_inline_size += blob->ibl_data.getCount();
+
+	if (rtr_blobs_pending.find(blob->ibl_key, pos))
+		rtr_blobs_pending.remove(pos);
+}
+
+InlineBlob* Rtr::getInlineBlob(const ISC_QUAD& id)
+{
+	FB_SIZE_T pos;
+	if (!rtr_inline_blobs.find(blobKey(id), pos))
+		return NULL;
+
+	InlineBlob* const blob = rtr_inline_blobs[pos];
+	rtr_inline_blobs.remove(pos);
+	rtr_inline_size -= blob->ibl_data.getCount();
+
+	return blob;
+}
+
+void Rtr::addPendingBlob(const ISC_QUAD& id)
+{
+	const FB_UINT64 key = blobKey(id);
+
+	FB_SIZE_T pos;
+	if (rtr_blobs_pending.getCount() < MAX_BLOBS_PER_FETCH &&
+		!rtr_inline_blobs.exist(key) && !rtr_blobs_pending.find(key, pos))
+	{
+		rtr_blobs_pending.insert(pos, key);
+	}
+}
+
+void Rtr::clearInlineBlobs()
+{
+	for (InlineBlob** iter = rtr_inline_blobs.begin(); iter != rtr_inline_blobs.end(); ++iter)
+		delete *iter;
+
+	rtr_inline_blobs.clear();
+	rtr_inline_size = 0;
+}
+
+void rem_fmt::compileEncoder()
+{
+/**************************************
+ *
+ *	c o m p i l e E n c o d e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Translate format into the program used to put
+ *	messages right into the packet buffer instead of
+ *	passing every item through xdr_datum().
+ *	Program is left empty for unknown data types,
+ *	xdr_datum() is used for such formats.
+ *
+ **************************************/
+	fmt_steps.clear();
+	fmt_step_index.clear();
+	fmt_max_xdr_length = 0;
+
+	ULONG length = 0;
+
+	for (const dsc* desc = fmt_desc.begin(); desc < fmt_desc.end(); ++desc)
+	{
+		const FB_SIZE_T first = fmt_steps.getCount();
+		fmt_step_index.add(first);
+
+		const ULONG offset = (ULONG)(IPTR) desc->dsc_address;
+		const USHORT dscLength = desc->dsc_length;
+
+		// Item is sequence of words, shorts and opaque data at given offsets
+
+		struct Piece
+		{
+			XdrStep::Op op;
+			USHORT length;
+			size_t offset;
+		};
+		Piece pieces[4];
+		unsigned count = 0;
+
+		switch (desc->dsc_dtype)
+		{
+		case dtype_dbkey:
+		case dtype_text:
+		case dtype_boolean:
+			pieces[count++] = {XdrStep::OPAQUE, dscLength, offset};
+			length += FB_ALIGN(dscLength, 4);
+			break;
+
+		case dtype_varying:
+			fb_assert(dscLength >= sizeof(USHORT));
+			pieces[count++] = {XdrStep::VARYING, dscLength, offset};
+			length += 4 + FB_ALIGN(dscLength - sizeof(USHORT), 4);
+			break;
+
+		case dtype_cstring:
+			if (dscLength)
+			{
+				pieces[count++] = {XdrStep::CSTRING, dscLength, offset};
+				length += 4 + FB_ALIGN(dscLength - 1, 4);
+				break;
+			}
+			// fall through - no room even for terminator
+
+
+		case dtype_short:
+			pieces[count++] = {XdrStep::SHORT, sizeof(SSHORT), offset};
+			length += 4;
+			break;
+
+		case dtype_sql_time:
+		case dtype_sql_date:
+		case dtype_long:
+		case dtype_real:
+			pieces[count++] = {XdrStep::LONGS, 1, offset};
+			length += 4;
+			break;
+
+		case dtype_sql_time_tz:
+			pieces[count++] = {XdrStep::LONGS, 1, offset};
+			pieces[count++] = {XdrStep::SHORT, sizeof(SSHORT), offset + sizeof(SLONG)};
+			length += 8;
+			break;
+
+		case dtype_ex_time_tz:
+			pieces[count++] = {XdrStep::LONGS, 1, offset};
+			pieces[count++] = {XdrStep::SHORT, sizeof(SSHORT), offset + sizeof(SLONG)};
+			pieces[count++] = {XdrStep::SHORT, sizeof(SSHORT), offset + sizeof(SLONG) + sizeof(SSHORT)};
+			length += 12;
+			break;
+
+		case dtype_timestamp:
+		case dtype_array:
+		case dtype_quad:
+		case dtype_blob:
+			pieces[count++] = {XdrStep::LONGS, 2, offset};
+			length += 8;
+			break;
+
+		case dtype_timestamp_tz:
+			pieces[count++] = {XdrStep::LONGS, 2, offset};
+			pieces[count++] = {XdrStep::SHORT, sizeof(SSHORT), offset + 2 * sizeof(SLONG)};
+			length += 12;
+			break;
+
+		case dtype_ex_timestamp_tz:
+			pieces[count++] = {XdrStep::LONGS, 2, offset};
+			pieces[count++] = {XdrStep::SHORT, sizeof(SSHORT), offset + 2 * sizeof(SLONG)};
+			pieces[count++] = {XdrStep::SHORT, sizeof(SSHORT),
+				offset + 2 * sizeof(SLONG) + sizeof(SSHORT)};
+			length += 16;
+			break;
+
+		case dtype_double:
+			pieces[count++] = {XdrStep::DOUBLE, sizeof(double), offset};
+			length += 8;
+			break;
+
+		case dtype_int64:
+		case dtype_dec64:
+			pieces[count++] = {XdrStep::HYPER, sizeof(SINT64), offset};
+			length += 8;
+			break;
+
+		case dtype_dec128:
+		case dtype_int128:
+			pieces[count++] = {XdrStep::WIDE, 2 * sizeof(SINT64), offset};
+			length += 16;
+			break;
+
+		default:
+			fmt_steps.clear();
+			fmt_step_index.clear();
+			return;
+		}
+
+		for (const Piece* piece = pieces; piece < pieces + count; ++piece)
+		{
+			// Adjacent words of the same item are put by one step
+
+			if (piece->op == XdrStep::LONGS && fmt_steps.getCount() > first)
+			{
+				XdrStep& last = fmt_steps.back();
+				if (last.step_op == XdrStep::LONGS &&
+					last.step_offset + last.step_length * sizeof(SLONG) == piece->offset)
+				{
+					last.step_length += piece->length;
+					continue;
+				}
+			}
+
+			XdrStep step;
+			step.step_op = piece->op;
+			step.step_length = piece->length;
+			step.step_offset = (ULONG) piece->offset;
+			fmt_steps.add(step);
+		}
+	}
+
+	fmt_step_index.add(fmt_steps.getCount());
+	fmt_max_xdr_length = length;
+}
+
 Firebird::string rem_port::getRemoteId() const
 {
 	fb_assert(port_protocol_id.hasData());
@@ -1340,6 +1560,9 @@ void rem_port::versionInfo(Firebird::string& version) const
 
 #ifdef WIRE_COMPRESS_SUPPORT
 static Firebird::InitInstance<Firebird::ZLib> zlib;
+#ifdef HAVE_ZSTD_H
+static Firebird::InitInstance<Firebird::ZStd> zstd;
+#endif
 #endif // WIRE_COMPRESS_SUPPORT
 
 rem_port::~rem_port()
@@ -1368,6 +1591,14 @@ rem_port::~rem_port()
 #endif
 
 #ifdef WIRE_COMPRESS_SUPPORT
+#ifdef HAVE_ZSTD_H
+	if (port_zstd_send)
+	{
+		zstd().freeCStream(port_zstd_send);
+		zstd().freeDStream(port_zstd_recv);
+	}
+	else
+#endif
 	if (port_compressed)
 	{
 		zlib().deflateEnd(&port_send_stream);
@@ -1376,6 +1607,106 @@ rem_port::~rem_port()
 #endif
 }
 
+#if defined(WIRE_COMPRESS_SUPPORT) && defined(HAVE_ZSTD_H)
+static bool zstd_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer,
+	SSHORT buffer_length, SSHORT* length)
+{
+	ZSTD_inBuffer& in = port->port_zstd_in;
+	ZSTD_outBuffer out = {buffer, (size_t) buffer_length, 0};
+	UCHAR* const compressed = &port->port_compressed[REM_RECV_OFFSET(port->port_buff_size)];
+
+	for (;;)
+	{
+		// Stream could keep decompressed data which did not fit
+		// into the buffer, so try it even without new input
+
+		if (in.pos < in.size || port->port_z_data)
+		{
+			const size_t ret = zstd().decompressStream(port->port_zstd_recv, &out, &in);
+			if (zstd().isError(ret))
+			{
+#ifdef COMPRESS_DEBUG
+				fprintf(stderr, "Zstd decompress error\n");
+#endif
+				port->port_z_data = false;
+				return false;
+			}
+
+			if (out.pos)
+				break;
+
+			if (port->port_z_data)		// Was called from select_multi() but nothing decompressed
+			{
+				port->port_z_data = false;
+				return false;
+			}
+		}
+
+		if (in.pos)
+		{
+			memmove(compressed, compressed + in.pos, in.size - in.pos);
+			in.size -= in.pos;
+			in.pos = 0;
+		}
+
+		SSHORT l = (SSHORT) (port->port_buff_size - in.size);
+		if ((!packet_receive(port, compressed + in.size, l, &l)) || (l <= 0))
+		{
+			port->port_z_data = false;
+			return false;
+		}
+
+		in.size += l;
+	}
+
+	*length = (SSHORT) out.pos;
+	port->port_z_data = (in.pos < in.size) || (out.pos == out.size);
+
+	return true;
+}
+
+static bool zstd_deflate(RemoteXdr* xdrs, PacketSend* packet_send, bool flush)
+{
+	rem_port* port = xdrs->x_public;
+
+	ZSTD_inBuffer in = {xdrs->x_base, (size_t) (xdrs->x_private - xdrs->x_base), 0};
+	ZSTD_outBuffer& out = port->port_zstd_out;
+
+	for (;;)
+	{
+		const size_t ret = zstd().compressStream2(port->port_zstd_send, &out, &in,
+			flush ? ZSTD_e_flush : ZSTD_e_continue);
+
+		if (zstd().isError(ret))
+		{
+#ifdef COMPRESS_DEBUG
+			fprintf(stderr, "Zstd compress error\n");
+#endif
+			return false;
+		}
+
+		// When flushing, zero means everything is in the output buffer
+		const bool done = flush ? !ret : (in.pos == in.size);
+
+		if (out.pos == out.size || (done && flush && out.pos))
+		{
+			if (!packet_send(port, static_cast<SCHAR*>(out.dst), (SSHORT) out.pos))
+				return false;
+
+			out.pos = 0;
+		}
+
+		if (done)
+			break;
+	}
+
+	xdrs->x_private = xdrs->x_base;
+	xdrs->x_handy = port->port_buff_size;
+
+	return true;
+}
+#endif // WIRE_COMPRESS_SUPPORT && HAVE_ZSTD_H
+
 bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer,
 	SSHORT buffer_length, SSHORT* length)
 {
@@ -1383,6 +1714,11 @@ bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer
 	if (!port->port_compressed)
 		return packet_receive(port, buffer, buffer_length, length);
 
+#ifdef HAVE_ZSTD_H
+	if (port->port_zstd_recv)
+		return zstd_inflate(port, packet_receive, buffer, buffer_length, length);
+#endif
+
 	z_stream& strm = port->port_recv_stream;
 	strm.avail_out = buffer_length;
 	strm.next_out = buffer;
@@ -1466,6 +1802,11 @@ bool REMOTE_deflate(RemoteXdr* xdrs, ProtoWrite* proto_write, PacketSend* packet
 	if (!(port->port_compressed && (port->port_flags & PORT_compressed)))
 		return proto_write(xdrs);
 
+#ifdef HAVE_ZSTD_H
+	if (port->port_zstd_send)
+		return zstd_deflate(xdrs, packet_send, flush);
+#endif
+
 	z_stream& strm = port->port_send_stream;
 	strm.avail_in = xdrs->x_private - xdrs->x_base;
 	strm.next_in = (Bytef*) xdrs->x_base;
@@ -1533,24 +1874,88 @@ bool REMOTE_deflate(RemoteXdr* xdrs, ProtoWrite* proto_write, PacketSend* packet
 #endif
 }
 
-bool rem_port::checkCompression()
+bool rem_port::checkCompression(USHORT type)
 {
 #ifdef WIRE_COMPRESS_SUPPORT
-	return zlib();
+	if (!zlib())
+		return false;
+
+	if (type & pflag_compress_zstd)
+	{
+#ifdef HAVE_ZSTD_H
+		return zstd();
+#else
+		return false;
+#endif
+	}
+
+	return true;
 #else
 	return false;
 #endif
 }
 
-void rem_port::initCompression()
+void rem_port::initCompression(USHORT type)
 {
 #ifdef WIRE_COMPRESS_SUPPORT
 	if (port_protocol >= PROTOCOL_VERSION13 && !port_compressed && zlib())
 	{
+		const int level = getPortConfig()->getWireCompressionLevel();
+
+#ifdef HAVE_ZSTD_H
+		if ((type & pflag_compress_zstd) && zstd())
+		{
+			port_zstd_send = zstd().createCStreamPool(getPool());
+			port_zstd_recv = zstd().createDStreamPool(getPool());
+
+			if (!port_zstd_send || !port_zstd_recv ||
+				zstd().isError(zstd().initDStream(port_zstd_recv)) ||
+				(level && zstd().isError(zstd().CCtx_setParameter(port_zstd_send, ZSTD_c_compressionLevel,
+					MIN(MAX(level, zstd().minCLevel()), zstd().maxCLevel())))))
+			{
+				if (port_zstd_send)
+					zstd().freeCStream(port_zstd_send);
+				if (port_zstd_recv)
+					zstd().freeDStream(port_zstd_recv);
+				port_zstd_send = NULL;
+				port_zstd_recv = NULL;
+
+				(Firebird::Arg::Gds(isc_deflate_init) << Firebird::Arg::Num(0)).raise();
+			}
+
+			try
+			{
+				port_compressed.reset(FB_NEW_POOL(getPool()) UCHAR[port_buff_size * 2]);
+			}
+			catch (const Firebird::Exception&)
+			{
+				zstd().freeCStream(port_zstd_send);
+				zstd().freeDStream(port_zstd_recv);
+				port_zstd_send = NULL;
+				port_zstd_recv = NULL;
+				throw;
+			}
+
+			memset(port_compressed, 0, port_buff_size * 2);
+
+			port_zstd_in.src = &port_compressed[REM_RECV_OFFSET(port_buff_size)];
+			port_zstd_in.size = port_zstd_in.pos = 0;
+			port_zstd_out.dst = &port_compressed[REM_SEND_OFFSET(port_buff_size)];
+			port_zstd_out.size = port_buff_size;
+			port_zstd_out.pos = 0;
+
+#ifdef COMPRESS_DEBUG
+			fprintf(stderr, "Completed zstd init port %p\n", this);
+#endif
+			return;
+		}
+#endif
+
 		port_send_stream.zalloc = Firebird::ZLib::allocFunc;
 		port_send_stream.zfree = Firebird::ZLib::freeFunc;
 		port_send_stream.opaque = Z_NULL;
-		int ret = zlib().deflateInit(&port_send_stream, Z_DEFAULT_COMPRESSION);
+		int ret = zlib().deflateInit(&port_send_stream,
+			level ? MIN(MAX(level, Z_BEST_SPEED), Z_BEST_COMPRESSION) : Z_DEFAULT_COMPRESSION);
 		if (ret != Z_OK)
 			(Firebird::Arg::Gds(isc_deflate_init) << Firebird::Arg::Num(ret)).raise();
 		port_send_stream.next_out = NULL;
@@ -100,6 +100,13 @@ const ULONG MAX_ROWS_PER_BATCH = 1000;
 
 const ULONG MAX_BATCH_CACHE_SIZE = 1024 * 1024; // 1 MB
 
+// Inline blobs constants
+
+const ULONG MAX_INLINE_BLOB_BATCH = 1024 * 1024;		// inlined per fetch batch, 1 MB
+const ULONG MAX_INLINE_BLOB_PROBES = 64;				// blobs opened per fetch batch
+const ULONG MAX_INLINE_BLOB_CACHE = 16 * 1024 * 1024;	// cached per transaction, 16 MB
+const FB_SIZE_T MAX_BLOBS_PER_FETCH = 256;				// ids in op_fetch_blobs
+
 // fwd. decl.
 namespace Firebird {
 	class Exception;
@@ -189,6 +196,41 @@ public:
 };
 
 
+inline FB_UINT64 blobKey(const ISC_QUAD& id)
+{
+	return ((FB_UINT64) (ULONG) id.gds_quad_high << 32) | id.gds_quad_low;
+}
+
+inline ISC_QUAD blobId(FB_UINT64 key)
+{
+	ISC_QUAD id;
+	id.gds_quad_high = (ISC_LONG) (key >> 32);
+	id.gds_quad_low = (ISC_ULONG) key;
+	return id;
+}
+
+// Blob sent by server ahead of the row referencing it
+
+struct InlineBlob : public Firebird::GlobalStorage
+{
+	FB_UINT64				ibl_key;	// blob id
+	Firebird::UCharBuffer	ibl_info;	// response to blob info items
+	Firebird::UCharBuffer	ibl_data;	// segments, each preceded by 2 bytes of length
+
+public:
+	explicit InlineBlob(const ISC_QUAD& id) :
+		ibl_key(blobKey(id)), ibl_info(getPool()), ibl_data(getPool())
+	{ }
+
+	static FB_UINT64 generate(const InlineBlob* item)
+	{
+		return item->ibl_key;
+	}
+};
+
+typedef Firebird::SortedArray<InlineBlob*, Firebird::EmptyStorage<InlineBlob*>,
+	FB_UINT64, InlineBlob> InlineBlobs;
+
 struct Rtr : public Firebird::GlobalStorage, public TypedHandle<rem_type_rtr>
 {
 	Rdb*			rtr_rdb;
@@ -201,20 +243,34 @@ struct Rtr : public Firebird::GlobalStorage, public TypedHandle<rem_type_rtr>
 	Firebird::Array<Rsr*> rtr_cursors;
 	Rtr**			rtr_self;
 
+	InlineBlobs		rtr_inline_blobs;	// Blobs received ahead of rows (client)
+	ULONG			rtr_inline_size;	// Size of data in rtr_inline_blobs
+	Firebird::SortedArray<FB_UINT64> rtr_blobs_pending;	// Fetched blobs not received inline (client)
+	bool			rtr_fetch_blobs;	// Bulk fetch of pending blobs is worth doing (client)
+
 public:
 	Rtr() :
 		rtr_rdb(0), rtr_next(0), rtr_blobs(0),
 		rtr_iface(NULL), rtr_id(0), rtr_limbo(0),
-		rtr_cursors(getPool()), rtr_self(NULL)
+		rtr_cursors(getPool()), rtr_self(NULL),
+		rtr_inline_blobs(getPool()), rtr_inline_size(0), rtr_blobs_pending(getPool()),
+		rtr_fetch_blobs(true)
 	{ }
 
 	~Rtr()
 	{
 		if (rtr_self && *rtr_self == this)
 			*rtr_self = NULL;
+
+		clearInlineBlobs();
 	}
 
 	static ISC_STATUS badHandle() { return isc_bad_trans_handle; }
+
+	void addInlineBlob(InlineBlob* blob);
+	InlineBlob* getInlineBlob(const ISC_QUAD& id);
+	void addPendingBlob(const ISC_QUAD& id);
+	void clearInlineBlobs();
 };
 
 
@@ -228,6 +284,8 @@ struct Rbl : public Firebird::GlobalStorage, public TypedHandle<rem_type_rbl>
 	UCHAR*		rbl_ptr;
 	ServBlob	rbl_iface;
 	SLONG		rbl_offset;			// Apparent (to user) offset in blob
+	ISC_QUAD	rbl_blob_id;		// Blob id, for cached blob only
+	Firebird::UCharBuffer rbl_info;	// Response to blob info items, for cached blob only
 	USHORT		rbl_id;
 	USHORT		rbl_flags;
 	USHORT		rbl_buffer_length;
@@ -243,14 +301,15 @@ public:
 		EOF_SET = 1,
 		SEGMENT = 2,
 		EOF_PENDING = 4,
-		CREATE = 8
+		CREATE = 8,
+		CACHED = 16			// Data received inline, no server object yet
 	};
 
 public:
 	Rbl() :
 		rbl_data(getPool()), rbl_rdb(0), rbl_rtr(0), rbl_next(0),
 		rbl_buffer(rbl_data.getBuffer(BLOB_LENGTH)), rbl_ptr(rbl_buffer), rbl_iface(NULL),
-		rbl_offset(0), rbl_id(0), rbl_flags(0),
+		rbl_offset(0), rbl_blob_id(), rbl_info(getPool()), rbl_id(0), rbl_flags(0),
 		rbl_buffer_length(BLOB_LENGTH), rbl_length(0), rbl_fragment_length(0),
 		rbl_source_interp(0), rbl_target_interp(0), rbl_self(NULL)
 	{ }
@@ -306,19 +365,46 @@ struct rem_str : public pool_alloc_rpt<SCHAR>
 #include "../common/dsc.h"
 
 
+// Step of precompiled XDR encoding of a message format
+
+struct XdrStep
+{
+	enum Op : UCHAR
+	{
+		OPAQUE,		// bytes padded up to 4
+		VARYING,	// length, then bytes padded up to 4
+		CSTRING,	// length up to zero terminator, then bytes padded up to 4
+		SHORT,		// 16-bit integer sent as 32-bit one
+		LONGS,		// run of 32-bit words
+		HYPER,		// 64-bit integer
+		DOUBLE,		// two 32-bit words in FB_LONG_DOUBLE_FIRST/SECOND order
+		WIDE		// 128-bit value sent as two hypers
+	};
+
+	Op		step_op;
+	USHORT	step_length;	// bytes in message (words for LONGS)
+	ULONG	step_offset;	// offset in message
+};
+
 struct rem_fmt : public Firebird::GlobalStorage
 {
 	ULONG		fmt_length;
 	ULONG		fmt_net_length;
 	Firebird::Array<dsc> fmt_desc;
+	Firebird::Array<XdrStep> fmt_steps;		// encoder program, empty if not compiled
+	Firebird::Array<ULONG> fmt_step_index;	// first step of each item, plus end of program
+	ULONG		fmt_max_xdr_length;			// encoded message never exceeds it
 
 public:
 	explicit rem_fmt(FB_SIZE_T rpt) :
 		fmt_length(0), fmt_net_length(0),
-		fmt_desc(getPool(), rpt)
+		fmt_desc(getPool(), rpt), fmt_steps(getPool()), fmt_step_index(getPool()),
+		fmt_max_xdr_length(0)
 	{
 		fmt_desc.grow(rpt);
 	}
+
+	void compileEncoder();
 };
 
 // Windows declares a msg structure, so rename the structure
@@ -482,10 +568,15 @@ struct Rsr : public Firebird::GlobalStorage, public TypedHandle<rem_type_rsr>
 	USHORT			rsr_msgs_waiting; 	// count of full rsr_messages
 	USHORT			rsr_reorder_level; 	// Trigger pipelining at this level
 	USHORT			rsr_batch_count; 	// Count of batches in pipeline
+	USHORT			rsr_fetch_rows;		// Batch size adjusted to network latency, 0 if not measured
+	USHORT			rsr_fetch_received;	// Rows received in the measured batch
+	SINT64			rsr_fetch_sent;		// When the measured batch was requested, 0 if none
+	SINT64			rsr_fetch_first;	// When the first row of the measured batch was received
 
 	Firebird::string rsr_cursor_name;	// Name for cursor to be set on open
 	bool			rsr_delayed_format;	// Out format was delayed on execute, set it on fetch
 	unsigned int	rsr_timeout;		// Statement timeout to be set on open\execute
+	ULONG			rsr_inline_blob_size;	// Max size of blob sent with fetched rows (server)
 	Rsr**			rsr_self;
 
 	ULONG			rsr_batch_size;		// Aligned message size for IBatch operations
@@ -533,7 +624,8 @@ public:
 		STREAM_ERR = 16,	// There is an error pending in the batched rows
 		LAZY = 32,			// To be allocated at the first reference
 		DEFER_EXECUTE = 64,	// op_execute can be deferred
-		PAST_EOF = 128		// EOF was returned by fetch from this statement
+		PAST_EOF = 128,		// EOF was returned by fetch from this statement
+		PIPELINED = 256		// Allocated in the same flight as prepare, id is not known yet
 	};
 
 public:
@@ -543,7 +635,9 @@ public:
 		rsr_format(0), rsr_message(0), rsr_buffer(0), rsr_status(0),
 		rsr_id(0), rsr_fmt_length(0),
 		rsr_rows_pending(0), rsr_msgs_waiting(0), rsr_reorder_level(0), rsr_batch_count(0),
-		rsr_cursor_name(getPool()), rsr_delayed_format(false), rsr_timeout(0), rsr_self(NULL)
+		rsr_fetch_rows(0), rsr_fetch_received(0), rsr_fetch_sent(0), rsr_fetch_first(0),
+		rsr_cursor_name(getPool()), rsr_delayed_format(false), rsr_timeout(0),
+		rsr_inline_blob_size(0), rsr_self(NULL)
 	{ }
 
 	~Rsr()
@@ -1075,6 +1169,7 @@ struct rem_port : public Firebird::GlobalStorage, public Firebird::RefCounted
 	Firebird::string port_address;			// Protocol-specific address string for the port
 	Rpr*			port_rpr;				// port stored procedure reference
 	Rsr*			port_statement;			// Statement for execute immediate
+	Rsr*			port_pipe_statement;	// for client, statement pipelined without known id
 	rmtque*			port_receive_rmtque;	// for client, responses waiting
 	Firebird::AtomicCounter	port_requests_queued;	// requests currently queued
 	xcc*			port_xcc;				// interprocess structure
@@ -1110,6 +1205,12 @@ struct rem_port : public Firebird::GlobalStorage, public Firebird::RefCounted
 #ifdef WIRE_COMPRESS_SUPPORT
 	z_stream port_send_stream, port_recv_stream;
 	UCharArrayAutoPtr	port_compressed;
+#ifdef HAVE_ZSTD_H
+	ZSTD_CStream*	port_zstd_send;		// when not NULL zstd is used instead of zlib streams
+	ZSTD_DStream*	port_zstd_recv;
+	ZSTD_inBuffer	port_zstd_in;		// received data not decompressed yet
+	ZSTD_outBuffer	port_zstd_out;		// compressed data not sent yet
+#endif
 #endif
 
 public:
@@ -1137,7 +1238,7 @@ public:
 		port_connection(0), port_client_arch(arch_generic), port_login(getPool()),
 		port_user_name(getPool()), port_peer_name(getPool()),
 		port_protocol_id(getPool()), port_address(getPool()),
-		port_rpr(0), port_statement(0), port_receive_rmtque(0),
+		port_rpr(0), port_statement(0), port_pipe_statement(0), port_receive_rmtque(0),
 		port_requests_queued(0), port_xcc(0), port_deferred_packets(0), port_last_object_id(0),
 		port_queue(getPool()), port_qoffset(0),
 		port_srv_auth(NULL), port_srv_auth_block(NULL),
@@ -1150,6 +1251,12 @@ public:
 		addRef();
 		memset(&port_linger, 0, sizeof port_linger);
 		memset(port_buffer, 0, rpt);
+#if defined(WIRE_COMPRESS_SUPPORT) && defined(HAVE_ZSTD_H)
+		port_zstd_send = NULL;
+		port_zstd_recv = NULL;
+		memset(&port_zstd_in, 0, sizeof port_zstd_in);
+		memset(&port_zstd_out, 0, sizeof port_zstd_out);
+#endif
 #ifdef DEV_BUILD
 		++portCounter;
 #endif
@@ -1167,8 +1274,8 @@ private:
 	friend class Firebird::RefPtr<rem_port>;
 
 public:
-	void initCompression();
-	static bool checkCompression();
+	void initCompression(USHORT type);
+	static bool checkCompression(USHORT type = pflag_compress);
 	void linkParent(rem_port* const parent);
 	void unlinkParent();
 	Firebird::RefPtr<const Firebird::Config> getPortConfig();
@@ -1336,6 +1443,7 @@ public:
 	ISC_STATUS	execute_immediate(P_OP, P_SQLST*, PACKET*);
 	ISC_STATUS	execute_statement(P_OP, P_SQLDATA*, PACKET*);
 	ISC_STATUS	fetch(P_SQLDATA*, PACKET*);
+	ISC_STATUS	fetch_blobs(P_FETCH_BLOBS*, PACKET*);
 	ISC_STATUS	get_segment(P_SGMT*, PACKET*);
 	ISC_STATUS	get_slice(P_SLC*, PACKET*);
 	void		info(P_OP, P_INFO*, PACKET*);
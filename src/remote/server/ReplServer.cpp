@@ -32,6 +32,8 @@
 #include "../common/os/path_utils.h"
 #include "../common/isc_proto.h"
 #include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/condition.h"
+#include "../common/classes/GenericMap.h"
 #include "../common/ThreadStart.h"
 #include "../common/utils_proto.h"
 #include "../common/classes/ParsedList.h"
@@ -327,13 +329,58 @@ namespace
 #endif
 	};
 
+	const unsigned QUEUE_PER_WORKER = 4;	// blocks queued for a parallel worker
+
 	class Target : public GlobalStorage
 	{
+		typedef HalfStaticArray<UCharBuffer*, QUEUE_PER_WORKER> BlockList;
+
+		// Block queued for a worker
+		struct QueuedBlock
+		{
+			UCharBuffer* buffer;
+			FB_UINT64 after;			// number of commits to be applied before the block
+		};
+
+		typedef HalfStaticArray<QueuedBlock, QUEUE_PER_WORKER> BlockQueue;
+
+		// Connection to the replica database. With parallel apply, every connection
+		// has a thread applying blocks of the transactions assigned to it.
+		class Connection
+		{
+		public:
+			Connection(Target* t, IAttachment* att)
+				: target(t), attachment(att), replicator(nullptr),
+				  queue(t->getPool()), transactions(0), failed(false), thread(0)
+			{}
+
+			static THREAD_ENTRY_DECLARE applyThread(THREAD_ENTRY_PARAM arg)
+			{
+				const auto connection = static_cast<Connection*>(arg);
+				connection->target->apply(connection);
+				return 0;
+			}
+
+			Target* const target;
+			IAttachment* const attachment;
+			IReplicator* replicator;
+			BlockQueue queue;			// blocks in the journal order
+			FbLocalStatus status;		// error of the failed block
+			unsigned transactions;		// number of the assigned transactions
+			bool failed;
+			Thread::Handle thread;
+			Condition cond;				// thread waits for queued blocks
+		};
+
+		typedef GenericMap<Pair<NonPooled<TraNumber, Connection*> > > AssignmentMap;
+
 	public:
 		explicit Target(const Replication::Config* config)
 			: m_config(config),
 			  m_lastError(getPool()),
-			  m_attachment(nullptr), m_replicator(nullptr),
+			  m_connections(getPool()), m_assignments(getPool()),
+			  m_freeBlocks(getPool()), m_queued(0), m_maxQueued(0),
+			  m_commits(0), m_appliedCommits(0), m_stop(false),
 			  m_sequence(0), m_connected(false)
 		{
 		}
@@ -374,17 +421,25 @@ namespace
 			DispatcherPtr provider;
 			FbLocalStatus localStatus;
 
-			m_attachment =
-				provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
-								   	     dpb.getBufferLength(), dpb.getBuffer());
-			localStatus.check();
+			for (unsigned n = 0; n < m_config->applyParallelWorkers; n++)
+			{
+				const auto attachment =
+					provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
+											 dpb.getBufferLength(), dpb.getBuffer());
+				localStatus.check();
 
-			m_replicator = m_attachment->createReplicator(&localStatus);
-			localStatus.check();
+				const auto connection = FB_NEW_POOL(getPool()) Connection(this, attachment);
+				m_connections.add(connection);
+
+				connection->replicator = attachment->createReplicator(&localStatus);
+				localStatus.check();
+			}
 
 			fb_assert(!m_sequence);
 
-			const auto transaction = m_attachment->startTransaction(&localStatus, 0, NULL);
+			const auto attachment = m_connections[0]->attachment;
+
+			const auto transaction = attachment->startTransaction(&localStatus, 0, NULL);
 			localStatus.check();
 
 			const char* sql =
@@ -394,14 +449,23 @@ namespace
 				(FB_BIGINT, sequence)
 			) result(&localStatus, fb_get_master_interface());
 
-			m_attachment->execute(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
-								  NULL, NULL, result.getMetadata(), result.getData());
+			attachment->execute(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
+								NULL, NULL, result.getMetadata(), result.getData());
 			localStatus.check();
 
 			transaction->commit(&localStatus);
 			localStatus.check();
 
 			m_sequence = result->sequence;
+
+			if (isParallel())
+			{
+				for (auto connection : m_connections)
+				{
+					Thread::start(Connection::applyThread, connection, THREAD_medium,
+								  &connection->thread);
+				}
+			}
 #endif
 			m_connected = true;
 
@@ -410,18 +474,43 @@ namespace
 
 		void shutdown()
 		{
-			if (m_attachment)
+			{	// scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+				m_stop = true;
+
+				for (auto connection : m_connections)
+					connection->cond.notifyOne();
+			}
+
+			for (auto connection : m_connections)
 			{
+				if (connection->thread)
+					Thread::waitForCompletion(connection->thread);
+
 #ifndef NO_DATABASE
 				FbLocalStatus localStatus;
-				m_replicator->close(&localStatus);
-				m_attachment->detach(&localStatus);
+
+				if (connection->replicator)
+					connection->replicator->close(&localStatus);
+
+				connection->attachment->detach(&localStatus);
 #endif
-				m_replicator = NULL;
-				m_attachment = NULL;
-				m_sequence = 0;
+				while (connection->queue.hasData())
+					m_freeBlocks.push(connection->queue.pop().buffer);
+
+				delete connection;
 			}
 
+			while (m_freeBlocks.hasData())
+				delete m_freeBlocks.pop();
+
+			m_connections.clear();
+			m_assignments.clear();
+			m_queued = m_maxQueued = 0;
+			m_commits = m_appliedCommits = 0;
+			m_stop = false;
+			m_sequence = 0;
 			m_connected = false;
 		}
 
@@ -430,14 +519,50 @@ namespace
 #ifdef NO_DATABASE
 			return true;
 #else
-			m_replicator->process(&status, length, data);
+			if (isParallel())
+				return dispatch(status, length, data);
+
+			m_connections[0]->replicator->process(&status, length, data);
 			return status.isSuccess();
 #endif
 		}
 
+		// Wait for all the queued blocks to be applied
+		bool drain(FbLocalStatus& status)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (m_queued && !findFailure())
+				m_dispatchCond.wait(m_mutex);
+
+			return checkFailure(status);
+		}
+
+		// Are there blocks queued or being applied by the workers?
+		bool hasPending()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return (m_queued != 0);
+		}
+
+		// Returns the maximum number of blocks queued since the previous call
+		unsigned resetQueueDepth()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			const unsigned depth = m_maxQueued;
+			m_maxQueued = m_queued;
+			return depth;
+		}
+
+		bool isParallel() const
+		{
+			return (m_connections.getCount() > 1);
+		}
+
 		bool isShutdown() const
 		{
-			return (m_attachment == NULL);
+			return m_connections.isEmpty();
 		}
 
 		const PathName& getDirectory() const
@@ -470,10 +595,176 @@ namespace
 		}
 
 	private:
+		// Blocks of a transaction are applied by the same connection in the journal order.
+		// Blocks written before the commit of another transaction could not see its changes,
+		// while the following ones could. So every block remembers how many commits were
+		// dispatched before it and is not applied until they are, while the commits
+		// themselves are applied in the journal order by the connections of their transactions.
+		bool dispatch(FbLocalStatus& status, ULONG length, const UCHAR* data)
+		{
+			const Block* const header = (Block*) data;
+			const auto traNumber = header->traNumber;
+
+			if (!traNumber)
+			{
+				// Cleanup of all transactions concerns every connection
+				if (!drain(status))
+					return false;
+
+				for (auto connection : m_connections)
+				{
+					connection->replicator->process(&status, length, data);
+					if (!status.isSuccess())
+						return false;
+				}
+
+				if (header->flags & BLOCK_END_TRANS)
+				{
+					// All the active transactions are gone
+					m_assignments.clear();
+
+					for (auto connection : m_connections)
+						connection->transactions = 0;
+				}
+
+				return true;
+			}
+
+			Connection* connection = nullptr;
+
+			if (!m_assignments.get(traNumber, connection))
+			{
+				// New transaction is assigned to the least loaded connection
+				connection = m_connections[0];
+
+				for (auto item : m_connections)
+				{
+					if (item->transactions < connection->transactions)
+						connection = item;
+				}
+
+				m_assignments.put(traNumber, connection);
+				connection->transactions++;
+			}
+
+			const bool commit = (header->flags & BLOCK_END_TRANS);
+
+			if (commit)
+			{
+				m_assignments.remove(traNumber);
+				connection->transactions--;
+			}
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (connection->queue.getCount() >= QUEUE_PER_WORKER && !findFailure())
+				m_dispatchCond.wait(m_mutex);
+
+			if (!checkFailure(status))
+				return false;
+
+			QueuedBlock item;
+			item.buffer = m_freeBlocks.hasData() ?
+				m_freeBlocks.pop() : FB_NEW_POOL(getPool()) UCharBuffer(getPool());
+			item.after = m_commits;
+
+			memcpy(item.buffer->getBuffer(length), data, length);
+			connection->queue.add(item);
+
+			if (commit)
+				m_commits++;
+
+			if (++m_queued > m_maxQueued)
+				m_maxQueued = m_queued;
+
+			connection->cond.notifyOne();
+
+			return true;
+		}
+
+		void apply(Connection* connection)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (!m_stop)
+			{
+				if (connection->queue.isEmpty() || connection->failed ||
+					connection->queue[0].after > m_appliedCommits)
+				{
+					connection->cond.wait(m_mutex);
+					continue;
+				}
+
+				UCharBuffer* const block = connection->queue[0].buffer;
+				const Block* const header = (Block*) block->begin();
+				const bool commit = (header->flags & BLOCK_END_TRANS);
+
+				{	// scope
+					MutexUnlockGuard unlock(m_mutex, FB_FUNCTION);
+					connection->replicator->process(&connection->status,
+						block->getCount(), block->begin());
+				}
+
+				connection->queue.remove((FB_SIZE_T) 0);
+				m_freeBlocks.push(block);
+				m_queued--;
+
+				if (!connection->status.isSuccess())
+					connection->failed = true;
+				else if (commit)
+				{
+					// Wake up the connections waiting for this commit
+					m_appliedCommits++;
+
+					for (auto item : m_connections)
+					{
+						if (item != connection)
+							item->cond.notifyOne();
+					}
+				}
+
+				m_dispatchCond.notifyOne();
+			}
+		}
+
+		// Called with the mutex locked
+		Connection* findFailure() const
+		{
+			for (auto connection : m_connections)
+			{
+				if (connection->failed)
+					return connection;
+			}
+
+			return nullptr;
+		}
+
+		// Called with the mutex locked
+		bool checkFailure(FbLocalStatus& status) const
+		{
+			const auto connection = findFailure();
+
+			if (connection)
+			{
+				connection->status.copyTo(&status);
+				return false;
+			}
+
+			return true;
+		}
+
 		AutoPtr<const Replication::Config> m_config;
 		string m_lastError;
-		IAttachment* m_attachment;
-		IReplicator* m_replicator;
+		HalfStaticArray<Connection*, 8> m_connections;
+		AssignmentMap m_assignments;	// transactions being applied in parallel
+		BlockList m_freeBlocks;
+		unsigned m_queued;				// blocks queued or being applied
+		unsigned m_maxQueued;
+		FB_UINT64 m_commits;			// commits dispatched to the connections
+		FB_UINT64 m_appliedCommits;		// commits applied by the connections
+		bool m_stop;
+		Mutex m_mutex;
+		Condition m_dispatchCond;		// replication thread waits for applied blocks
 		FB_UINT64 m_sequence;
 		bool m_connected;
 	};
@@ -514,17 +805,8 @@ namespace
 
 	typedef SortedArray<Segment*, EmptyStorage<Segment*>, FB_UINT64, Segment> ProcessQueue;
 
-	string formatInterval(const TimeStamp& start, const TimeStamp& finish)
+	string formatInterval(SINT64 delta)
 	{
-		static const SINT64 MSEC_PER_DAY = 24 * 60 * 60 * 1000;
-
-		const SINT64 startMsec = ((SINT64) start.value().timestamp_date) * MSEC_PER_DAY +
-			(SINT64) start.value().timestamp_time / 10;
-		const SINT64 finishMsec = ((SINT64) finish.value().timestamp_date) * MSEC_PER_DAY +
-			(SINT64) finish.value().timestamp_time / 10;
-
-		const SINT64 delta = finishMsec - startMsec;
-
 		string value;
 
 		if (delta < 1000) // less than 1 second
@@ -541,6 +823,18 @@ namespace
 		return value;
 	}
 
+	string formatInterval(const TimeStamp& start, const TimeStamp& finish)
+	{
+		static const SINT64 MSEC_PER_DAY = 24 * 60 * 60 * 1000;
+
+		const SINT64 startMsec = ((SINT64) start.value().timestamp_date) * MSEC_PER_DAY +
+			(SINT64) start.value().timestamp_time / 10;
+		const SINT64 finishMsec = ((SINT64) finish.value().timestamp_date) * MSEC_PER_DAY +
+			(SINT64) finish.value().timestamp_time / 10;
+
+		return formatInterval(finishMsec - startMsec);
+	}
+
 	void readConfig(TargetList& targets)
 	{
 		Array<Replication::Config*> replicas;
@@ -818,6 +1112,11 @@ namespace
 
 				AutoFile file(fd);
 
+				// Modification time of the segment is used to estimate the apply lag
+				struct stat stats;
+				if (fstat(file, &stats) < 0)
+					raiseError("Journal file %s fstat failed (error: %d)", segment->filename.c_str(), ERRNO);
+
 				SegmentHeader header;
 
 				if (read(file, &header, sizeof(SegmentHeader)) != sizeof(SegmentHeader))
@@ -867,7 +1166,16 @@ namespace
 
 					totalLength += length;
 
-					control.savePartial(sequence, totalLength, transactions);
+					// Position is saved only when all the preceding blocks are applied
+					if (!target->hasPending())
+						control.savePartial(sequence, totalLength, transactions);
+				}
+
+				if (!target->drain(localStatus))
+				{
+					target->verbose("Segment %" UQUADFORMAT " replication failure", sequence);
+
+					localStatus.raise();
 				}
 
 				control.saveComplete(sequence, transactions);
@@ -893,8 +1201,19 @@ namespace
 					extra += "deleting the file";
 				}
 
-				target->verbose("Segment %" UQUADFORMAT " (%u bytes) is replicated in %s, %s",
-								sequence, totalLength, interval.c_str(), extra.c_str());
+				const SINT64 lag = (SINT64) time(NULL) - (SINT64) stats.st_mtime;
+				string apply;
+				apply.printf("apply lag %s", formatInterval(MAX(lag, 0) * 1000).c_str());
+
+				if (target->isParallel())
+				{
+					string depth;
+					depth.printf(", queue depth up to %u block(s)", target->resetQueueDepth());
+					apply += depth;
+				}
+
+				target->verbose("Segment %" UQUADFORMAT " (%u bytes) is replicated in %s (%s), %s",
+								sequence, totalLength, interval.c_str(), apply.c_str(), extra.c_str());
 
 				if (!oldest_sequence)
 					segment->remove();
@@ -85,8 +85,10 @@ struct server_req_t : public GlobalStorage
 	RemPortPtr		req_port;
 	PACKET			req_send;
 	PACKET			req_receive;
+	SINT64			req_queued;		// performance counter value when request was queued
+	USHORT			req_bypassed;	// number of short requests queued ahead of this one
 public:
-	server_req_t() : req_next(0), req_chain(0) { }
+	server_req_t() : req_next(0), req_chain(0), req_queued(0), req_bypassed(0) { }
 };
 
 struct srvr : public GlobalStorage
@@ -709,7 +711,7 @@ public:
 				}
 
 				if (send->p_acpt.p_acpt_type & pflag_compress)
-					authPort->initCompression();
+					authPort->initCompression(send->p_acpt.p_acpt_type);
 				authPort->send(send);
 				if (send->p_acpt.p_acpt_type & pflag_compress)
 					authPort->port_flags |= PORT_compressed;
@@ -1153,11 +1155,30 @@ private:
 
 InitInstance<CryptKeyTypeManager> knownCryptKeyTypes;
 
+// Limits of blobs sent inline per fetch batch. Size of the blob is not known
+// until it's opened, so the number of blobs opened is limited too.
+
+struct InlineBlobBudget
+{
+	InlineBlobBudget()
+		: bytes(MAX_INLINE_BLOB_BATCH), probes(MAX_INLINE_BLOB_PROBES)
+	{}
+
+	bool exhausted() const
+	{
+		return !bytes || !probes;
+	}
+
+	ULONG bytes;
+	ULONG probes;
+};
+
 } // anonymous
 
 static void		free_request(server_req_t*);
 static server_req_t* alloc_request();
 static bool		link_request(rem_port*, server_req_t*);
+static bool		short_request(const server_req_t*);
 
 static bool		accept_connection(rem_port*, P_CNCT*, PACKET*);
 static ISC_STATUS	allocate_statement(rem_port*, /*P_RLSE*,*/ PACKET*);
@@ -1189,6 +1210,8 @@ static void		release_sql_request(Rsr*);
 static void		release_transaction(Rtr*);
 
 static void		send_error(rem_port* port, PACKET* apacket, ISC_STATUS errcode);
+static void		send_inline_blob(rem_port*, PACKET*, Rtr*, const ISC_QUAD&, ULONG, InlineBlobBudget&);
+static void		send_inline_blobs(rem_port*, PACKET*, Rsr*, const UCHAR*, InlineBlobBudget&);
 static void		send_error(rem_port* port, PACKET* apacket, const Firebird::Arg::StatusVector&);
 static void		set_server(rem_port*, USHORT);
 static int		shut_server(const int, const int, void*);
@@ -1231,6 +1254,8 @@ public:
 	static void start(USHORT flags);
 
 	static int getCount() { return m_cntAll; }
+	static int getMaxCount();
+	static int getPeakCount();
 
 	static bool isShuttingDown() { return shutting_down; }
 
@@ -1256,6 +1281,7 @@ private:
 	static int m_cntAll;
 	static int m_cntIdle;
 	static int m_cntGoing;
+	static int m_cntPeak;
 	static bool shutting_down;
 };
 
@@ -1265,6 +1291,7 @@ GlobalPtr<Mutex> Worker::m_mutex;
 int Worker::m_cntAll = 0;
 int Worker::m_cntIdle = 0;
 int Worker::m_cntGoing = 0;
+int Worker::m_cntPeak = 0;
 bool Worker::shutting_down = false;
 
 
@@ -1275,6 +1302,28 @@ static server_req_t* active_requests	= NULL;
 static int ports_active					= 0;	// length of active_requests
 static int ports_pending				= 0;	// length of request_que
 
+// Short request could be queued ahead of the long one no more than this number of times
+const USHORT MAX_REQUEST_BYPASS = 8;
+
+// Requests statistics, protected by request_que_mutex
+static FB_UINT64 requests_served		= 0;
+static FB_UINT64 requests_queue_time	= 0;	// microseconds
+static FB_UINT64 requests_service_time	= 0;	// microseconds
+
+struct RequestStats
+{
+	FB_UINT64 served;
+	FB_UINT64 queueTime;
+	FB_UINT64 serviceTime;
+	int pending;
+	int active;
+	int peakWorkers;
+};
+
+static void get_request_stats(RequestStats&);
+static void log_request_stats();
+static ULONG put_request_stats(UCHAR*, ULONG, ULONG);
+
 static GlobalPtr<Mutex> servers_mutex;
 static srvr* servers = NULL;
 static AtomicCounter cntServers;
@@ -1523,6 +1572,8 @@ static bool link_request(rem_port* port, server_req_t* request)
 	const P_OP operation = request->req_receive.p_operation;
 	server_req_t* queue;
 
+	request->req_queued = fb_utils::query_performance_counter();
+
 	MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
 
 	bool active = true;
@@ -1791,6 +1842,7 @@ void SRVR_multi_thread( rem_port* main_port, USHORT flags)
 		}
 
 		Worker::shutdown();
+		log_request_stats();
 
 		// All worker threads are stopped and will never run any more
 		// Disconnect remaining ports gracefully
@@ -1908,7 +1960,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	P_ARCH architecture = arch_generic;
 	USHORT version = 0;
 	USHORT type = 0;
-	bool compress = false;
+	USHORT compress = 0;
 	bool accepted = false;
 	USHORT weight = 0;
 	const p_cnct::p_cnct_repeat* protocol = connect->p_cnct_versions;
@@ -1918,7 +1970,10 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	{
 		if ((protocol->p_cnct_version == PROTOCOL_VERSION10 ||
 			 (protocol->p_cnct_version >= PROTOCOL_VERSION11 &&
-			  protocol->p_cnct_version <= PROTOCOL_VERSION16)) &&
+			  protocol->p_cnct_version <= PROTOCOL_VERSION16) ||
+			 protocol->p_cnct_version == PROTOCOL_INLINE_BLOB ||
+			 protocol->p_cnct_version == PROTOCOL_PIPELINE ||
+			 protocol->p_cnct_version == PROTOCOL_FETCH_BUDGET) &&
 			 (protocol->p_cnct_architecture == arch_generic ||
 			  protocol->p_cnct_architecture == ARCHITECTURE) &&
 			protocol->p_cnct_weight >= weight)
@@ -1928,21 +1983,30 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 			version = protocol->p_cnct_version;
 			architecture = protocol->p_cnct_architecture;
 			type = MIN(protocol->p_cnct_max_type & ptype_MASK, ptype_lazy_send);
-			compress = protocol->p_cnct_max_type & pflag_compress;
+			compress = protocol->p_cnct_max_type & (pflag_compress | pflag_compress_zstd);
 		}
 	}
 
+	// Zstd is used only when offered by client and available here, zlib otherwise
+	if (!(compress & pflag_compress))
+		compress = 0;
+	else if ((compress & pflag_compress_zstd) &&
+		!rem_port::checkCompression(pflag_compress | pflag_compress_zstd))
+	{
+		compress = pflag_compress;
+	}
+
 	HANDSHAKE_DEBUG(fprintf(stderr, "Srv: accept_connection: protoaccept a=%d (v>=13)=%d %d %d\n",
 					accepted, version >= PROTOCOL_VERSION13, version, PROTOCOL_VERSION13));
 
 	send->p_acpd.p_acpt_version = port->port_protocol = version;
 	send->p_acpd.p_acpt_architecture = architecture;
-	send->p_acpd.p_acpt_type = type | (compress ? pflag_compress : 0);
+	send->p_acpd.p_acpt_type = type | compress;
 	send->p_acpd.p_acpt_authenticated = 0;
 
 	send->p_acpt.p_acpt_version = port->port_protocol = version;
 	send->p_acpt.p_acpt_architecture = architecture;
-	send->p_acpt.p_acpt_type = type | (compress ? pflag_compress : 0);
+	send->p_acpt.p_acpt_type = type | compress;
 
 	// modify the version string to reflect the chosen protocol
 	string buffer;
@@ -2128,7 +2192,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_operation = returnData ? op_accept_data : op_accept;
 	if (send->p_acpt.p_acpt_type & pflag_compress)
-		port->initCompression();
+		port->initCompression(send->p_acpt.p_acpt_type);
 	port->send(send);
 	if (send->p_acpt.p_acpt_type & pflag_compress)
 		port->port_flags |= PORT_compressed;
@@ -2157,7 +2221,7 @@ void ConnectAuth::accept(PACKET* send, Auth::WriterImplementation*)
 		authPort->extractNewKeys(s);
 		send->p_acpd.p_acpt_authenticated = 1;
 		if (send->p_acpt.p_acpt_type & pflag_compress)
-			authPort->initCompression();
+			authPort->initCompression(send->p_acpt.p_acpt_type);
 		authPort->send(send);
 		if (send->p_acpt.p_acpt_type & pflag_compress)
 			authPort->port_flags |= PORT_compressed;
@@ -2267,16 +2331,76 @@ static void append_request_next(server_req_t* request, server_req_t** que_inst)
  * Functional description
  *	Traverse using req_next ptr and append
  *	a request at the end of a que.
- *	Return count of pending requests.
+ *	Short request is put ahead of long ones
+ *	which were not bypassed too many times.
  *
  **************************************/
 	MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
 
+	const bool shortRequest = short_request(request);
+	request->req_bypassed = 0;
+
 	while (*que_inst)
+	{
+		const server_req_t* const queued = *que_inst;
+
+		if (shortRequest && queued->req_bypassed < MAX_REQUEST_BYPASS && !short_request(queued))
+			break;
+
 		que_inst = &(*que_inst)->req_next;
+	}
 
+	request->req_next = *que_inst;
 	*que_inst = request;
 	ports_pending++;
+
+	if (shortRequest)
+	{
+		for (server_req_t* queued = request->req_next; queued; queued = queued->req_next)
+		{
+			if (!short_request(queued))
+				queued->req_bypassed++;
+		}
+	}
+}
+
+
+static bool short_request(const server_req_t* request)
+{
+/**************************************
+ *
+ *	s h o r t _ r e q u e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if request is expected to be served fast
+ *	and thus could be queued ahead of the long ones.
+ *
+ **************************************/
+	switch (request->req_receive.p_operation)
+	{
+	case op_fetch:
+	case op_fetch_blobs:
+	case op_info_sql:
+	case op_info_blob:
+	case op_get_segment:
+	case op_put_segment:
+	case op_batch_segments:
+	case op_seek_blob:
+	case op_close_blob:
+	case op_cancel_blob:
+	case op_free_statement:
+	case op_commit:
+	case op_commit_retaining:
+	case op_rollback:
+	case op_rollback_retaining:
+	case op_ping:
+		return true;
+
+	default:
+		return false;
+	}
 }
 
 
@@ -3829,6 +3953,9 @@ ISC_STATUS rem_port::execute_statement(P_OP op, P_SQLDATA* sqldata, PACKET* send
 	unsigned flags = statement->rsr_iface->getFlags(&status_vector);
 	check(&status_vector);
 
+	statement->rsr_inline_blob_size = (this->port_protocol >= PROTOCOL_INLINE_BLOB) ?
+		sqldata->p_sqldata_inline_blob_size : 0;
+
 	statement->rsr_iface->setTimeout(&status_vector, sqldata->p_sqldata_timeout);
 	if ((status_vector.getState() & IStatus::STATE_ERRORS) &&
 		(status_vector.getErrors()[1] == isc_interface_version_too_old))
@@ -3973,6 +4100,7 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 
 	USHORT count = 0;
 	bool rc = true;
+	InlineBlobBudget inline_budget;
 
 	for (; count < max_records; count++)
 	{
@@ -4024,6 +4152,11 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 			statement->rsr_msgs_waiting--;
 		}
 
+		// Small blobs referenced by the row go ahead of it
+
+		if (statement->rsr_inline_blob_size)
+			send_inline_blobs(this, sendL, statement, message->msg_address, inline_budget);
+
 		// There's a buffer waiting -- send it
 
 		if (!this->send_partial(sendL))
@@ -4031,12 +4164,18 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 
 		message->msg_address = NULL;
 
-		// If we've hit maximum prefetch size, break out of loop
+		// If we've hit maximum prefetch size, break out of loop. Clients
+		// supporting PROTOCOL_FETCH_BUDGET limit the batch size by their
+		// cache size and adjust it to the network latency, don't cut their
+		// batches.
 
 		const USHORT packets = this->port_snd_packets - org_packets;
 
-		if (packets >= MAX_PACKETS_PER_BATCH && count >= MIN_ROWS_PER_BATCH)
+		if (packets >= MAX_PACKETS_PER_BATCH && count >= MIN_ROWS_PER_BATCH &&
+			this->port_protocol < PROTOCOL_FETCH_BUDGET)
+		{
 			break;
+		}
 	}
 
 	response->p_sqldata_status = rc ? 0 : 100;
@@ -4163,6 +4302,48 @@ static bool get_next_msg_no(Rrq* request, USHORT incarnation, USHORT * msg_numbe
 }
 
 
+ISC_STATUS rem_port::fetch_blobs(P_FETCH_BLOBS* stuff, PACKET* sendL)
+{
+/**************************************
+ *
+ *	f e t c h _ b l o b s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Send requested blobs which are small enough
+ *	as op_inline_blob packets, the rest is skipped.
+ *
+ **************************************/
+	LocalStatus ls;
+	CheckStatusWrapper status_vector(&ls);
+	Rtr* transaction;
+
+	getHandle(transaction, stuff->p_fblb_transaction);
+
+	Rdb* rdb = this->port_context;
+	if (bad_db(&status_vector, rdb))
+		return this->send_response(sendL, 0, 0, &status_vector, false);
+
+	const ULONG max_size = MIN(stuff->p_fblb_max_size, MAX_USHORT);
+	InlineBlobBudget budget;
+
+	const UCHAR* p = stuff->p_fblb_ids.cstr_address;
+	const UCHAR* const end = p + stuff->p_fblb_ids.cstr_length;
+
+	for (; p + 2 * sizeof(SLONG) <= end && !budget.exhausted(); p += 2 * sizeof(SLONG))
+	{
+		ISC_QUAD id;
+		id.gds_quad_high = gds__vax_integer(p, sizeof(SLONG));
+		id.gds_quad_low = gds__vax_integer(p + sizeof(SLONG), sizeof(SLONG));
+
+		send_inline_blob(this, sendL, transaction, id, max_size, budget);
+	}
+
+	return this->send_response(sendL, 0, 0, &status_vector, false);
+}
+
+
 ISC_STATUS rem_port::get_segment(P_SGMT* segment, PACKET* sendL)
 {
 /**************************************
@@ -4362,6 +4543,7 @@ void rem_port::info(P_OP op, P_INFO* stuff, PACKET* sendL)
 	Svc* service;
 
 	ULONG info_db_len = 0;
+	bool wire_stats = false;
 
 	switch (op)
 	{
@@ -4405,6 +4587,35 @@ void rem_port::info(P_OP op, P_INFO* stuff, PACKET* sendL)
 		break;
 
 	case op_service_info:
+		{
+			// Request queue statistics are known to this server only. Put the item
+			// last, service answers it with an empty cluster if the user may see them.
+
+			ClumpletReader items(ClumpletReader::SpbReceiveItems,
+				stuff->p_info_recv_items.cstr_address, stuff->p_info_recv_items.cstr_length);
+
+			info.shrink(1);		// keep isc_info_length
+
+			for (items.rewind(); !items.isEof(); items.moveNext())
+			{
+				const UCHAR item = items.getClumpTag();
+
+				if (item == isc_info_end)
+					break;
+
+				if (item == isc_info_svc_wire_stats)
+					wire_stats = true;
+				else
+					info.add(item);
+			}
+
+			if (wire_stats)
+				info.add(isc_info_svc_wire_stats);
+
+			info_len = info.getCount();
+			info_buffer = info.begin();
+		}
+
 		service = rdb->rdb_svc;
 		service->svc_iface->query(&status_vector,
 			stuff->p_info_items.cstr_length, stuff->p_info_items.cstr_address,
@@ -4435,6 +4646,9 @@ void rem_port::info(P_OP op, P_INFO* stuff, PACKET* sendL)
 			response_len = val;
 	}
 
+	if (wire_stats && skip_len && !(status_vector.getState() & Firebird::IStatus::STATE_ERRORS))
+		response_len = put_request_stats(buffer + skip_len, buffer_length - skip_len, response_len);
+
 	sendL->p_resp.p_resp_data.cstr_address = buffer + skip_len;
 
 	this->send_response(sendL, stuff->p_info_object, response_len, &status_vector, false);
@@ -4943,6 +5157,10 @@ static bool process_packet(rem_port* port, PACKET* sendL, PACKET* receive, rem_p
 			port->fetch(&receive->p_sqldata, sendL);
 			break;
 
+		case op_fetch_blobs:
+			port->fetch_blobs(&receive->p_fblb, sendL);
+			break;
+
 		case op_free_statement:
 			port->end_statement(&receive->p_sqlfree, sendL);
 			break;
@@ -5890,6 +6108,189 @@ ISC_STATUS rem_port::send_response(	PACKET*	sendL,
 }
 
 // Maybe this can be a member of rem_port?
+static void send_inline_blob(rem_port* port, PACKET* sendL, Rtr* transaction, const ISC_QUAD& id,
+	ULONG max_size, InlineBlobBudget& budget)
+{
+/**************************************
+ *
+ *	s e n d _ i n l i n e _ b l o b
+ *
+ **************************************
+ *
+ * Functional description
+ *	Send the whole blob as op_inline_blob packet if it's
+ *	not bigger than max_size and fits the budget. Errors
+ *	are not reported, client will get them when opening
+ *	the blob itself.
+ *
+ **************************************/
+	static const UCHAR info_items[] =
+	{
+		isc_info_blob_num_segments,
+		isc_info_blob_max_segment,
+		isc_info_blob_total_length,
+		isc_info_blob_type,
+		isc_info_end
+	};
+
+	LocalStatus ls;
+	CheckStatusWrapper status_vector(&ls);
+
+	Rdb* rdb = port->port_context;
+	ISC_QUAD blob_id = id;
+
+	max_size = MIN(max_size, budget.bytes);
+	budget.probes--;
+
+	IBlob* blob = rdb->rdb_iface->openBlob(&status_vector, transaction->rtr_iface, &blob_id, 0, NULL);
+	if (status_vector.getState() & IStatus::STATE_ERRORS)
+		return;
+
+	UCHAR info[64];
+	blob->getInfo(&status_vector, sizeof(info_items), info_items, sizeof(info), info);
+
+	ULONG info_length = 0;
+	ULONG length = MAX_ULONG;
+
+	if (!(status_vector.getState() & IStatus::STATE_ERRORS))
+	{
+		// Data is sent as segments, each preceded by 2 bytes of length
+
+		SLONG total_length = -1, num_segments = 0;
+
+		const UCHAR* p = info;
+		const UCHAR* const end = info + sizeof(info);
+		while (p < end && *p != isc_info_end)
+		{
+			const UCHAR item = *p++;
+			if (end - p < 2)
+				break;
+
+			const USHORT l = gds__vax_integer(p, 2);
+			p += 2;
+			if (end - p < l)
+				break;
+
+			const SLONG n = gds__vax_integer(p, l);
+			p += l;
+
+			if (item == isc_info_blob_num_segments)
+				num_segments = n;
+			else if (item == isc_info_blob_total_length)
+				total_length = n;
+		}
+
+		if (p < end && *p == isc_info_end && total_length >= 0)
+		{
+			info_length = p + 1 - info;
+			length = total_length + 2 * num_segments;
+		}
+	}
+
+	Array<UCHAR> data;
+
+	if (length <= max_size && length <= MAX_USHORT)
+	{
+		UCHAR* const buffer = data.getBuffer(length);
+		UCHAR* p = buffer;
+		ULONG left = length;
+
+		while (left > 2)
+		{
+			unsigned l;
+			const int cc = blob->getSegment(&status_vector, left - 2, p + 2, &l);
+			if (cc != IStatus::RESULT_OK)
+				break;
+
+			p[0] = (UCHAR) l;
+			p[1] = (UCHAR) (l >> 8);
+			p += l + 2;
+			left -= l + 2;
+		}
+
+		// Blob could be changed or be of unexpected type, forget it then
+		if (p - buffer != length)
+			length = MAX_ULONG;
+	}
+
+	blob->close(&status_vector);
+	if (status_vector.getState() & IStatus::STATE_ERRORS)
+	{
+		status_vector.init();
+		blob->cancel(&status_vector);
+	}
+
+	if (length > max_size || length > MAX_USHORT)
+		return;
+
+	P_INLINE_BLOB* p_blob = &sendL->p_inline_blob;
+	const P_OP op = sendL->p_operation;
+
+	sendL->p_operation = op_inline_blob;
+	p_blob->p_tran_id = transaction->rtr_id;
+	p_blob->p_blob_id = id;
+	p_blob->p_blob_info.cstr_address = info;
+	p_blob->p_blob_info.cstr_length = info_length;
+	p_blob->p_blob_data.cstr_address = data.begin();
+	p_blob->p_blob_data.cstr_length = length;
+
+	port->send_partial(sendL);
+
+	memset(p_blob, 0, sizeof(P_INLINE_BLOB));
+	sendL->p_operation = op;
+
+	budget.bytes -= length;
+}
+
+
+static void send_inline_blobs(rem_port* port, PACKET* sendL, Rsr* statement, const UCHAR* msg,
+	InlineBlobBudget& budget)
+{
+/**************************************
+ *
+ *	s e n d _ i n l i n e _ b l o b s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Send blobs referenced by the message ahead of it,
+ *	until the per batch budget is exhausted.
+ *
+ **************************************/
+	const rem_fmt* const format = statement->rsr_format;
+	Rtr* const transaction = statement->rsr_rtr;
+
+	if (!format || !transaction || !msg)
+		return;
+
+	const FB_SIZE_T count = format->fmt_desc.getCount();
+
+	for (FB_SIZE_T i = 0; i < count && !budget.exhausted(); i++)
+	{
+		const dsc& desc = format->fmt_desc[i];
+		if (desc.dsc_dtype != dtype_blob && desc.dsc_dtype != dtype_quad)
+			continue;
+
+		// Each field is followed by its null indicator
+
+		if (i + 1 < count && format->fmt_desc[i + 1].dsc_dtype == dtype_short)
+		{
+			SSHORT null_flag;
+			memcpy(&null_flag, msg + (IPTR) format->fmt_desc[i + 1].dsc_address, sizeof(SSHORT));
+			if (null_flag)
+				continue;
+		}
+
+		ISC_QUAD id;
+		memcpy(&id, msg + (IPTR) desc.dsc_address, sizeof(ISC_QUAD));
+		if (!id.gds_quad_high && !id.gds_quad_low)
+			continue;
+
+		send_inline_blob(port, sendL, transaction, id, statement->rsr_inline_blob_size, budget);
+	}
+}
+
+
 static void send_error(rem_port* port, PACKET* apacket, ISC_STATUS errcode)
 {
 	LocalStatus ls;
@@ -6472,6 +6873,8 @@ static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM)
 					request = 0;
 					continue;
 				}
+				const SINT64 started = fb_utils::query_performance_counter();
+
 				// Splice request into list of active requests, execute request,
 				// and unsplice
 
@@ -6544,6 +6947,12 @@ static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM)
 				{ // request_que_mutex scope
 					MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
 
+					const SINT64 frequency = fb_utils::query_performance_frequency();
+					requests_served++;
+					requests_queue_time += (started - request->req_queued) * 1000000 / frequency;
+					requests_service_time +=
+						(fb_utils::query_performance_counter() - started) * 1000000 / frequency;
+
 					// Take request out of list of active requests
 
 					for (server_req_t** req_ptr = &active_requests; *req_ptr;
@@ -6874,7 +7283,13 @@ bool Worker::wakeUp()
 	if (m_cntAll - m_cntGoing >= ports_active + ports_pending)
 		return true;
 
-	return (m_cntAll - m_cntGoing >= MAX_THREADS);
+	return (m_cntAll - m_cntGoing >= getMaxCount());
+}
+
+int Worker::getMaxCount()
+{
+	const int maxThreads = Config::getMaxWorkerThreads();
+	return maxThreads ? maxThreads : MAX_THREADS;
 }
 
 void Worker::wakeUpAll()
@@ -6940,6 +7355,7 @@ void Worker::start(USHORT flags)
 		{
 			Thread::start(loopThread, (void*)(IPTR) flags, THREAD_medium);
 			++m_cntAll;
+			m_cntPeak = MAX(m_cntPeak, m_cntAll);
 		}
 		catch (const Exception&)
 		{
@@ -6978,6 +7394,134 @@ void Worker::shutdown()
 	}
 }
 
+int Worker::getPeakCount()
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	return m_cntPeak;
+}
+
+
+static void get_request_stats(RequestStats& stats)
+{
+/**************************************
+ *
+ *	g e t _ r e q u e s t _ s t a t s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Take a consistent snapshot of the request queue statistics.
+ *
+ **************************************/
+	{ // request_que_mutex scope
+		MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
+
+		stats.served = requests_served;
+		stats.queueTime = requests_queue_time;
+		stats.serviceTime = requests_service_time;
+		stats.pending = ports_pending;
+		stats.active = ports_active;
+	}
+
+	stats.peakWorkers = Worker::getPeakCount();
+}
+
+
+static void log_request_stats()
+{
+/**************************************
+ *
+ *	l o g _ r e q u e s t _ s t a t s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Put the request queue statistics into firebird.log at shutdown.
+ *
+ **************************************/
+	RequestStats stats;
+	get_request_stats(stats);
+
+	if (stats.served)
+	{
+		gds__log("Network server served %" UQUADFORMAT" requests using up to %d worker threads\n"
+				 "\tAverage queue time %" UQUADFORMAT" us, average service time %" UQUADFORMAT" us",
+				 stats.served, stats.peakWorkers,
+				 stats.queueTime / stats.served, stats.serviceTime / stats.served);
+	}
+}
+
+
+static ULONG put_request_stats(UCHAR* info, ULONG length, ULONG used)
+{
+/**************************************
+ *
+ *	p u t _ r e q u e s t _ s t a t s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Fill the empty isc_info_svc_wire_stats cluster put
+ *	by the service at the end of the query response of
+ *	"used" bytes. Return new length of the response.
+ *
+ **************************************/
+	const ULONG EMPTY_LENGTH = 3;	// item, isc_info_flag_end, isc_info_end
+
+	if (used < EMPTY_LENGTH || used > length ||
+		info[used - 3] != isc_info_svc_wire_stats ||
+		info[used - 2] != isc_info_flag_end ||
+		info[used - 1] != isc_info_end)
+	{
+		return used;
+	}
+
+	const ULONG CLUSTER_LENGTH = 1 + 6 * (1 + sizeof(SINT64)) + 1;
+
+	UCHAR* p = info + used - EMPTY_LENGTH;
+
+	if (length - used + EMPTY_LENGTH < CLUSTER_LENGTH + 1)
+	{
+		*p++ = isc_info_truncated;
+		*p++ = isc_info_end;
+		return p - info;
+	}
+
+	RequestStats stats;
+	get_request_stats(stats);
+
+	const struct
+	{
+		UCHAR tag;
+		SINT64 value;
+	} items[] =
+	{
+		{isc_spb_wire_requests, (SINT64) stats.served},
+		{isc_spb_wire_queue_time, (SINT64) stats.queueTime},
+		{isc_spb_wire_service_time, (SINT64) stats.serviceTime},
+		{isc_spb_wire_pending, stats.pending},
+		{isc_spb_wire_active, stats.active},
+		{isc_spb_wire_peak_workers, stats.peakWorkers}
+	};
+
+	*p++ = isc_info_svc_wire_stats;
+
+	for (unsigned i = 0; i < FB_NELEM(items); i++)
+	{
+		*p++ = items[i].tag;
+
+		const SINT64 value = items[i].value;
+		for (unsigned n = 0; n < sizeof(SINT64); n++)
+			*p++ = (UCHAR) (value >> (n * 8));
+	}
+
+	*p++ = isc_info_flag_end;
+	*p++ = isc_info_end;
+
+	fb_assert(ULONG(p - info) == used - EMPTY_LENGTH + CLUSTER_LENGTH + 1);
+	return p - info;
+}
+
 static int shut_server(const int, const int, void*)
 {
 	server_shutdown = true;
@@ -397,6 +397,7 @@ const SvcSwitches infSwitch[] =
 	{"info_svr_db_info", putSingleTag, 0, isc_info_svc_svr_db_info, 0},
 	{"info_version", putSingleTag, 0, isc_info_svc_version, 0},
 	{"info_capabilities", putSingleTag, 0, isc_info_svc_capabilities, 0},
+	{"info_wire_stats", putSingleTag, 0, isc_info_svc_wire_stats, 0},
 	{0, 0, 0, 0, 0}
 };
 
@@ -418,11 +419,13 @@ const SvcSwitches backupOptions[] =
 	{"verbint", putIntArgument, 0, isc_spb_verbint, 0},
 	{"bkp_skip_data", putStringArgument, 0, isc_spb_bkp_skip_data, 0},
 	{"bkp_include_data", putStringArgument, 0, isc_spb_bkp_include_data, 0},
+	{"bkp_parallel_workers", putIntArgument, 0, isc_spb_bkp_parallel_workers, 0},
 	{"bkp_stat", putStringArgument, 0, isc_spb_bkp_stat, 0 },
 	{"bkp_keyholder", putStringArgument, 0, isc_spb_bkp_keyholder, 0 },
 	{"bkp_keyname", putStringArgument, 0, isc_spb_bkp_keyname, 0 },
 	{"bkp_crypt", putStringArgument, 0, isc_spb_bkp_crypt, 0 },
 	{"bkp_zip", putOption, 0, isc_spb_bkp_zip, 0 },
+	{"bkp_zstd_level", putIntArgument, 0, isc_spb_bkp_zstd_level, 0},
 	{0, 0, 0, 0, 0}
 };
 
@@ -448,6 +451,7 @@ const SvcSwitches restoreOptions[] =
 	{"verbint", putIntArgument, 0, isc_spb_verbint, 0},
 	{"res_skip_data", putStringArgument, 0, isc_spb_res_skip_data, 0},
 	{"res_include_data", putStringArgument, 0, isc_spb_res_include_data, 0},
+	{"res_parallel_workers", putIntArgument, 0, isc_spb_res_parallel_workers, 0},
 	{"res_stat", putStringArgument, 0, isc_spb_res_stat, 0 },
 	{"res_keyholder", putStringArgument, 0, isc_spb_res_keyholder, 0 },
 	{"res_keyname", putStringArgument, 0, isc_spb_res_keyname, 0 },
@@ -554,6 +558,8 @@ const SvcSwitches nbackOptions[] =
 	{"nbk_guid", putStringArgument, 0, isc_spb_nbk_guid, 0},
 	{"nbk_no_triggers", putOption, 0, isc_spb_nbk_no_triggers, 0},
 	{"nbk_direct", putStringArgument, 0, isc_spb_nbk_direct, 0},
+	{"nbk_parallel", putIntArgument, 0, isc_spb_nbk_parallel_workers, 0},
+	{"nbk_zstd_level", putIntArgument, 0, isc_spb_nbk_zstd_level, 0},
 	{0, 0, 0, 0, 0}
 };
 
@@ -563,6 +569,7 @@ const SvcSwitches nrestOptions[] =
 	{"nbk_file", putStringArgument, 0, isc_spb_nbk_file, 0},
 	{"nbk_inplace", putOption, 0, isc_spb_nbk_inplace, 0},
 	{"nbk_sequence", putOption, 0, isc_spb_nbk_sequence, 0},
+	{"nbk_parallel", putIntArgument, 0, isc_spb_nbk_parallel_workers, 0},
 	{0, 0, 0, 0, 0}
 };
 
@@ -862,6 +869,40 @@ bool printInfo(const char* p, size_t pSize, UserPrint& up, ULONG& stdinRq)
 			p++;
 			break;
 
+		case isc_info_svc_wire_stats:
+			// Cluster is empty when the service is not accessed through the network server
+			if (*p != isc_info_flag_end)
+				printf ("%s:\n", getMessage(62).c_str());
+			while (*p != isc_info_flag_end)
+			{
+				switch (*p++)
+				{
+				case isc_spb_wire_requests:
+					printInt64(p, 63);
+					break;
+				case isc_spb_wire_queue_time:
+					printInt64(p, 64);
+					break;
+				case isc_spb_wire_service_time:
+					printInt64(p, 65);
+					break;
+				case isc_spb_wire_pending:
+					printInt64(p, 66);
+					break;
+				case isc_spb_wire_active:
+					printInt64(p, 67);
+					break;
+				case isc_spb_wire_peak_workers:
+					printInt64(p, 68);
+					break;
+				default:
+					status_exception::raise(Arg::Gds(isc_fbsvcmgr_query_err) <<
+											Arg::Num(static_cast<unsigned char>(p[-1])));
+				}
+			}
+			p++;
+			break;
+
 		case isc_info_svc_limbo_trans:
 			l = getShort(p);
 			limboEnd = &p[l];
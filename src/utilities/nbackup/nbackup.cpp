@@ -44,6 +44,11 @@
 #include "../common/utils_proto.h"
 #include "../common/classes/array.h"
 #include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/BlockZip.h"
+#include "../common/classes/condition.h"
+#include "../common/classes/init.h"
+#include "../common/classes/locks.h"
+#include "../common/ThreadStart.h"
 #include "../utilities/nbackup/nbk_proto.h"
 #include "../jrd/license.h"
 #include "../jrd/ods_proto.h"
@@ -54,6 +59,7 @@
 #include "../common/StatusArg.h"
 #include "../common/classes/objects_array.h"
 #include "../common/os/os_utils.h"
+#include "../common/status.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -85,6 +91,15 @@
 // JRD regarding the matter for the moment.
 const FB_SIZE_T SECTOR_ALIGNMENT = PAGE_ALIGNMENT;
 
+// Incremental backup reads adjacent changed pages by a single call up to
+// this size. Few unchanged pages between them are read too, it's cheaper
+// than a seek.
+const FB_SIZE_T MAX_RUN_SIZE = 1024 * 1024;
+const ULONG MAX_RUN_GAP = 4;
+
+// Runs of pages read ahead by every thread of parallel level 0 backup
+const unsigned RUNS_PER_THREAD = 2;
+
 using namespace Firebird;
 
 namespace
@@ -256,6 +271,27 @@ const char localhost[] = "localhost";
 const char backup_signature[4] = {'N','B','A','K'};
 const SSHORT BACKUP_VERSION = 2;
 
+// Backup file compressed by -ZSTD starts with this signature followed by
+// frames of Firebird::BlockZip. Data of the frames is the usual backup.
+const char zstd_signature[8] = {'N','B','A','K','Z','S','T','D'};
+
+#ifdef HAVE_ZSTD_H
+static InitInstance<ZStd> zstd;
+#endif
+
+static void checkZStd()
+{
+#ifdef HAVE_ZSTD_H
+	if (!zstd())
+	{
+		(Arg::Gds(isc_random) << "Compression support library not loaded" <<
+		 Arg::StatusVector(zstd().status)).raise();
+	}
+#else
+	(Arg::Gds(isc_random) << "No zstd support").raise();
+#endif
+}
+
 struct inc_header
 {
 	char signature[4];		// 'NBAK'
@@ -274,12 +310,14 @@ class NBackup
 {
 public:
 	NBackup(UtilSvc* _uSvc, const PathName& _database, const string& _username, const string& _role,
-			const string& _password, bool _run_db_triggers, bool _direct_io, const string& _deco)
+			const string& _password, bool _run_db_triggers, bool _direct_io, const string& _deco,
+			unsigned _parallel, int _zstd_level)
 	  : uSvc(_uSvc), newdb(0), trans(0), database(_database),
 		username(_username), role(_role), password(_password),
 		run_db_triggers(_run_db_triggers), direct_io(_direct_io),
 		dbase(INVALID_HANDLE_VALUE), backup(INVALID_HANDLE_VALUE),
 		decompress(_deco), childId(0), db_size_pages(0),
+		parallel(_parallel), zstd_level(_zstd_level), bak_prefix_pos(0),
 		m_odsNumber(0), m_silent(false), m_printed(false)
 	{
 		// Recognition of local prefix allows to work with
@@ -343,14 +381,29 @@ private:
 	int childId;
 #endif
 	ULONG db_size_pages;	// In pages
+	unsigned parallel;		// Threads reading database and (de)compressing backup
+	int zstd_level;			// Compress backup, 0 - don't
+#ifdef HAVE_ZSTD_H
+	class BackupZip;
+	AutoPtr<BackupZip> zip;
+#endif
+	Array<UCHAR> bak_prefix;	// Beginning of backup file read to check its signature
+	FB_SIZE_T bak_prefix_pos;
 	USHORT m_odsNumber;
 	bool m_silent;		// are we already handling an exception?
 	bool m_printed;		// pr_error() was called to print status vector
 
+	class PageReader;
+
 	// IO functions
 	FB_SIZE_T read_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize);
 	void write_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize);
 	void seek_file(FILE_HANDLE &file, SINT64 pos);
+	const char* file_name(const FILE_HANDLE &file) const;
+
+	// Backup file with compression if any
+	FB_SIZE_T read_backup(void *buffer, FB_SIZE_T bufsize);
+	void write_backup(void *buffer, FB_SIZE_T bufsize);
 
 	void pr_error(const ISC_STATUS* status, const char* operation);
 	void print_child_stderr();
@@ -365,17 +418,306 @@ private:
 
 	// Create/open database and backup
 	void open_database_write(bool exclusive = false);
-	void open_database_scan();
+	FILE_HANDLE open_database_scan();
 	void create_database();
 	void close_database();
 
 	void open_backup_scan();
+	void open_backup_file();
 	void open_backup_decompress();
+	void open_backup_zip();
 	void create_backup();
+	void start_backup_zip();
+	void finish_backup_zip();
 	void close_backup();
 };
 
 
+#ifdef HAVE_ZSTD_H
+
+// Backup file compressed in blocks by several threads
+
+class NBackup::BackupZip : public BlockZip
+{
+public:
+	BackupZip(NBackup* nbk, unsigned threadCount, bool compress, int level)
+		: BlockZip(*getDefaultMemoryPool(), ::zstd(), compress, level),
+		  nbackup(nbk)
+	{
+		start(threadCount);
+	}
+
+protected:
+	void putData(const UCHAR* data, ULONG length, bool /*last*/) override
+	{
+		nbackup->write_file(nbackup->backup, const_cast<UCHAR*>(data), length);
+	}
+
+	ULONG getData(UCHAR* data, ULONG length) override
+	{
+		return nbackup->read_file(nbackup->backup, data, length);
+	}
+
+	void raiseError(bool init, const char* text) override
+	{
+		string msg;
+		msg.printf("%s %s: %s", isCompress() ? "Compression" : "Decompression",
+			init ? "stream init error" : "error", text);
+		(Arg::Gds(isc_random) << msg).raise();
+	}
+
+private:
+	NBackup* const nbackup;
+};
+
+#endif // HAVE_ZSTD_H
+
+
+// Level 0 backup reads the database file by several threads, every one has
+// its own handle of the file and reads the next run of pages in turn. The
+// main thread takes pages in their order while the next runs are read.
+
+class NBackup::PageReader
+{
+public:
+	PageReader(NBackup* nbk, ULONG pageSize, ULONG pageCount);
+	~PageReader();
+
+	void start(unsigned threadCount);
+
+	// Copy the page into the buffer, returns number of bytes read,
+	// zero past the end of file
+	FB_SIZE_T read(ULONG page, void* buffer);
+
+private:
+	struct Run
+	{
+		UCHAR* data;
+		ULONG number;
+		FB_SIZE_T length;
+		bool ready;
+	};
+
+	struct Worker
+	{
+		PageReader* reader;
+		FILE_HANDLE file;
+		Thread::Handle handle;
+	};
+
+	static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg);
+	void run(Worker* worker);
+
+	NBackup* const nbackup;
+	const ULONG pageSize;
+	const ULONG runPages;
+
+	Array<UCHAR> buffer;
+	HalfStaticArray<Run, 16> runs;
+	HalfStaticArray<Worker, 8> workers;
+
+	Mutex mutex;
+	Condition workerCond;		// workers wait for runs released by the main thread
+	Condition mainCond;			// main thread waits for runs read
+
+	ULONG firstRun;				// the first run not released by the main thread
+	ULONG nextRun;				// the next run to read
+	ULONG lastRun;				// runs starting from it are past the end of file
+	bool stop;
+	bool failed;
+	FbLocalStatus errorStatus;
+};
+
+NBackup::PageReader::PageReader(NBackup* nbk, ULONG size, ULONG pageCount)
+	: nbackup(nbk),
+	  pageSize(size),
+	  runPages(MAX(MAX_RUN_SIZE / size, 1)),
+	  buffer(*getDefaultMemoryPool()),
+	  runs(*getDefaultMemoryPool()),
+	  workers(*getDefaultMemoryPool()),
+	  firstRun(0),
+	  nextRun(0),
+	  lastRun(pageCount ? (pageCount + runPages - 1) / runPages : MAX_ULONG),
+	  stop(false),
+	  failed(false)
+{ }
+
+NBackup::PageReader::~PageReader()
+{
+	{	// scope
+		MutexLockGuard guard(mutex, FB_FUNCTION);
+		stop = true;
+		workerCond.notifyAll();
+	}
+
+	for (Worker* worker = workers.begin(); worker != workers.end(); ++worker)
+	{
+		if (worker->handle)
+			Thread::waitForCompletion(worker->handle);
+
+		if (worker->file != INVALID_HANDLE_VALUE)
+		{
+#ifdef WIN_NT
+			CloseHandle(worker->file);
+#else
+			close(worker->file);
+#endif
+		}
+	}
+}
+
+void NBackup::PageReader::start(unsigned threadCount)
+{
+	const unsigned runCount = threadCount * RUNS_PER_THREAD;
+	const FB_SIZE_T runSize = runPages * pageSize;
+
+	// Runs are read directly into the buffer, it's aligned for direct IO
+	UCHAR* data = FB_ALIGN(buffer.getBuffer(runCount * runSize + SECTOR_ALIGNMENT), SECTOR_ALIGNMENT);
+
+	for (unsigned n = 0; n < runCount; n++, data += runSize)
+	{
+		Run run;
+		run.data = data;
+		run.number = MAX_ULONG;
+		run.length = 0;
+		run.ready = false;
+		runs.add(run);
+	}
+
+	// Workers are not moved in the array after the threads are started
+	for (unsigned n = 0; n < threadCount; n++)
+	{
+		Worker worker;
+		worker.reader = this;
+		worker.file = INVALID_HANDLE_VALUE;
+		worker.handle = 0;
+		workers.add(worker);
+	}
+
+	for (Worker* worker = workers.begin(); worker != workers.end(); ++worker)
+		worker->file = nbackup->open_database_scan();
+
+	for (Worker* worker = workers.begin(); worker != workers.end(); ++worker)
+		Thread::start(workerThread, worker, THREAD_medium, &worker->handle);
+}
+
+FB_SIZE_T NBackup::PageReader::read(ULONG page, void* data)
+{
+	const ULONG number = page / runPages;
+	const ULONG runCount = runs.getCount();
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	fb_assert(number >= firstRun);
+
+	// Release the runs before the one of the page. Ones being read can't
+	// be released, their buffers are still used.
+	while (firstRun < number && !failed)
+	{
+		const Run& run = runs[firstRun % runCount];
+
+		if (firstRun < nextRun && firstRun < lastRun && !(run.number == firstRun && run.ready))
+		{
+			mainCond.wait(mutex);
+			continue;
+		}
+
+		firstRun++;
+		workerCond.notifyAll();
+	}
+
+	if (nextRun < firstRun)
+		nextRun = firstRun;
+
+	const Run& run = runs[number % runCount];
+
+	while (!(run.number == number && run.ready))
+	{
+		if (failed)
+			status_exception::raise(&errorStatus);
+
+		if (number >= lastRun)
+			return 0;
+
+		mainCond.wait(mutex);
+	}
+
+	const FB_SIZE_T offset = (FB_SIZE_T) (page - number * runPages) * pageSize;
+
+	if (offset >= run.length)
+		return 0;
+
+	const FB_SIZE_T length = MIN(pageSize, run.length - offset);
+	memcpy(data, run.data + offset, length);
+
+	return length;
+}
+
+THREAD_ENTRY_DECLARE NBackup::PageReader::workerThread(THREAD_ENTRY_PARAM arg)
+{
+	Worker* const worker = static_cast<Worker*>(arg);
+	worker->reader->run(worker);
+	return 0;
+}
+
+void NBackup::PageReader::run(Worker* worker)
+{
+	const FB_SIZE_T runSize = runPages * pageSize;
+
+	MutexLockGuard guard(mutex, FB_FUNCTION);
+
+	while (!stop && !failed)
+	{
+		if (nextRun >= lastRun || nextRun >= firstRun + runs.getCount())
+		{
+			workerCond.wait(mutex);
+			continue;
+		}
+
+		const ULONG number = nextRun++;
+		Run& run = runs[number % runs.getCount()];
+		run.number = number;
+		run.ready = false;
+
+		FB_SIZE_T length = 0;
+
+		{	// scope
+			MutexUnlockGuard unlock(mutex, FB_FUNCTION);
+
+			try
+			{
+				nbackup->seek_file(worker->file, (SINT64) number * runSize);
+				length = nbackup->read_file(worker->file, run.data, runSize);
+			}
+			catch (const Exception& ex)
+			{
+				MutexLockGuard errorGuard(mutex, FB_FUNCTION);
+
+				if (!failed)
+					ex.stuffException(&errorStatus);
+
+				failed = true;
+			}
+		}
+
+		if (failed)
+		{
+			mainCond.notifyOne();
+			break;
+		}
+
+		run.length = length;
+		run.ready = true;
+
+		// Short run is the last one in the file
+		if (length < runSize && number + 1 < lastRun)
+			lastRun = number + 1;
+
+		mainCond.notifyOne();
+	}
+}
+
+
 FB_SIZE_T NBackup::read_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize)
 {
 	FB_SIZE_T rc = 0;
@@ -409,9 +751,7 @@ FB_SIZE_T NBackup::read_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize)
 		{
 			const int err = errno;
 #endif
-			status_exception::raise(Arg::Gds(isc_nbackup_err_read) <<
-				(&file == &dbase ? dbname.c_str() :
-					&file == &backup ? bakname.c_str() : "unknown") <<
+			status_exception::raise(Arg::Gds(isc_nbackup_err_read) << file_name(file) <<
 				Arg::OsError(err));
 		}
 
@@ -440,10 +780,54 @@ void NBackup::write_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize)
 		return;
 #endif
 
-	status_exception::raise(Arg::Gds(isc_nbackup_err_write) <<
-		(&file == &dbase ? dbname.c_str() :
-			&file == &backup ? bakname.c_str() : "unknown") <<
-		Arg::OsError());
+	status_exception::raise(Arg::Gds(isc_nbackup_err_write) << file_name(file) << Arg::OsError());
+}
+
+FB_SIZE_T NBackup::read_backup(void *buffer, FB_SIZE_T bufsize)
+{
+	UCHAR* data = static_cast<UCHAR*>(buffer);
+	FB_SIZE_T rc = 0;
+
+#ifdef HAVE_ZSTD_H
+	if (zip)
+	{
+		while (rc < bufsize)
+		{
+			const ULONG length = zip->read(data + rc, bufsize - rc);
+			if (!length)
+				break;
+
+			rc += length;
+		}
+
+		return rc;
+	}
+#endif
+
+	if (bak_prefix_pos < bak_prefix.getCount())
+	{
+		rc = MIN(bufsize, bak_prefix.getCount() - bak_prefix_pos);
+		memcpy(data, bak_prefix.begin() + bak_prefix_pos, rc);
+		bak_prefix_pos += rc;
+	}
+
+	if (rc < bufsize)
+		rc += read_file(backup, data + rc, bufsize - rc);
+
+	return rc;
+}
+
+void NBackup::write_backup(void *buffer, FB_SIZE_T bufsize)
+{
+#ifdef HAVE_ZSTD_H
+	if (zip)
+	{
+		zip->write(static_cast<UCHAR*>(buffer), bufsize);
+		return;
+	}
+#endif
+
+	write_file(backup, buffer, bufsize);
 }
 
 void NBackup::seek_file(FILE_HANDLE &file, SINT64 pos)
@@ -462,10 +846,13 @@ void NBackup::seek_file(FILE_HANDLE &file, SINT64 pos)
 		return;
 #endif
 
-	status_exception::raise(Arg::Gds(isc_nbackup_err_seek) <<
-		(&file == &dbase ? dbname.c_str() :
-			&file == &backup ? bakname.c_str() : "unknown") <<
-		Arg::OsError());
+	status_exception::raise(Arg::Gds(isc_nbackup_err_seek) << file_name(file) << Arg::OsError());
+}
+
+// Besides the members, the database file is read by threads of PageReader
+const char* NBackup::file_name(const FILE_HANDLE &file) const
+{
+	return &file == &backup ? bakname.c_str() : dbname.c_str();
 }
 
 void NBackup::open_database_write(bool exclusive)
@@ -492,7 +879,7 @@ void NBackup::open_database_write(bool exclusive)
 	status_exception::raise(Arg::Gds(isc_nbackup_err_opendb) << dbname.c_str() << Arg::OsError());
 }
 
-void NBackup::open_database_scan()
+FILE_HANDLE NBackup::open_database_scan()
 {
 #ifdef WIN_NT
 
@@ -503,11 +890,11 @@ void NBackup::open_database_scan()
 	// and OS itself. Basically, reading any large file brings the whole system
 	// down for extended period of time. Documented workaround is to avoid using
 	// system cache when reading large files.
-	dbase = CreateFile(dbname.c_str(),
+	const FILE_HANDLE file = CreateFile(dbname.c_str(),
 		GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
 		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN | (direct_io ? FILE_FLAG_NO_BUFFERING : 0),
 		NULL);
-	if (dbase == INVALID_HANDLE_VALUE)
+	if (file == INVALID_HANDLE_VALUE)
 		status_exception::raise(Arg::Gds(isc_nbackup_err_opendb) << dbname.c_str() << Arg::OsError());
 
 #else // WIN_NT
@@ -524,21 +911,22 @@ void NBackup::open_database_scan()
 #define O_DIRECT 0
 #endif // O_DIRECT
 
-	dbase = os_utils::open(dbname.c_str(), O_RDONLY | O_LARGEFILE | O_NOATIME | (direct_io ? O_DIRECT : 0));
-	if (dbase < 0)
+	FILE_HANDLE file = os_utils::open(dbname.c_str(), O_RDONLY | O_LARGEFILE | O_NOATIME | (direct_io ? O_DIRECT : 0));
+	if (file < 0)
 	{
 		// Non-root may fail when opening file of another user with O_NOATIME
-		dbase = os_utils::open(dbname.c_str(), O_RDONLY | O_LARGEFILE | (direct_io ? O_DIRECT : 0));
+		file = os_utils::open(dbname.c_str(), O_RDONLY | O_LARGEFILE | (direct_io ? O_DIRECT : 0));
 	}
-	if (dbase < 0)
+	if (file < 0)
 	{
 		status_exception::raise(Arg::Gds(isc_nbackup_err_opendb) << dbname.c_str() << Arg::OsError());
 	}
 
 #ifdef POSIX_FADV_SEQUENTIAL
-	int rc = fb_fadvise(dbase, 0, 0, POSIX_FADV_SEQUENTIAL);
+	int rc = fb_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
 	if (rc)
 	{
+		close(file);
 		status_exception::raise(Arg::Gds(isc_nbackup_err_fadvice) <<
 								"SEQUENTIAL" << dbname.c_str() << Arg::Unix(rc));
 	}
@@ -547,9 +935,10 @@ void NBackup::open_database_scan()
 #ifdef POSIX_FADV_NOREUSE
 	if (direct_io)
 	{
-		rc = fb_fadvise(dbase, 0, 0, POSIX_FADV_NOREUSE);
+		rc = fb_fadvise(file, 0, 0, POSIX_FADV_NOREUSE);
 		if (rc)
 		{
+			close(file);
 			status_exception::raise(Arg::Gds(isc_nbackup_err_fadvice) <<
 									"NOREUSE" << dbname.c_str() << Arg::Unix(rc));
 		}
@@ -557,6 +946,8 @@ void NBackup::open_database_scan()
 #endif // POSIX_FADV_NOREUSE
 
 #endif // WIN_NT
+
+	return file;
 }
 
 void NBackup::create_database()
@@ -596,11 +987,15 @@ string NBackup::to_system(const PathName& from)
 void NBackup::open_backup_scan()
 {
 	if (decompress.hasData())
-	{
 		open_backup_decompress();
-		return;
-	}
+	else
+		open_backup_file();
+
+	open_backup_zip();
+}
 
+void NBackup::open_backup_file()
+{
 	string nm = to_system(bakname);
 #ifdef WIN_NT
 	backup = CreateFile(nm.c_str(), GENERIC_READ, 0,
@@ -754,6 +1149,28 @@ void NBackup::open_backup_decompress()
 #endif
 }
 
+// Compressed backup is recognized by its signature, otherwise the bytes
+// read to check it are returned by read_backup() first
+void NBackup::open_backup_zip()
+{
+	bak_prefix_pos = 0;
+	UCHAR* const prefix = bak_prefix.getBuffer(sizeof(zstd_signature));
+	const FB_SIZE_T length = read_file(backup, prefix, sizeof(zstd_signature));
+
+	if (length != sizeof(zstd_signature) || memcmp(prefix, zstd_signature, length) != 0)
+	{
+		bak_prefix.shrink(length);
+		return;
+	}
+
+	bak_prefix.clear();
+	checkZStd();
+
+#ifdef HAVE_ZSTD_H
+	zip = FB_NEW BackupZip(this, MAX(parallel, 1), false, 0);
+#endif
+}
+
 void NBackup::create_backup()
 {
 	string nm = to_system(bakname);
@@ -790,8 +1207,49 @@ void NBackup::create_backup()
 	status_exception::raise(Arg::Gds(isc_nbackup_err_createbk) << bakname.c_str() << Arg::OsError());
 }
 
+void NBackup::start_backup_zip()
+{
+	if (!zstd_level)
+		return;
+
+	checkZStd();
+
+#ifdef HAVE_ZSTD_H
+	const int maxLevel = zstd().maxCLevel();
+	if (zstd_level > maxLevel)
+	{
+		string msg;
+		msg.printf("zstd compression level %d is out of range 1 - %d", zstd_level, maxLevel);
+		(Arg::Gds(isc_random) << msg).raise();
+	}
+
+	write_file(backup, const_cast<char*>(zstd_signature), sizeof(zstd_signature));
+
+	// Blocks are compressed by as many threads as database is read by
+	zip = FB_NEW BackupZip(this, MAX(parallel, 1), true, zstd_level);
+#endif
+}
+
+// Write the rest of compressed data
+void NBackup::finish_backup_zip()
+{
+#ifdef HAVE_ZSTD_H
+	if (zip)
+	{
+		zip->finish();
+		zip.reset();
+	}
+#endif
+}
+
 void NBackup::close_backup()
 {
+#ifdef HAVE_ZSTD_H
+	zip.reset();
+#endif
+	bak_prefix.clear();
+	bak_prefix_pos = 0;
+
 	if (bakname == "stdout")
 		return;
 #ifdef WIN_NT
@@ -1291,8 +1749,9 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 		// Create backup file and open database file
 		create_backup();
 		delete_backup = true;
+		start_backup_zip();
 
-		open_database_scan();
+		dbase = open_database_scan();
 
 		// Read database header
 		char unaligned_header_buffer[RAW_HEADER_SIZE + SECTOR_ALIGNMENT];
@@ -1368,7 +1827,7 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 
 			memset(page_buff, 0, header->hdr_page_size);
 			memcpy(page_buff, &bh, sizeof(bh));
-			write_file(backup, page_buff, header->hdr_page_size);
+			write_backup(page_buff, header->hdr_page_size);
 			page_writes++;
 
 			seek_file(dbase, 0);
@@ -1390,6 +1849,73 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 			scns_buf = reinterpret_cast<Ods::scns_page*>(FB_ALIGN(buf, SECTOR_ALIGNMENT));
 		}
 
+		// SCN pages tell which pages were changed since the previous level backup,
+		// pages up to the next SCN page or PIP are read by runs of changed ones
+		const ULONG maxRunPages = MAX(MAX_RUN_SIZE / header->hdr_page_size, 1);
+		Array<UCHAR> unaligned_run_buffer;
+		UCHAR* run_buff = NULL;
+		ULONG runStart = 0, runCount = 0;
+
+		if (level)
+		{
+			UCHAR* buf = unaligned_run_buffer.getBuffer(maxRunPages * header->hdr_page_size + SECTOR_ALIGNMENT);
+			run_buff = FB_ALIGN(buf, SECTOR_ALIGNMENT);
+		}
+
+		auto readChanged = [&]() -> FB_SIZE_T
+		{
+			const ULONG pageSize = header->hdr_page_size;
+
+			if (curPage < runStart || curPage >= runStart + runCount)
+			{
+				ULONG count = 1;
+
+				if (scns)
+				{
+					ULONG gap = 0;
+					ULONG slot = scnsSlot;
+
+					for (ULONG page = curPage + 1; page < curPage + maxRunPages; page++)
+					{
+						slot++;
+						const bool last = (slot == pagesPerSCN || page == lastPage);
+
+						if (last || scns->scn_pages[slot] > prev_scn)
+						{
+							count = page - curPage + 1;
+							gap = 0;
+						}
+						else if (++gap > MAX_RUN_GAP)
+							break;
+
+						if (last)
+							break;
+					}
+				}
+
+				seek_file(dbase, (SINT64) curPage * pageSize);
+				const FB_SIZE_T bytesDone = read_file(dbase, run_buff, count * pageSize);
+
+				runStart = curPage;
+				runCount = bytesDone / pageSize;
+
+				if (!runCount)
+					return bytesDone;
+			}
+
+			memcpy(page_buff, run_buff + (curPage - runStart) * pageSize, pageSize);
+			return pageSize;
+		};
+
+		// Full scan of the database is read ahead by several threads
+		AutoPtr<PageReader> reader;
+
+		if (!level && parallel > 1)
+		{
+			reader = FB_NEW PageReader(this, header->hdr_page_size, db_size_pages);
+			reader->start(parallel);
+		}
+
 		while (true)
 		{
 			if (curPage && page_buff->pag_scn > backup_scn)
@@ -1400,7 +1926,7 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 
 			if (!level || page_buff->pag_scn > prev_scn)
 			{
-				write_file(backup, page_buff, header->hdr_page_size);
+				write_backup(page_buff, header->hdr_page_size);
 				page_writes++;
 			}
 
@@ -1426,7 +1952,6 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 						curPage == nextSCN ||
 						curPage == lastPage)
 					{
-						seek_file(dbase, (SINT64) curPage * header->hdr_page_size);
 						break;
 					}
 				}
@@ -1445,7 +1970,13 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 				curPage++;
 
 
-			const FB_SIZE_T bytesDone = read_file(dbase, page_buff, header->hdr_page_size);
+			FB_SIZE_T bytesDone;
+			if (level)
+				bytesDone = readChanged();
+			else if (reader)
+				bytesDone = reader->read(curPage, page_buff);
+			else
+				bytesDone = read_file(dbase, page_buff, header->hdr_page_size);
 			--db_size;
 			page_reads++;
 			if (bytesDone == 0)
@@ -1488,6 +2019,8 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 				}
 			}
 		}
+		reader.reset();
+		finish_backup_zip();
 		close_database();
 		close_backup();
 
@@ -1683,7 +2216,7 @@ void NBackup::restore_database(const BackupFiles& files, bool repl_seq, bool inc
 			if (curLevel)
 			{
 				inc_header bakheader;
-				if (read_file(backup, &bakheader, sizeof(bakheader)) != sizeof(bakheader))
+				if (read_backup(&bakheader, sizeof(bakheader)) != sizeof(bakheader))
 					status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
 				if (memcmp(bakheader.signature, backup_signature, sizeof(backup_signature)) != 0)
 					status_exception::raise(Arg::Gds(isc_nbackup_invalid_incbk) << bakname.c_str());
@@ -1702,13 +2235,14 @@ void NBackup::restore_database(const BackupFiles& files, bool repl_seq, bool inc
 					status_exception::raise(Arg::Gds(isc_nbackup_wrong_orderbk) << bakname.c_str());
 
 				// Emulate seek_file(backup, bakheader.page_size)
-				// Backup is stream-oriented, if -decompress is used pipe can't be seek()'ed
+				// Backup is stream-oriented, if -decompress is used pipe can't be seek()'ed,
+				// compressed one can't be seek()'ed too
 				FB_SIZE_T left = bakheader.page_size - sizeof(bakheader);
 				while (left)
 				{
 					char char_buf[1024];
 					FB_SIZE_T step = left > sizeof(char_buf) ? sizeof(char_buf) : left;
-					if (read_file(backup, &char_buf, step) != step)
+					if (read_backup(&char_buf, step) != step)
 						status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
 					left -= step;
 				}
@@ -1719,7 +2253,7 @@ void NBackup::restore_database(const BackupFiles& files, bool repl_seq, bool inc
 				const auto page_ptr = page_buffer.begin();
 				while (true)
 				{
-					const FB_SIZE_T bytesDone = read_file(backup, page_ptr, bakheader.page_size);
+					const FB_SIZE_T bytesDone = read_backup(page_ptr, bakheader.page_size);
 					if (bytesDone == 0)
 						break;
 					if (bytesDone != bakheader.page_size) {
@@ -1740,7 +2274,7 @@ void NBackup::restore_database(const BackupFiles& files, bool repl_seq, bool inc
 					char buffer[65536];
 					while (true)
 					{
-						const FB_SIZE_T bytesRead = read_file(backup, buffer, sizeof(buffer));
+						const FB_SIZE_T bytesRead = read_backup(buffer, sizeof(buffer));
 						if (bytesRead == 0)
 							break;
 						write_file(dbase, buffer, bytesRead);
@@ -1857,6 +2391,8 @@ void nbackup(UtilSvc* uSvc)
 		false;
 #endif
 	NBackup::BackupFiles backup_files;
+	unsigned parallel = 0;
+	int zstd_level = 0;
 	int level = -1;
 	Guid guid;
 	bool print_size = false, version = false, inc_rest = false, repl_seq = false;
@@ -2044,6 +2580,28 @@ void nbackup(UtilSvc* uSvc)
 			repl_seq = true;
 			break;
 
+		case IN_SW_NBK_PARALLEL:
+			if (++itr >= argc)
+				missingParameterForSwitch(uSvc, argv[itr - 1]);
+
+			{ // scope
+				const int count = atoi(argv[itr]);
+				if (count <= 0)
+					usage(uSvc, isc_nbackup_unknown_param, argv[itr]);
+
+				parallel = count;
+			}
+			break;
+
+		case IN_SW_NBK_ZSTD:
+			if (++itr >= argc)
+				missingParameterForSwitch(uSvc, argv[itr - 1]);
+
+			zstd_level = atoi(argv[itr]);
+			if (zstd_level <= 0)
+				usage(uSvc, isc_nbackup_unknown_param, argv[itr]);
+			break;
+
 		default:
 			usage(uSvc, isc_nbackup_unknown_switch, argv[itr]);
 			break;
@@ -2074,7 +2632,8 @@ void nbackup(UtilSvc* uSvc)
 		usage(uSvc, isc_nbackup_seq_misuse);
 	}
 
-	NBackup nbk(uSvc, database, username, role, password, run_db_triggers, direct_io, decompress);
+	NBackup nbk(uSvc, database, username, role, password, run_db_triggers, direct_io, decompress,
+		parallel, zstd_level);
 	try
 	{
 		switch (op)
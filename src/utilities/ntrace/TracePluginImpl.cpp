@@ -508,6 +508,12 @@ void TracePluginImpl::appendGlobalCounts(const PerformanceInfo* info)
 		record.append(temp);
 	}
 
+	if ((cnt = info->pin_counters[PerformanceInfo::ARENA_HIGH_WATER]) != 0)
+	{
+		temp.printf(", %" QUADFORMAT"d arena byte(s)", cnt);
+		record.append(temp);
+	}
+
 	record.append(NEWLINE);
 }
 